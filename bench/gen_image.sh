@@ -0,0 +1,41 @@
+#!/bin/sh
+#
+# gen_image.sh - generate a synthetic binary for the pp tools benchmark
+#
+# gen_image.sh dir name nr_symbols
+#
+# Build dir/name.so from a generated source dir/name.c holding nr_symbols
+# functions of a few lines each, with debug info so opreport -g and
+# opannotate --source have line numbers to look up. Output the image as
+# op_gen_session expects it: absolute_path:text_offset:text_size
+#
+# Copyright 2026 OProfile authors
+# Read the file COPYING
+
+set -e
+
+if test $# -ne 3; then
+	echo "usage: $0 dir name nr_symbols" >&2
+	exit 1
+fi
+
+dir=`cd "$1" && pwd`
+name=$2
+nr_symbols=$3
+CC=${CC:-gcc}
+
+if ! test -f "$dir/$name.so"; then
+	awk -v n="$nr_symbols" 'BEGIN {
+		for (i = 0; i < n; ++i) {
+			printf("int f%d(int x)\n{\n", i);
+			printf("\tint y = x * %d;\n", i + 1);
+			printf("\tif (y & 1)\n\t\ty += %d;\n", i % 7);
+			printf("\treturn y ^ x;\n}\n\n");
+		}
+	}' > "$dir/$name.c"
+	$CC -g -O0 -shared -fPIC -o "$dir/$name.so" "$dir/$name.c"
+fi
+
+readelf -SW "$dir/$name.so" | awk -v path="$dir/$name.so" '
+	{ sub(/^ *\[ *[0-9]+\]/, "") }
+	$1 == ".text" { printf("%s:0x%s:0x%s\n", path, $4, $5) }'
@@ -0,0 +1,346 @@
+/**
+ * @file op_gen_session.c
+ * Generate a synthetic session to benchmark the pp tools
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * The images are given as path:offset:size where offset and size are
+ * the file offset and the size of their .text, see gen_image.sh. The
+ * samples are timer samples, spread over the images, the applications,
+ * the threads and the cpus according to --separate. The sample counts
+ * follow a Zipf distribution of exponent --skew over the PCs of a file.
+ */
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include "op_version.h"
+#include "op_popt.h"
+#include "op_config.h"
+#include "op_cpu_type.h"
+#include "op_mangle.h"
+#include "op_manifest.h"
+#include "op_sample_file.h"
+#include "op_file.h"
+#include "op_libiberty.h"
+#include "odb.h"
+
+static int show_vers;
+static char * session_dir;
+static long nr_files = 1000;
+static long nr_pcs = 10000;
+static long nr_cg_files;
+static long nr_cpus = 4;
+static double skew = 1.0;
+static long seed = 1;
+static char * separate;
+static int no_manifest;
+
+static int separate_lib;
+static int separate_thread;
+static int separate_cpu;
+
+static struct poptOption options[] = {
+	{ "session-dir", '\0', POPT_ARG_STRING, &session_dir, 0,
+	  "create the session in this directory", OP_SESSION_DIR_DEFAULT, },
+	{ "files", 'f', POPT_ARG_LONG, &nr_files, 0,
+	  "number of sample files (1000)", "nr", },
+	{ "pcs", 'p', POPT_ARG_LONG, &nr_pcs, 0,
+	  "number of distinct sampled PCs over all files (10000)", "nr", },
+	{ "callgraph", 'c', POPT_ARG_LONG, &nr_cg_files, 0,
+	  "number of call graph files (0)", "nr", },
+	{ "separate", 's', POPT_ARG_STRING, &separate, 0,
+	  "separate the samples as opcontrol does", "lib,thread,cpu", },
+	{ "cpus", '\0', POPT_ARG_LONG, &nr_cpus, 0,
+	  "number of cpus for --separate=cpu (4)", "nr", },
+	{ "skew", '\0', POPT_ARG_DOUBLE, &skew, 0,
+	  "exponent of the distribution of the samples over the PCs (1.0)",
+	  "exponent", },
+	{ "seed", '\0', POPT_ARG_LONG, &seed, 0,
+	  "seed of the pseudo random generator (1)", "seed", },
+	{ "no-manifest", '\0', POPT_ARG_NONE, &no_manifest, 0,
+	  "don't create the session manifest", NULL, },
+	{ "version", 'v', POPT_ARG_NONE, &show_vers, 0,
+	   "show version", NULL, },
+	POPT_AUTOHELP
+	{ NULL, 0, 0, NULL, 0, NULL, NULL, },
+};
+
+
+struct image {
+	char const * path;
+	unsigned long offset;
+	unsigned long size;
+	time_t mtime;
+};
+
+static struct image * images;
+static size_t nr_images;
+
+
+/* the samples of a session must be reproducible, don't use rand() */
+static unsigned long next_random(void)
+{
+	static unsigned long long state;
+	static int init;
+
+	if (!init) {
+		state = seed;
+		init = 1;
+	}
+	state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return state >> 33;
+}
+
+
+static void parse_separate(void)
+{
+	char * str;
+	char * tok;
+
+	if (!separate)
+		return;
+
+	str = xstrdup(separate);
+	for (tok = strtok(str, ","); tok; tok = strtok(NULL, ",")) {
+		if (!strcmp(tok, "lib")) {
+			separate_lib = 1;
+		} else if (!strcmp(tok, "thread")) {
+			separate_thread = 1;
+		} else if (!strcmp(tok, "cpu")) {
+			separate_cpu = 1;
+		} else if (!strcmp(tok, "all")) {
+			separate_lib = separate_thread = separate_cpu = 1;
+		} else if (strcmp(tok, "none")) {
+			fprintf(stderr, "op_gen_session: invalid --separate "
+			        "value %s\n", tok);
+			exit(EXIT_FAILURE);
+		}
+	}
+	free(str);
+}
+
+
+static void parse_images(char const ** args)
+{
+	size_t i;
+
+	for (nr_images = 0; args && args[nr_images]; ++nr_images)
+		;
+	if (!nr_images) {
+		fprintf(stderr, "op_gen_session: no image given\n");
+		exit(EXIT_FAILURE);
+	}
+
+	images = xmalloc(nr_images * sizeof(struct image));
+	for (i = 0; i < nr_images; ++i) {
+		char * path = xstrdup(args[i]);
+		char * size = strrchr(path, ':');
+		char * offset;
+
+		if (size) {
+			*size++ = '\0';
+			offset = strrchr(path, ':');
+		} else {
+			offset = NULL;
+		}
+		if (!offset) {
+			fprintf(stderr, "op_gen_session: image %s is not "
+			        "path:offset:size\n", args[i]);
+			exit(EXIT_FAILURE);
+		}
+		*offset++ = '\0';
+
+		images[i].path = path;
+		images[i].offset = strtoul(offset, NULL, 0);
+		images[i].size = strtoul(size, NULL, 0);
+		images[i].mtime = op_get_mtime(path);
+		if (!images[i].size || path[0] != '/') {
+			fprintf(stderr, "op_gen_session: image %s needs an "
+			        "absolute path and a non empty .text\n",
+			        args[i]);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+
+/* the number of distinct files --separate allows without threads */
+static long max_files(void)
+{
+	long nr = nr_images;
+
+	if (separate_lib)
+		nr *= nr_images;
+	if (separate_cpu)
+		nr *= nr_cpus;
+	return nr;
+}
+
+
+/* fill values for the sample file nr, return the image sampled */
+static struct image const *
+file_values(struct mangle_values * values, long nr)
+{
+	struct image const * image = &images[nr % nr_images];
+	struct image const * app = image;
+	long variant = nr / nr_images;
+
+	memset(values, 0, sizeof(*values));
+	values->image_name = image->path;
+	values->event_name = "TIMER";
+
+	if (separate_lib) {
+		app = &images[variant % nr_images];
+		variant /= nr_images;
+	}
+	values->dep_name = app->path;
+
+	if (separate_cpu) {
+		values->flags |= MANGLE_CPU;
+		values->cpu = variant % nr_cpus;
+		variant /= nr_cpus;
+	}
+
+	if (separate_thread) {
+		values->flags |= MANGLE_TGID | MANGLE_TID;
+		values->tgid = values->tid = 1000 + variant;
+	}
+
+	return image;
+}
+
+
+/* the count of the PC of rank i */
+static unsigned long sample_count(long i)
+{
+	return 1 + (unsigned long)(1000.0 / pow(i + 1, skew));
+}
+
+
+static void write_file(char const * mangled, struct image const * image,
+                       int cg, struct image const * cg_image, long nr_keys)
+{
+	struct opd_header * header;
+	odb_t odb;
+	long i;
+	int err;
+
+	create_path(mangled);
+
+	odb_init(&odb);
+	err = odb_open(&odb, mangled, ODB_RDWR, sizeof(struct opd_header));
+	if (err) {
+		fprintf(stderr, "op_gen_session: couldn't create %s: %s\n",
+		        mangled, strerror(err));
+		exit(EXIT_FAILURE);
+	}
+
+	header = odb_get_data(&odb);
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, OPD_MAGIC, sizeof(header->magic));
+	header->version = OPD_VERSION;
+	header->cpu_type = CPU_TIMER_INT;
+	header->mtime = image->mtime;
+
+	for (i = 0; i < nr_keys; ++i) {
+		odb_key_t key = image->offset + next_random() % image->size;
+
+		if (cg) {
+			key = (key << 32) | (cg_image->offset +
+			       next_random() % cg_image->size);
+		}
+		if (odb_update_node_with_offset(&odb, key, sample_count(i))) {
+			fprintf(stderr, "op_gen_session: couldn't write %s\n",
+			        mangled);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* odb_update_node_with_offset() can move the mapping */
+	header = odb_get_data(&odb);
+	if (!no_manifest && op_manifest_append(op_samples_current_dir,
+	        mangled + strlen(op_samples_current_dir), header)) {
+		fprintf(stderr, "op_gen_session: couldn't update the manifest: "
+		        "%s\n", strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	odb_close(&odb);
+}
+
+
+static void generate(void)
+{
+	long pcs_per_file = nr_pcs / nr_files;
+	long i;
+
+	if (pcs_per_file < 1)
+		pcs_per_file = 1;
+
+	for (i = 0; i < nr_files + nr_cg_files; ++i) {
+		struct mangle_values values;
+		struct image const * image;
+		struct image const * cg_image = NULL;
+		int const cg = i >= nr_files;
+		char * mangled;
+
+		image = file_values(&values, cg ? i - nr_files : i);
+		if (cg) {
+			cg_image = &images[next_random() % nr_images];
+			values.flags |= MANGLE_CALLGRAPH;
+			values.cg_image_name = cg_image->path;
+		}
+
+		mangled = op_mangle_filename(&values);
+		write_file(mangled, image, cg, cg_image, pcs_per_file);
+		free(mangled);
+	}
+}
+
+
+int main(int argc, char const * argv[])
+{
+	poptContext optcon;
+
+	optcon = op_poptGetContext(NULL, argc, argv, options, 0);
+
+	if (show_vers)
+		show_version(argv[0]);
+
+	init_op_config_dirs(session_dir ? session_dir : OP_SESSION_DIR_DEFAULT);
+
+	parse_separate();
+	parse_images(poptGetArgs(optcon));
+
+	if (nr_files < 1 || nr_pcs < 1 || nr_cg_files < 0 || nr_cpus < 1) {
+		fprintf(stderr, "op_gen_session: invalid size\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (!separate_thread && nr_files > max_files()) {
+		fprintf(stderr, "op_gen_session: only %ld sample files without "
+		        "--separate=thread\n", max_files());
+		nr_files = max_files();
+	}
+	/* a call graph file goes along the sample file of same number */
+	if (nr_cg_files > nr_files)
+		nr_cg_files = nr_files;
+
+	if (!no_manifest && (create_path(op_samples_current_dir) ||
+	    op_manifest_create(op_samples_current_dir))) {
+		fprintf(stderr, "op_gen_session: couldn't create the manifest: "
+		        "%s\n", strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+
+	generate();
+
+	poptFreeContext(optcon);
+	return EXIT_SUCCESS;
+}
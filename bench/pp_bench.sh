@@ -0,0 +1,139 @@
+#!/bin/sh
+#
+# pp_bench.sh - measure the pp tools over synthetic sessions of growing size
+#
+# For each scale, generate a session of that many sample files holding ten
+# times as many PCs over a few synthetic images, then run opreport,
+# opreport -c, opannotate and opgprof over it. One line per run is
+# appended to the results file:
+#
+#   tool files pcs wall_seconds max_rss_kb
+#
+# The peak RSS is the one the tool reports with --timings-json, whose output
+# is kept next to the results file for the time of each phase. Sessions
+# and images are kept in the work directory so a run can be repeated
+# against the same data, remove it to regenerate them.
+#
+# Copyright 2026 OProfile authors
+# Read the file COPYING
+
+# defaults, overridden by the environment
+SCALES=${SCALES:-"1000 10000 100000 1000000"}
+PCS_PER_FILE=${PCS_PER_FILE:-10}
+NR_IMAGES=${NR_IMAGES:-8}
+NR_SYMBOLS=${NR_SYMBOLS:-20000}
+SEPARATE=${SEPARATE:-"lib,thread"}
+SKEW=${SKEW:-1.0}
+WORK_DIR=${WORK_DIR:-/tmp/pp_bench}
+RESULTS=${RESULTS:-pp_bench.results}
+TOOLS=${TOOLS:-"opreport opreport-cg opannotate opgprof"}
+
+srcdir=`cd \`dirname $0\` && pwd`
+OP_GEN_SESSION=${OP_GEN_SESSION:-./op_gen_session}
+# the pp tools of the build tree
+PP_DIR=${PP_DIR:-../pp}
+
+usage()
+{
+	cat <<EOF
+usage: $0 [options]
+
+  -s "scales"     nr. of sample files of each session ($SCALES)
+  -w dir          work directory for images and sessions ($WORK_DIR)
+  -o file         append the results to file ($RESULTS)
+  -t "tools"      tools to run ($TOOLS)
+
+The environment variables PCS_PER_FILE, NR_IMAGES, NR_SYMBOLS, SEPARATE,
+SKEW, OP_GEN_SESSION and PP_DIR tune the sessions and locate the
+programs.
+EOF
+	exit 1
+}
+
+while getopts "s:w:o:t:h" opt; do
+	case $opt in
+	s) SCALES=$OPTARG ;;
+	w) WORK_DIR=$OPTARG ;;
+	o) RESULTS=$OPTARG ;;
+	t) TOOLS=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+
+if ! test -x "$OP_GEN_SESSION"; then
+	echo "$0: no $OP_GEN_SESSION, run make in the bench directory" >&2
+	exit 1
+fi
+
+set -e
+
+mkdir -p "$WORK_DIR/images"
+RESULTS_DIR=`dirname "$RESULTS"`
+
+images=""
+i=0
+while test $i -lt $NR_IMAGES; do
+	images="$images `$srcdir/gen_image.sh $WORK_DIR/images img$i $NR_SYMBOLS`"
+	i=`expr $i + 1`
+done
+first_image=`echo $images | cut -d: -f1`
+
+
+# run name scale command...
+run()
+{
+	name=$1
+	scale=$2
+	shift 2
+
+	json="$RESULTS_DIR/$name.$scale.json"
+	start=`date +%s.%N`
+	"$@" --timings-json > /dev/null 2> "$json"
+	end=`date +%s.%N`
+
+	rss=`sed -n 's/^  "peak_rss_kb": \([0-9]*\)$/\1/p' "$json"`
+	echo "$name $scale `expr $scale \* $PCS_PER_FILE` $start $end ${rss:-0}" \
+		| awk '{ printf("%s %s %s %.3f %s\n", $1, $2, $3, $5 - $4, $6) }' \
+		| tee -a "$RESULTS"
+}
+
+
+for scale in $SCALES; do
+	session="$WORK_DIR/session.$scale"
+	pcs=`expr $scale \* $PCS_PER_FILE`
+
+	if ! test -d "$session"; then
+		$OP_GEN_SESSION --session-dir="$session" --files=$scale \
+			--pcs=$pcs --callgraph=`expr $scale / 10` \
+			--separate=$SEPARATE --skew=$SKEW $images
+	fi
+
+	for tool in $TOOLS; do
+		case $tool in
+		opreport)
+			run $tool $scale $PP_DIR/opreport \
+				--session-dir="$session" --symbols --debug-info
+			;;
+		opreport-cg)
+			run $tool $scale $PP_DIR/opreport \
+				--session-dir="$session" --callgraph
+			;;
+		opannotate)
+			rm -rf "$WORK_DIR/annotated"
+			run $tool $scale $PP_DIR/opannotate \
+				--session-dir="$session" --source \
+				--output-dir="$WORK_DIR/annotated"
+			;;
+		opgprof)
+			run $tool $scale $PP_DIR/opgprof \
+				--session-dir="$session" \
+				--output-filename="$WORK_DIR/gmon.out" \
+				image:"$first_image"
+			;;
+		*)
+			echo "$0: unknown tool $tool" >&2
+			exit 1
+			;;
+		esac
+	done
+done
@@ -24,6 +24,11 @@
 #include "opd_anon.h"
 #include "opd_perfmon.h"
 #include "opd_printf.h"
+#include "opd_slice.h"
+#include "opd_manifest.h"
+#include "opd_export.h"
+#include "opd_selfprof.h"
+#include "opd_jitconv.h"
 
 #include "op_version.h"
 #include "op_config.h"
@@ -38,23 +43,24 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <sys/time.h>
-#include <wait.h>
 #include <string.h>
+#include <time.h>
+
+/** sync files and print statistics every 10 minutes */
+#define OPD_SYNC_INTERVAL (60 * 10)
 
 size_t kernel_pointer_size;
 
 static fd_t devfd;
 static char * sbuf;
 static size_t s_buf_bytesize;
-extern char * session_dir;
-static char start_time_str[32];
-static int jit_conversion_running;
+static time_t last_sync;
+static time_t last_export;
 
 static void opd_sighup(void);
 static void opd_alarm(void);
+static void opd_set_alarm(void);
 static void opd_sigterm(void);
-static void opd_sigchild(void);
-static void opd_do_jitdumps(void);
 
 /**
  * opd_open_files - open necessary files
@@ -135,59 +141,35 @@ retry:
 static void opd_do_samples(char const * opd_buf, ssize_t count)
 {
 	size_t num = count / kernel_pointer_size;
+	struct timeval start, end;
  
 	opd_stats[OPD_DUMP_COUNT]++;
 
 	verbprintf(vmisc, "Read buffer of %d entries.\n", (unsigned int)num);
  
+	gettimeofday(&start, NULL);
 	opd_process_samples(opd_buf, num);
+	gettimeofday(&end, NULL);
 
 	complete_dump();
+
+	opd_stats_page_buffer(count, (end.tv_sec - start.tv_sec) * 1000000ULL
+	                      + end.tv_usec - start.tv_usec);
 }
- 
-static void opd_do_jitdumps(void)
-{ 
-	pid_t childpid;
-	int arg_num;
-	unsigned long long end_time = 0ULL;
-	struct timeval tv;
-	char end_time_str[32];
-	char opjitconv_path[PATH_MAX + 1];
-	char * exec_args[6];
 
-	if (jit_conversion_running)
-		return;
-	jit_conversion_running = 1;
-
-	childpid = fork();
-	switch (childpid) {
-		case -1:
-			perror("Error forking JIT dump process!");
-			break;
-		case 0:
-			gettimeofday(&tv, NULL);
-			end_time = tv.tv_sec;
-			sprintf(end_time_str, "%llu", end_time);
-			sprintf(opjitconv_path, "%s/%s", OP_BINDIR, "opjitconv");
-			arg_num = 0;
-			exec_args[arg_num++] = "opjitconv";
-			if (vmisc)
-				exec_args[arg_num++] = "-d";
-			exec_args[arg_num++] = session_dir;
-			exec_args[arg_num++] = start_time_str;
-			exec_args[arg_num++] = end_time_str;
-			exec_args[arg_num] = (char *) NULL;
-			execvp(opjitconv_path, exec_args);
-			fprintf(stderr, "Failed to exec %s: %s\n",
-			        exec_args[0], strerror(errno));
-			/* We don't want any cleanup in the child */
-			_exit(EXIT_FAILURE);
-		default:
-			break;
-	} 
-
-} 
 
+/**
+ * opd_jitconv_check - start a waiting JIT conversion
+ *
+ * A conversion still rate limited is retried from the alarm.
+ */
+static void opd_jitconv_check(void)
+{
+	opd_jitconv_schedule(0);
+	if (opd_jitconv_delay() >= 0)
+		opd_set_alarm();
+}
+ 
 /**
  * opd_do_read - enter processing loop
  * @param buf  buffer to read into
@@ -223,8 +205,11 @@ static void opd_do_read(char * buf, size_t size)
 			if (signal_term)
 				opd_sigterm();
 
-			if (signal_child)
-				opd_sigchild();
+			if (signal_child) {
+				signal_child = 0;
+				opd_jitconv_reap();
+				opd_jitconv_check();
+			}
 
 			if (signal_usr1) {
 				signal_usr1 = 0;
@@ -238,23 +223,67 @@ static void opd_do_read(char * buf, size_t size)
 
 			if (is_jitconv_requested()) {
 				verbprintf(vmisc, "Start opjitconv was triggered\n");
-				opd_do_jitdumps();
+				opd_jitconv_request();
+				opd_jitconv_check();
 			}
 		}
 
 		opd_do_samples(buf, count);
+		opd_slice_check();
+		opd_export_poll();
+		opd_jitconv_check();
 	}
 	
 	opd_close_pipe();
 }
 
 
-/** opd_alarm - sync files and report stats */
+/**
+ * opd_set_alarm - arm the alarm for the next periodic work
+ *
+ * This is the next export period, sync, JIT conversion or refresh of
+ * the statistics page.
+ */
+static void opd_set_alarm(void)
+{
+	time_t now = time(NULL);
+	time_t next = last_sync + OPD_SYNC_INTERVAL;
+	int delay;
+
+	if (export_interval > 0 && last_export + export_interval < next)
+		next = last_export + export_interval;
+
+	delay = opd_jitconv_delay();
+	if (delay >= 0 && now + delay < next)
+		next = now + delay;
+
+	if (opd_stats_page_enabled() && now + OPD_STATS_PAGE_INTERVAL < next)
+		next = now + OPD_STATS_PAGE_INTERVAL;
+
+	alarm(next > now ? next - now : 1);
+}
+
+
+/** opd_alarm - export deltas, sync files, report stats and convert JIT dumps */
 static void opd_alarm(void)
 {
-	sfile_sync_files();
-	opd_print_stats();
-	alarm(60 * 10);
+	time_t now = time(NULL);
+
+	if (export_interval > 0 && now - last_export >= export_interval) {
+		opd_export_flush();
+		last_export = now;
+	}
+
+	opd_stats_page_update(0);
+
+	if (now - last_sync >= OPD_SYNC_INTERVAL) {
+		sfile_sync_files();
+		opd_print_stats();
+		last_sync = now;
+	}
+
+	opd_jitconv_schedule(0);
+	opd_set_alarm();
 }
  
 
@@ -264,6 +293,8 @@ static void opd_sighup(void)
 	printf("Received SIGHUP.\n");
 	/* We just close them, and re-open them lazily as usual. */
 	sfile_close_files();
+	opd_slice_restart();
+	opd_manifest_init();
 	close(1);
 	close(2);
 	opd_open_logfile();
@@ -273,38 +304,25 @@ static void opd_sighup(void)
 static void clean_exit(void)
 {
 	perfmon_exit();
+	opd_export_exit();
+	opd_stats_page_exit();
 	unlink(op_lock_file);
 }
 
 
 static void opd_sigterm(void)
 {
-	opd_do_jitdumps();
+	opd_jitconv_request();
+	opd_jitconv_schedule(1);
 	opd_print_stats();
 	printf("oprofiled stopped %s", op_get_time());
 	exit(EXIT_FAILURE);
 }
 
-/* SIGCHLD received from JIT dump child process. */
-static void opd_sigchild(void)
-{
-	int child_status;
-	wait(&child_status);
-	jit_conversion_running = 0;
-	if (WIFEXITED(child_status) && (!WEXITSTATUS(child_status))) {
-		verbprintf(vmisc, "JIT dump processing complete.\n");
-	} else {
-		printf("JIT dump processing exited abnormally: %d\n",
-		       WEXITSTATUS(child_status));
-	}
-
-}
- 
 static void opd_26_init(void)
 {
 	size_t i;
 	size_t opd_buf_size;
-	unsigned long long start_time = 0ULL;
 	struct timeval tv;
 
 	opd_create_vmlinux(vmlinux, kernel_range);
@@ -327,6 +345,8 @@ static void opd_26_init(void)
 	cookie_init();
 	sfile_init();
 	anon_init();
+	opd_slice_init();
+	opd_manifest_init();
 
 	/* must be /after/ perfmon_init() at least */
 	if (atexit(clean_exit)) {
@@ -338,15 +358,21 @@ static void opd_26_init(void)
 	/* trigger kernel module setup before returning control to opcontrol */
 	opd_open_files();
 	gettimeofday(&tv, NULL);
-	start_time = 0ULL;
-	start_time = tv.tv_sec;
-	sprintf(start_time_str, "%llu", start_time);
+	opd_jitconv_init(tv.tv_sec);
 		  
 }
 
 
 static void opd_26_start(void)
 {
+	/* the export socket must not be created before opd_go_daemon() */
+	opd_export_init();
+	opd_stats_page_init(s_buf_bytesize);
+	opd_selfprof_init();
+	last_sync = time(NULL);
+	last_export = last_sync;
+	opd_set_alarm();
+
 	/* simple sleep-then-process loop */
 	opd_do_read(sbuf, s_buf_bytesize);
 }
@@ -21,6 +21,7 @@
 #include "opd_trans.h"
 #include "opd_sfile.h"
 #include "opd_printf.h"
+#include "opd_selfprof.h"
 #include "op_libiberty.h"
 
 #include <limits.h>
@@ -194,8 +195,10 @@ retry:
 	}
 
 	if (!tried) {
+		u64 start = opd_selfprof_start();
 		clear_anon_maps(trans);
 		get_anon_maps(trans);
+		opd_selfprof_end(OPD_PROF_ANON_REFRESH, start);
 		tried = 1;
 		goto retry;
 	}
@@ -0,0 +1,387 @@
+/**
+ * @file daemon/opd_export.c
+ * Streaming of aggregated sample deltas to local collectors
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "opd_export.h"
+#include "opd_printf.h"
+#include "oprofiled.h"
+
+#include "op_config.h"
+#include "op_list.h"
+#include "op_libiberty.h"
+#include "op_growable_buffer.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define FILE_HASH_SIZE 1024
+#define MAX_CLIENTS 16
+/** a collector with more pending data than this is dropped */
+#define MAX_PENDING (64 * 1024 * 1024)
+
+/** the deltas for one opened sample file */
+struct export_file {
+	/** the ODB data this entry is for, NULL once the file is closed */
+	void const * data;
+	char * name;
+	/** open addressing table of nr_keys keys over size slots */
+	odb_key_t * keys;
+	unsigned long * counts;
+	size_t size;
+	size_t nr_keys;
+	struct list_head hash;
+};
+
+struct export_client {
+	int fd;
+	struct growable_buffer pending;
+	size_t sent;
+};
+
+int opd_export_active;
+
+static int listen_fd = -1;
+static struct export_client clients[MAX_CLIENTS];
+static size_t nr_clients;
+static struct list_head file_hash[FILE_HASH_SIZE];
+
+
+static size_t hash_data(void const * data)
+{
+	return ((unsigned long)data >> 4) & (FILE_HASH_SIZE - 1);
+}
+
+
+static size_t hash_key(odb_key_t key, size_t size)
+{
+	uint32_t temp = (key >> 32) ^ key;
+	return (temp ^ (temp >> 11)) & (size - 1);
+}
+
+
+static void grow_keys(struct export_file * ef)
+{
+	odb_key_t * old_keys = ef->keys;
+	unsigned long * old_counts = ef->counts;
+	size_t old_size = ef->size;
+	size_t i;
+
+	ef->size = old_size ? old_size * 2 : 64;
+	ef->keys = xmalloc(ef->size * sizeof(odb_key_t));
+	ef->counts = xcalloc(ef->size, sizeof(unsigned long));
+
+	for (i = 0; i < old_size; ++i) {
+		size_t pos;
+		if (!old_counts[i])
+			continue;
+		pos = hash_key(old_keys[i], ef->size);
+		while (ef->counts[pos])
+			pos = (pos + 1) & (ef->size - 1);
+		ef->keys[pos] = old_keys[i];
+		ef->counts[pos] = old_counts[i];
+	}
+
+	free(old_keys);
+	free(old_counts);
+}
+
+
+static struct export_file * find_file(odb_t const * file)
+{
+	struct list_head * head = &file_hash[hash_data(file->data)];
+	struct list_head * pos;
+	struct export_file * ef;
+
+	list_for_each(pos, head) {
+		ef = list_entry(pos, struct export_file, hash);
+		if (ef->data == file->data)
+			return ef;
+	}
+
+	ef = xmalloc(sizeof(struct export_file));
+	ef->data = file->data;
+	ef->name = xstrdup(file->data->filename);
+	ef->keys = NULL;
+	ef->counts = NULL;
+	ef->size = 0;
+	ef->nr_keys = 0;
+	grow_keys(ef);
+	list_add(&ef->hash, head);
+	return ef;
+}
+
+
+void opd_export_sample(odb_t const * file, odb_key_t key,
+                       unsigned long count)
+{
+	struct export_file * ef;
+	size_t pos;
+
+	if (!count)
+		return;
+
+	ef = find_file(file);
+	pos = hash_key(key, ef->size);
+
+	while (ef->counts[pos] && ef->keys[pos] != key)
+		pos = (pos + 1) & (ef->size - 1);
+
+	if (!ef->counts[pos]) {
+		ef->keys[pos] = key;
+		if (++ef->nr_keys * 2 > ef->size) {
+			ef->counts[pos] = count;
+			grow_keys(ef);
+			return;
+		}
+	}
+
+	ef->counts[pos] += count;
+}
+
+
+void opd_export_invalidate(odb_t const * file)
+{
+	struct list_head * pos;
+	struct export_file * ef;
+
+	/* still opened through another odb_t */
+	if (odb_open_count(file) != 1)
+		return;
+
+	list_for_each(pos, &file_hash[hash_data(file->data)]) {
+		ef = list_entry(pos, struct export_file, hash);
+		if (ef->data == file->data) {
+			/* its deltas are still sent with the period */
+			ef->data = NULL;
+			return;
+		}
+	}
+}
+
+
+static void free_files(void)
+{
+	size_t i;
+
+	for (i = 0; i < FILE_HASH_SIZE; ++i) {
+		struct list_head * pos;
+		struct list_head * pos2;
+		list_for_each_safe(pos, pos2, &file_hash[i]) {
+			struct export_file * ef =
+				list_entry(pos, struct export_file, hash);
+			list_del(&ef->hash);
+			free(ef->name);
+			free(ef->keys);
+			free(ef->counts);
+			free(ef);
+		}
+	}
+}
+
+
+void opd_export_init(void)
+{
+	struct sockaddr_un addr;
+	size_t i;
+
+	if (export_interval <= 0)
+		return;
+
+	for (i = 0; i < FILE_HASH_SIZE; ++i)
+		list_init(&file_hash[i]);
+
+	if (strlen(op_export_socket) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "oprofiled: export socket path %s too long\n",
+		        op_export_socket);
+		return;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, op_export_socket);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd == -1) {
+		perror("oprofiled: couldn't create export socket: ");
+		return;
+	}
+
+	unlink(op_export_socket);
+	if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(listen_fd, MAX_CLIENTS) ||
+	    fcntl(listen_fd, F_SETFL, O_NONBLOCK)) {
+		perror("oprofiled: couldn't set up export socket: ");
+		close(listen_fd);
+		listen_fd = -1;
+		return;
+	}
+
+	printf("Exporting sample deltas every %d seconds on %s\n",
+	       export_interval, op_export_socket);
+}
+
+
+static void drop_client(size_t i)
+{
+	verbprintf(vmisc, "Dropping export collector %d\n", clients[i].fd);
+	close(clients[i].fd);
+	free_buffer(&clients[i].pending);
+	clients[i] = clients[--nr_clients];
+	opd_export_active = nr_clients != 0;
+}
+
+
+void opd_export_exit(void)
+{
+	if (listen_fd == -1)
+		return;
+
+	while (nr_clients)
+		drop_client(nr_clients - 1);
+	free_files();
+	close(listen_fd);
+	unlink(op_export_socket);
+	listen_fd = -1;
+}
+
+
+static void accept_clients(void)
+{
+	int fd;
+
+	while ((fd = accept(listen_fd, NULL, NULL)) != -1) {
+		if (nr_clients == MAX_CLIENTS ||
+		    fcntl(fd, F_SETFL, O_NONBLOCK)) {
+			close(fd);
+			continue;
+		}
+		verbprintf(vmisc, "New export collector %d\n", fd);
+		clients[nr_clients].fd = fd;
+		clients[nr_clients].sent = 0;
+		init_buffer(&clients[nr_clients].pending);
+		++nr_clients;
+		opd_export_active = 1;
+	}
+}
+
+
+/** return non-zero if the client must be dropped */
+static int write_pending(struct export_client * client)
+{
+	char const * data = client->pending.p;
+
+	while (client->sent < client->pending.size) {
+		ssize_t count = send(client->fd, data + client->sent,
+		                     client->pending.size - client->sent,
+		                     MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (count == -1) {
+			if (errno == EINTR)
+				continue;
+			return errno != EAGAIN && errno != EWOULDBLOCK;
+		}
+		client->sent += count;
+	}
+
+	client->pending.size = 0;
+	client->sent = 0;
+	return 0;
+}
+
+
+void opd_export_poll(void)
+{
+	size_t i;
+
+	if (listen_fd == -1)
+		return;
+
+	accept_clients();
+
+	for (i = 0; i < nr_clients; ) {
+		if (write_pending(&clients[i]))
+			drop_client(i);
+		else
+			++i;
+	}
+}
+
+
+static void format_deltas(struct growable_buffer * out)
+{
+	char line[64];
+	unsigned long nr_keys = 0;
+	size_t i, j;
+
+	sprintf(line, "delta %lu\n", (unsigned long)time(NULL));
+	add_data(out, line, strlen(line));
+
+	for (i = 0; i < FILE_HASH_SIZE; ++i) {
+		struct list_head * pos;
+		list_for_each(pos, &file_hash[i]) {
+			struct export_file * ef =
+				list_entry(pos, struct export_file, hash);
+			if (!ef->nr_keys)
+				continue;
+			add_data(out, "file ", 5);
+			add_data(out, ef->name, strlen(ef->name));
+			add_data(out, "\n", 1);
+			for (j = 0; j < ef->size; ++j) {
+				if (!ef->counts[j])
+					continue;
+				sprintf(line, "%llx %lu\n",
+				        (unsigned long long)ef->keys[j],
+				        ef->counts[j]);
+				add_data(out, line, strlen(line));
+			}
+			nr_keys += ef->nr_keys;
+		}
+	}
+
+	sprintf(line, "end %lu\n", nr_keys);
+	add_data(out, line, strlen(line));
+}
+
+
+void opd_export_flush(void)
+{
+	struct growable_buffer out;
+	size_t i;
+
+	if (listen_fd == -1)
+		return;
+
+	accept_clients();
+
+	if (nr_clients) {
+		init_buffer(&out);
+		format_deltas(&out);
+
+		for (i = 0; i < nr_clients; ) {
+			struct export_client * client = &clients[i];
+			if (client->pending.size + out.size > MAX_PENDING) {
+				printf("Export collector too slow, dropped\n");
+				drop_client(i);
+				continue;
+			}
+			add_data(&client->pending, out.p, out.size);
+			++i;
+		}
+
+		free_buffer(&out);
+	}
+
+	free_files();
+	opd_export_poll();
+}
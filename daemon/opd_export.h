@@ -0,0 +1,77 @@
+/**
+ * @file daemon/opd_export.h
+ * Streaming of aggregated sample deltas to local collectors
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * Collectors connect to the Unix domain socket op_export_socket. Every
+ * export_interval seconds each connected collector receives the samples
+ * logged since the previous period, as text:
+ *
+ * delta <seconds since the Epoch>
+ * file <sample file name>
+ * <key> <count>
+ * ...
+ * end <nr of keys>
+ *
+ * key is the ODB key, in hexadecimal, a sample file may appear more than
+ * once in a period. Collectors too slow to read their data are dropped.
+ */
+
+#ifndef OPD_EXPORT_H
+#define OPD_EXPORT_H
+
+#include "odb.h"
+
+/** non-zero if at least one collector is connected */
+extern int opd_export_active;
+
+/**
+ * opd_export_init - create the export socket
+ *
+ * Does nothing unless --export-interval was given. Failure to create the
+ * socket is logged and disables the export.
+ */
+void opd_export_init(void);
+
+/** close the export socket and all collectors */
+void opd_export_exit(void);
+
+/**
+ * opd_export_sample - account a sample logged into file
+ * @param file  the sample file
+ * @param key  the ODB key
+ * @param count  number of samples
+ *
+ * Must only be called if opd_export_active is set.
+ */
+void opd_export_sample(odb_t const * file, odb_key_t key,
+                       unsigned long count);
+
+/**
+ * opd_export_invalidate - forget about a sample file
+ * @param file  the sample file about to be closed
+ *
+ * Must be called before file is closed, an ODB file opened later is
+ * accounted separately even if its address is reused. The other sample
+ * files are not affected.
+ */
+void opd_export_invalidate(odb_t const * file);
+
+/**
+ * opd_export_poll - accept new collectors and write pending data
+ *
+ * Never blocks.
+ */
+void opd_export_poll(void);
+
+/**
+ * opd_export_flush - end the current period
+ *
+ * Queue the deltas accumulated since the last call to each collector
+ * and start a new period.
+ */
+void opd_export_flush(void);
+
+#endif /* OPD_EXPORT_H */
@@ -0,0 +1,151 @@
+/**
+ * @file daemon/opd_jitconv.c
+ * Asynchronous conversion of JIT dump files
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "config.h"
+
+#include "opd_jitconv.h"
+#include "opd_stats.h"
+#include "opd_printf.h"
+#include "oprofiled.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+/** nice increment of the opjitconv process */
+#define OPD_JITCONV_NICE 10
+
+extern char * session_dir;
+
+static char start_time_str[32];
+static int requested;
+static pid_t child_pid;
+static time_t last_start;
+/** driver lost samples count when the running conversion started */
+static u64 lost_at_start;
+
+
+void opd_jitconv_init(time_t start)
+{
+	sprintf(start_time_str, "%llu", (unsigned long long)start);
+}
+
+
+void opd_jitconv_request(void)
+{
+	requested = 1;
+}
+
+
+static void exec_opjitconv(void)
+{
+	char end_time_str[32];
+	char opjitconv_path[PATH_MAX + 1];
+	char * exec_args[6];
+	int arg_num;
+
+	errno = 0;
+	if (nice(OPD_JITCONV_NICE) == -1 && errno)
+		perror("oprofiled: couldn't lower opjitconv priority: ");
+
+	sprintf(end_time_str, "%llu", (unsigned long long)time(NULL));
+	sprintf(opjitconv_path, "%s/%s", OP_BINDIR, "opjitconv");
+	arg_num = 0;
+	exec_args[arg_num++] = "opjitconv";
+	if (vmisc)
+		exec_args[arg_num++] = "-d";
+	exec_args[arg_num++] = session_dir;
+	exec_args[arg_num++] = start_time_str;
+	exec_args[arg_num++] = end_time_str;
+	exec_args[arg_num] = (char *) NULL;
+	execvp(opjitconv_path, exec_args);
+	fprintf(stderr, "Failed to exec %s: %s\n",
+	        exec_args[0], strerror(errno));
+	/* We don't want any cleanup in the child */
+	_exit(EXIT_FAILURE);
+}
+
+
+void opd_jitconv_schedule(int force)
+{
+	time_t now;
+	pid_t pid;
+
+	if (!requested || child_pid)
+		return;
+
+	now = time(NULL);
+	if (!force && now - last_start < OPD_JITCONV_INTERVAL)
+		return;
+
+	/* samples the kernel could not hand to us while converting */
+	lost_at_start = opd_read_lost_samples();
+
+	pid = fork();
+	switch (pid) {
+		case -1:
+			perror("Error forking JIT dump process!");
+			return;
+		case 0:
+			exec_opjitconv();
+			break;
+		default:
+			break;
+	}
+
+	verbprintf(vmisc, "Started JIT dump processing, pid %d\n", (int)pid);
+	child_pid = pid;
+	last_start = now;
+	requested = 0;
+	opd_stats[OPD_JIT_CONVERSIONS]++;
+}
+
+
+int opd_jitconv_delay(void)
+{
+	time_t elapsed;
+
+	/* a running conversion is followed by opd_jitconv_reap() */
+	if (!requested || child_pid)
+		return -1;
+
+	elapsed = time(NULL) - last_start;
+	if (elapsed >= OPD_JITCONV_INTERVAL || elapsed < 0)
+		return 0;
+	return OPD_JITCONV_INTERVAL - elapsed;
+}
+
+
+void opd_jitconv_reap(void)
+{
+	int child_status;
+	pid_t pid;
+	u64 lost;
+
+	while ((pid = waitpid(-1, &child_status, WNOHANG)) > 0) {
+		if (pid != child_pid)
+			continue;
+
+		child_pid = 0;
+		lost = opd_read_lost_samples() - lost_at_start;
+		opd_stats[OPD_JIT_LOST_SAMPLES] += lost;
+
+		if (WIFEXITED(child_status) && (!WEXITSTATUS(child_status))) {
+			verbprintf(vmisc, "JIT dump processing complete, "
+			           "%llu samples lost meanwhile.\n", lost);
+		} else {
+			printf("JIT dump processing exited abnormally: %d\n",
+			       WEXITSTATUS(child_status));
+		}
+	}
+}
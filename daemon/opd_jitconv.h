@@ -0,0 +1,57 @@
+/**
+ * @file daemon/opd_jitconv.h
+ * Asynchronous conversion of JIT dump files
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * opjitconv runs in a child process at a lower priority. Requests are
+ * recorded and the conversion is started from the read loop once the
+ * current buffer is processed, at most once every OPD_JITCONV_INTERVAL
+ * seconds; a request made during a conversion starts a new one after
+ * it. A rate limited request is retried from the alarm, so it is not
+ * delayed until the next sample buffer. Completion is reported by
+ * SIGCHLD and never waited for.
+ */
+
+#ifndef OPD_JITCONV_H
+#define OPD_JITCONV_H
+
+#include <time.h>
+
+/** minimum delay in seconds between the start of two conversions */
+#define OPD_JITCONV_INTERVAL 5
+
+/**
+ * opd_jitconv_init - record the start of the profiling session
+ * @param start  session start, JIT dumps are converted from this time
+ */
+void opd_jitconv_init(time_t start);
+
+/** request a conversion */
+void opd_jitconv_request(void);
+
+/**
+ * opd_jitconv_schedule - start a requested conversion if it is time to
+ * @param force  ignore the rate limit
+ *
+ * Never blocks, a conversion already running is not waited for.
+ */
+void opd_jitconv_schedule(int force);
+
+/**
+ * opd_jitconv_delay - time before a requested conversion can start
+ *
+ * Return the nr. of seconds before opd_jitconv_schedule() can start the
+ * requested conversion, -1 if no conversion is waiting to be started.
+ */
+int opd_jitconv_delay(void);
+
+/**
+ * opd_jitconv_reap - handle the end of a conversion
+ *
+ * Must be called after a SIGCHLD, never blocks.
+ */
+void opd_jitconv_reap(void);
+
+#endif /* OPD_JITCONV_H */
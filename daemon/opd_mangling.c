@@ -18,6 +18,7 @@
 #include "opd_anon.h"
 #include "opd_printf.h"
 #include "opd_events.h"
+#include "opd_manifest.h"
 #include "oprofiled.h"
 
 #include "op_file.h"
@@ -143,6 +144,9 @@ int opd_open_sample_file(odb_t *file, struct sfile *last,
 {
 	char * mangled;
 	char const * binary;
+	struct opd_header * header;
+	struct opd_header old_header;
+	int new_file;
 	int spu_profile = 0;
 	vma_t last_start = 0;
 	int err;
@@ -179,6 +183,11 @@ retry:
 		goto out;
 	}
 
+	/* odb_open() zero fills a new file */
+	header = odb_get_data(file);
+	new_file = memcmp(header->magic, OPD_MAGIC, sizeof(header->magic));
+	old_header = *header;
+
 	if (!sf->kernel)
 		binary = find_cookie(sf->cookie);
 	else
@@ -190,12 +199,18 @@ retry:
 	if (sf->embedded_offset != UNUSED_EMBEDDED_OFFSET)
 		spu_profile = 1;
 
-	fill_header(odb_get_data(file), counter,
+	fill_header(header, counter,
 		    sf->anon ? sf->anon->start : 0, last_start,
 		    !!sf->kernel, last ? !!last->kernel : 0,
 		    spu_profile, sf->embedded_offset,
 		    binary ? op_get_mtime(binary) : 0);
 
+	/* fill_header() can change the header of an existing file, e.g. the
+	 * mtime of a rebuilt binary, record it again so the manifest isn't
+	 * stale */
+	if (new_file || memcmp(&old_header, header, sizeof(old_header)))
+		opd_manifest_add(mangled, header);
+
 out:
 	sfile_put(sf);
 	if (sf != last)
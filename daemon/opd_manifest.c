@@ -0,0 +1,134 @@
+/**
+ * @file daemon/opd_manifest.c
+ * Maintenance of the manifest of the current session
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "opd_manifest.h"
+#include "opd_printf.h"
+
+#include "op_config.h"
+#include "op_file.h"
+#include "op_manifest.h"
+
+#include <sys/types.h>
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+static int manifest_enabled;
+
+
+/* the current session directory, time slices are below it */
+static void session_dir(char * dir)
+{
+	snprintf(dir, PATH_MAX, "%s/current/", op_samples_dir);
+}
+
+
+static int has_sample_dir(char const * dir)
+{
+	char path[PATH_MAX];
+	int len;
+
+	len = snprintf(path, PATH_MAX, "%s/{root}", dir);
+	if (len >= 0 && len < PATH_MAX && !access(path, F_OK))
+		return 1;
+	len = snprintf(path, PATH_MAX, "%s/{kern}", dir);
+	return len >= 0 && len < PATH_MAX && !access(path, F_OK);
+}
+
+
+/* does dir or one of its time slices hold sample files */
+static int has_sample_files(char const * dir)
+{
+	char path[PATH_MAX];
+	struct dirent * dirent;
+	DIR * d;
+	int found;
+	int len;
+
+	if (has_sample_dir(dir))
+		return 1;
+
+	d = opendir(dir);
+	if (!d)
+		return 0;
+
+	found = 0;
+	while (!found && (dirent = readdir(d)) != NULL) {
+		if (strncmp(dirent->d_name, OP_SLICE_PREFIX,
+		            strlen(OP_SLICE_PREFIX)))
+			continue;
+		len = snprintf(path, PATH_MAX, "%s%s", dir, dirent->d_name);
+		if (len < 0 || len >= PATH_MAX)
+			continue;
+		found = has_sample_dir(path);
+	}
+
+	closedir(d);
+	return found;
+}
+
+
+void opd_manifest_init(void)
+{
+	char dir[PATH_MAX];
+	char name[PATH_MAX];
+	int len;
+
+	session_dir(dir);
+	len = snprintf(name, PATH_MAX, "%s%s", dir, OP_MANIFEST_FILE);
+	if (len < 0 || len >= PATH_MAX) {
+		manifest_enabled = 0;
+		return;
+	}
+
+	manifest_enabled = !access(name, F_OK);
+	if (manifest_enabled)
+		return;
+
+	if (has_sample_files(dir)) {
+		verbprintf(vsfile, "%s holds sample files but no manifest\n",
+		           dir);
+		return;
+	}
+
+	create_path(name);
+	if (op_manifest_create(dir)) {
+		fprintf(stderr, "oprofiled: couldn't create %s: %s\n",
+		        name, strerror(errno));
+		return;
+	}
+
+	manifest_enabled = 1;
+}
+
+
+void opd_manifest_add(char const * filename, struct opd_header const * header)
+{
+	char dir[PATH_MAX];
+	size_t len;
+
+	if (!manifest_enabled)
+		return;
+
+	session_dir(dir);
+	len = strlen(dir);
+	if (strncmp(filename, dir, len))
+		return;
+
+	/* ENOENT: the session was moved away, opd_manifest_init() will
+	 * tell if the new one can have a manifest */
+	if (op_manifest_append(dir, filename + len, header)) {
+		if (errno != ENOENT)
+			fprintf(stderr, "oprofiled: couldn't add %s to the "
+			        "manifest: %s\n", filename, strerror(errno));
+		manifest_enabled = 0;
+	}
+}
@@ -0,0 +1,32 @@
+/**
+ * @file daemon/opd_manifest.h
+ * Maintenance of the manifest of the current session
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#ifndef OPD_MANIFEST_H
+#define OPD_MANIFEST_H
+
+struct opd_header;
+
+/**
+ * opd_manifest_init - start recording sample files in the manifest
+ *
+ * Must be called at startup and each time the current session may have
+ * been moved away. The manifest is created if the current session holds
+ * no sample file yet. If the session already holds sample files but no
+ * manifest, nothing is recorded: the manifest would be incomplete and
+ * the pp tools fall back to walking the session.
+ */
+void opd_manifest_init(void);
+
+/**
+ * opd_manifest_add - record a new sample file
+ * @param filename  the full sample file path
+ * @param header  its header
+ */
+void opd_manifest_add(char const * filename, struct opd_header const * header);
+
+#endif /* OPD_MANIFEST_H */
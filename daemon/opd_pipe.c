@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 
 static int fifo;
+static FILE * fifo_fd;
 
 void opd_create_pipe(void)
 {
@@ -43,12 +44,19 @@ void opd_open_pipe(void)
 		perror("oprofiled: couldn't open pipe: ");
 		exit(EXIT_FAILURE);
 	}
+
+	/* a single stream, lines split across two reads are not lost */
+	fifo_fd = fdopen(fifo, "r");
+	if (fifo_fd == NULL) {
+		perror("oprofiled: couldn't create file descriptor: ");
+		exit(EXIT_FAILURE);
+	}
 }
 
 
 void opd_close_pipe(void)
 {
-	close(fifo);
+	fclose(fifo_fd);
 }
 
 
@@ -58,17 +66,13 @@ int is_jitconv_requested(void)
 	static long nr_drops = 0;
 	/* modulus to output only a few warnings to avoid flooding oprofiled.log */
 	static int mod_cnt_drops = 1;
-	FILE * fd;
+	FILE * fd = fifo_fd;
 	char line[256];
 	int i, ret = 0;
 
-	/* get a file descriptor to the pipe */
-	fd = fdopen(fifo, "r");
-
-	if (fd == NULL) {
-		perror("oprofiled: couldn't create file descriptor: ");
-		exit(EXIT_FAILURE);
-	}
+	/* the pipe is non-blocking, EAGAIN or EOF from the previous call
+	 * must not stop us reading new requests */
+	clearerr(fd);
 
 	/* read up to 99 lines to check for 'do_jitconv' */
 	for (i = 0; i < 99; i++) {
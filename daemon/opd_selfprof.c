@@ -0,0 +1,89 @@
+/**
+ * @file daemon/opd_selfprof.c
+ * Self-profiling of the daemon sample processing
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "opd_selfprof.h"
+#include "opd_stats.h"
+#include "oprofiled.h"
+
+#include "op_stats_page.h"
+
+#include <stdio.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define OPD_PROF_UNIT "_cycles"
+#else
+#define OPD_PROF_UNIT "_usecs"
+#endif
+
+int opd_selfprof_enabled;
+
+static struct op_stats_histogram * histograms[OPD_PROF_MAX];
+
+/** escape codes without a handler share the histogram of code 0 */
+static char const * const point_names[OPD_PROF_MAX] = {
+	"code_unknown",
+	"code_ctx_switch",
+	"code_cpu_switch",
+	"code_cookie_switch",
+	"code_kernel_enter",
+	"code_user_enter",
+	"code_module_loaded",
+	NULL,
+	"code_trace_begin",
+	NULL,
+	"code_xen_enter",
+#if defined(__powerpc__)
+	"code_spu_profiling",
+	"code_spu_ctx_switch",
+#else
+	NULL,
+	NULL,
+#endif
+	"code_ibs_fetch_sample",
+	"code_ibs_op_sample",
+	"sfile_find",
+	"sample_file_open",
+	"odb_update_node",
+	"anon_maps_refresh",
+	"module_reread",
+};
+
+
+void opd_selfprof_init(void)
+{
+	char name[OP_STATS_NAME_LEN];
+	size_t i;
+
+	if (!self_profile)
+		return;
+
+	for (i = 0; i < OPD_PROF_MAX; ++i) {
+		if (!point_names[i]) {
+			histograms[i] = histograms[0];
+			continue;
+		}
+		snprintf(name, OP_STATS_NAME_LEN, "%s" OPD_PROF_UNIT,
+		         point_names[i]);
+		histograms[i] = opd_stats_histogram(name);
+		if (!histograms[i]) {
+			fprintf(stderr, "oprofiled: no room for self-profiling "
+			        "statistics, self-profiling disabled\n");
+			return;
+		}
+	}
+
+	opd_selfprof_enabled = 1;
+}
+
+
+void opd_selfprof_record(unsigned int point, u64 start)
+{
+	u64 end = opd_cycles();
+
+	opd_stats_histogram_add(histograms[point], end - start);
+}
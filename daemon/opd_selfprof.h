@@ -0,0 +1,77 @@
+/**
+ * @file daemon/opd_selfprof.h
+ * Self-profiling of the daemon sample processing
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * With --self-profile the time spent in each instrumented point is
+ * measured with the cycle counter and accounted in a per-point latency
+ * histogram of the live statistics page. When disabled an instrumented
+ * point costs a test of opd_selfprof_enabled.
+ *
+ * Usage:
+ *	u64 start = opd_selfprof_start();
+ *	...
+ *	opd_selfprof_end(OPD_PROF_SFILE_FIND, start);
+ */
+
+#ifndef OPD_SELFPROF_H
+#define OPD_SELFPROF_H
+
+#include "opd_interface.h"
+
+#include "op_types.h"
+
+#include <sys/time.h>
+
+/** instrumented points, the first LAST_CODE are the escape code handlers */
+enum {
+	OPD_PROF_SFILE_FIND = LAST_CODE,
+	OPD_PROF_SAMPLE_FILE_OPEN,
+	OPD_PROF_ODB_UPDATE,
+	OPD_PROF_ANON_REFRESH,
+	OPD_PROF_MODULE_REREAD,
+	OPD_PROF_MAX
+};
+
+/** non-zero if self-profiling is active */
+extern int opd_selfprof_enabled;
+
+/**
+ * opd_selfprof_init - register the self-profiling histograms
+ *
+ * Does nothing unless --self-profile was given, must be called after the
+ * live statistics page is created.
+ */
+void opd_selfprof_init(void);
+
+/** account the time elapsed since start to the given point */
+void opd_selfprof_record(unsigned int point, u64 start);
+
+/** read the cycle counter, or a microsecond clock if there is none */
+static inline u64 opd_cycles(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	u32 lo, hi;
+	__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+	return ((u64)hi << 32) | lo;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+#endif
+}
+
+static inline u64 opd_selfprof_start(void)
+{
+	return opd_selfprof_enabled ? opd_cycles() : 0;
+}
+
+static inline void opd_selfprof_end(unsigned int point, u64 start)
+{
+	if (opd_selfprof_enabled)
+		opd_selfprof_record(point, start);
+}
+
+#endif /* OPD_SELFPROF_H */
@@ -18,6 +18,8 @@
 #include "opd_printf.h"
 #include "opd_stats.h"
 #include "opd_extended.h"
+#include "opd_export.h"
+#include "opd_selfprof.h"
 #include "oprofiled.h"
 
 #include "op_libiberty.h"
@@ -217,7 +219,7 @@ create_sfile(unsigned long hash, struct transient const * trans,
 }
 
 
-struct sfile * sfile_find(struct transient const * trans)
+static struct sfile * do_sfile_find(struct transient const * trans)
 {
 	struct sfile * sf;
 	struct list_head * pos;
@@ -294,6 +296,15 @@ void sfile_dup(struct sfile * to, struct sfile * from)
 }
 
 
+struct sfile * sfile_find(struct transient const * trans)
+{
+	u64 start = opd_selfprof_start();
+	struct sfile * sf = do_sfile_find(trans);
+	opd_selfprof_end(OPD_PROF_SFILE_FIND, start);
+	return sf;
+}
+
+
 static odb_t * get_file(struct transient const * trans, int is_cg)
 {
 	struct sfile * sf = trans->current;
@@ -336,8 +347,11 @@ static odb_t * get_file(struct transient const * trans, int is_cg)
 	file = &cg->to.files[trans->event];
 
 open:
-	if (!odb_open_count(file))
+	if (!odb_open_count(file)) {
+		u64 start = opd_selfprof_start();
 		opd_open_sample_file(file, last, sf, trans->event, is_cg);
+		opd_selfprof_end(OPD_PROF_SAMPLE_FILE_OPEN, start);
+	}
 
 	/* Error is logged by opd_open_sample_file */
 	if (!odb_open_count(file))
@@ -390,6 +404,7 @@ static void sfile_log_arc(struct transient const * trans)
 	vma_t to = trans->last_pc;
 	uint64_t key;
 	odb_t * file;
+	u64 start;
 
 	file = get_file(trans, 1);
 
@@ -418,11 +433,16 @@ static void sfile_log_arc(struct transient const * trans)
 	key = to & (0xffffffff);
 	key |= ((uint64_t)from) << 32;
 
+	start = opd_selfprof_start();
 	err = odb_update_node(file, key);
+	opd_selfprof_end(OPD_PROF_ODB_UPDATE, start);
 	if (err) {
 		fprintf(stderr, "%s: %s\n", __FUNCTION__, strerror(err));
 		abort();
 	}
+
+	if (opd_export_active)
+		opd_export_sample(file, key, 1);
 }
 
 
@@ -438,6 +458,7 @@ void sfile_log_sample_count(struct transient const * trans,
 	int err;
 	vma_t pc = trans->pc;
 	odb_t * file;
+	u64 start;
 
 	if (trans->tracing == TRACING_ON) {
 		/* can happen if kernel sample falls through the cracks,
@@ -464,13 +485,18 @@ void sfile_log_sample_count(struct transient const * trans,
 		return;
 	}
 
+	start = opd_selfprof_start();
 	err = odb_update_node_with_offset(file,
 					  (odb_key_t)pc,
 					  count);
+	opd_selfprof_end(OPD_PROF_ODB_UPDATE, start);
 	if (err) {
 		fprintf(stderr, "%s: %s\n", __FUNCTION__, strerror(err));
 		abort();
 	}
+
+	if (opd_export_active)
+		opd_export_sample(file, (odb_key_t)pc, count);
 }
 
 
@@ -479,8 +505,10 @@ static int close_sfile(struct sfile * sf, void * data __attribute__((unused)))
 	size_t i;
 
 	/* it's OK to close a non-open odb file */
-	for (i = 0; i < op_nr_counters; ++i)
+	for (i = 0; i < op_nr_counters; ++i) {
+		opd_export_invalidate(&sf->files[i]);
 		odb_close(&sf->files[i]);
+	}
 
 	opd_ext_sfile_close(sf);
 
@@ -0,0 +1,102 @@
+/**
+ * @file daemon/opd_slice.c
+ * Rotation of the current session into time slices
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "opd_slice.h"
+#include "opd_sfile.h"
+#include "opd_printf.h"
+#include "oprofiled.h"
+
+#include "op_config.h"
+#include "op_file.h"
+
+#include <sys/stat.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+static unsigned int slice_nr;
+static time_t slice_start;
+
+
+static void start_slice(void)
+{
+	char path[PATH_MAX];
+	FILE * fp;
+	int len;
+
+	if (init_op_config_slice(slice_nr)) {
+		fprintf(stderr, "oprofiled: path of slice %u too long\n",
+		        slice_nr);
+		exit(EXIT_FAILURE);
+	}
+	slice_start = time(NULL);
+
+	len = snprintf(path, PATH_MAX, "%s%s", op_samples_current_dir,
+	               OP_SLICE_START_FILE);
+	if (len < 0 || len >= PATH_MAX) {
+		fprintf(stderr, "oprofiled: path of slice %u too long\n",
+		        slice_nr);
+		exit(EXIT_FAILURE);
+	}
+	create_path(path);
+
+	fp = fopen(path, "w");
+	if (!fp) {
+		fprintf(stderr, "oprofiled: couldn't create %s: %s\n",
+		        path, strerror(errno));
+		return;
+	}
+	fprintf(fp, "%lu\n", (unsigned long)slice_start);
+	fclose(fp);
+
+	verbprintf(vmisc, "Starting time slice %u\n", slice_nr);
+}
+
+
+void opd_slice_init(void)
+{
+	if (slice_interval <= 0)
+		return;
+
+	slice_nr = 0;
+	start_slice();
+}
+
+
+void opd_slice_restart(void)
+{
+	struct stat st;
+
+	if (slice_interval <= 0)
+		return;
+
+	/* opcontrol --reset removed the slices, number them from 0 again */
+	if (stat(op_samples_current_dir, &st))
+		slice_nr = 0;
+	else
+		++slice_nr;
+	start_slice();
+}
+
+
+void opd_slice_check(void)
+{
+	if (slice_interval <= 0)
+		return;
+
+	if (time(NULL) - slice_start < slice_interval)
+		return;
+
+	/* the swap: files of the old slice are closed but the sfiles
+	 * survive, the next sample re-opens them in the new directory */
+	sfile_close_files();
+	opd_slice_restart();
+}
@@ -0,0 +1,39 @@
+/**
+ * @file daemon/opd_slice.h
+ * Rotation of the current session into time slices
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#ifndef OPD_SLICE_H
+#define OPD_SLICE_H
+
+/**
+ * opd_slice_init - start the first time slice
+ *
+ * Does nothing unless --slice-interval was given. Otherwise redirect
+ * sample files to op_samples_current_dir/slice-0/ and record its start
+ * time.
+ */
+void opd_slice_init(void);
+
+/**
+ * opd_slice_check - rotate to the next slice if the current one expired
+ *
+ * Must be called between two sample buffers. Rotation closes the sample
+ * files of the current slice; sfiles are kept and their sample files are
+ * re-opened lazily in the new slice directory.
+ */
+void opd_slice_check(void);
+
+/**
+ * opd_slice_restart - start a new slice immediately
+ *
+ * Used on SIGHUP, after the sample files were closed. If opcontrol --reset
+ * or --save removed the current slice directory, the slices are numbered
+ * from 0 again.
+ */
+void opd_slice_restart(void);
+
+#endif /* OPD_SLICE_H */
@@ -14,13 +14,62 @@
 #include "oprofiled.h"
 
 #include "op_get_time.h"
+#include "op_config.h"
+#include "op_stats_page.h"
 
 #include <dirent.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
 
 unsigned long opd_stats[OPD_MAX_STATS];
 
+static char const * const opd_stats_names[OPD_MAX_STATS] = {
+	"samples",
+	"kernel_samples",
+	"process_samples",
+	"lost_no_ctx",
+	"lost_kernel",
+	"lost_samplefile",
+	"lost_no_mapping",
+	"dump_count",
+	"dangling_code",
+	"jit_conversions",
+	"jit_lost_samples",
+};
+
+/** driver statistics in /dev/oprofile/stats/ */
+static char const * const driver_stats_names[] = {
+	"event_lost_overflow",
+	"sample_lost_no_mapping",
+	"bt_lost_no_mapping",
+	"sample_lost_no_mm",
+};
+
+#define NR_DRIVER_STATS \
+	(sizeof(driver_stats_names) / sizeof(driver_stats_names[0]))
+
+/** driver statistics in /dev/oprofile/stats/cpu*, summed over the cpus */
+static char const * const cpu_stats_names[] = {
+	"sample_lost_overflow",
+	"sample_lost_task_exit",
+	"sample_received",
+	"backtrace_aborted",
+	"sample_invalid_eip",
+};
+
+#define NR_CPU_STATS (sizeof(cpu_stats_names) / sizeof(cpu_stats_names[0]))
+
+static struct op_stats_page * live_page;
+static struct op_stats_counter * page_stats[OPD_MAX_STATS];
+static struct op_stats_counter * page_driver_stats[NR_DRIVER_STATS];
+static struct op_stats_counter * page_cpu_stats[NR_CPU_STATS];
+static struct op_stats_histogram * page_latency;
+static time_t page_last_update;
+
 /**
  * print_if - print an integer value read from file filename,
  * do nothing if the value read == -1 except if force is non-zero
@@ -52,6 +101,12 @@ void opd_print_stats(void)
 		opd_stats[OPD_LOST_SAMPLEFILE]);
 	printf("Nr. samples lost due to no permanent mapping: %lu\n",
 		opd_stats[OPD_LOST_NO_MAPPING]);
+	if (opd_stats[OPD_JIT_CONVERSIONS]) {
+		printf("Nr. JIT dump conversions: %lu\n",
+			opd_stats[OPD_JIT_CONVERSIONS]);
+		printf("Nr. samples lost during JIT dump conversions: %lu\n",
+			opd_stats[OPD_JIT_LOST_SAMPLES]);
+	}
 	print_if("Nr. event lost due to buffer overflow: %u\n",
 	       "/dev/oprofile/stats", "event_lost_overflow", 1);
 	print_if("Nr. samples lost due to no mapping: %u\n",
@@ -88,3 +143,199 @@ void opd_print_stats(void)
 out:
 	fflush(stdout);
 }
+
+
+static struct op_stats_counter * add_counter(char const * prefix,
+                                             char const * name)
+{
+	char buf[OP_STATS_NAME_LEN];
+	snprintf(buf, OP_STATS_NAME_LEN, "%s%s", prefix, name);
+	return op_stats_page_counter(live_page, buf);
+}
+
+
+void opd_stats_page_init(size_t buffer_size)
+{
+	size_t i;
+
+	if (!stats_page && !self_profile) {
+		/* don't leave the page of a previous run looking alive */
+		unlink(op_stats_page_file);
+		return;
+	}
+
+	live_page = op_stats_page_create(op_stats_page_file);
+	if (!live_page) {
+		fprintf(stderr, "oprofiled: couldn't create %s: %s\n",
+		        op_stats_page_file, strerror(errno));
+		return;
+	}
+
+	live_page->buffer_size = buffer_size;
+
+	for (i = 0; i < OPD_MAX_STATS; ++i)
+		page_stats[i] = add_counter("", opd_stats_names[i]);
+	for (i = 0; i < NR_DRIVER_STATS; ++i)
+		page_driver_stats[i] = add_counter("driver_",
+		                                   driver_stats_names[i]);
+	for (i = 0; i < NR_CPU_STATS; ++i)
+		page_cpu_stats[i] = add_counter("driver_cpu_",
+		                                cpu_stats_names[i]);
+
+	page_latency = op_stats_page_histogram(live_page,
+	                                       "buffer_processing_usecs");
+
+	page_last_update = 0;
+	opd_stats_page_update(1);
+}
+
+
+void opd_stats_page_exit(void)
+{
+	if (!live_page)
+		return;
+
+	opd_stats_page_update(1);
+	op_stats_page_close(live_page);
+	live_page = NULL;
+}
+
+
+int opd_stats_page_enabled(void)
+{
+	return live_page != NULL;
+}
+
+
+void opd_stats_page_buffer(size_t fill, u64 usecs)
+{
+	if (!live_page)
+		return;
+
+	op_stats_page_begin(live_page);
+	live_page->buffer_fill = fill;
+	if (fill > live_page->buffer_fill_max)
+		live_page->buffer_fill_max = fill;
+	op_stats_histogram_add(page_latency, usecs);
+	op_stats_page_end(live_page);
+}
+
+
+static void set_counter(struct op_stats_counter * counter, u64 value,
+                        time_t elapsed)
+{
+	if (elapsed > 0 && value >= counter->value)
+		counter->rate = (value - counter->value) / elapsed;
+	counter->value = value;
+}
+
+
+/** read a driver statistic, 0 if the kernel doesn't provide it */
+static u64 read_driver_stat(char const * path, char const * name)
+{
+	int value = opd_read_fs_int(path, name, 0);
+	return value == -1 ? 0 : (u32)value;
+}
+
+
+void opd_stats_page_update(int force)
+{
+	u64 driver_values[NR_DRIVER_STATS];
+	u64 cpu_values[NR_CPU_STATS];
+	DIR * dir;
+	struct dirent * dirent;
+	time_t now;
+	time_t elapsed;
+	size_t i;
+
+	if (!live_page)
+		return;
+
+	now = time(NULL);
+	if (!force && now == page_last_update)
+		return;
+
+	elapsed = page_last_update ? now - page_last_update : 0;
+	page_last_update = now;
+
+	/* the driver files are read before the update starts, readers must
+	 * not spin on the page during these syscalls */
+	for (i = 0; i < NR_DRIVER_STATS; ++i) {
+		driver_values[i] = read_driver_stat("/dev/oprofile/stats",
+		                                    driver_stats_names[i]);
+	}
+	memset(cpu_values, 0, sizeof(cpu_values));
+	if ((dir = opendir("/dev/oprofile/stats/"))) {
+		while ((dirent = readdir(dir))) {
+			int cpu_nr;
+			char path[256];
+			if (sscanf(dirent->d_name, "cpu%d", &cpu_nr) != 1)
+				continue;
+			snprintf(path, 256, "/dev/oprofile/stats/%s",
+			         dirent->d_name);
+			for (i = 0; i < NR_CPU_STATS; ++i)
+				cpu_values[i] += read_driver_stat(path,
+				                         cpu_stats_names[i]);
+		}
+		closedir(dir);
+	}
+
+	op_stats_page_begin(live_page);
+
+	for (i = 0; i < OPD_MAX_STATS; ++i) {
+		if (page_stats[i])
+			set_counter(page_stats[i], opd_stats[i], elapsed);
+	}
+	for (i = 0; i < NR_DRIVER_STATS; ++i) {
+		if (page_driver_stats[i])
+			set_counter(page_driver_stats[i], driver_values[i],
+			            elapsed);
+	}
+	for (i = 0; i < NR_CPU_STATS; ++i) {
+		if (page_cpu_stats[i])
+			set_counter(page_cpu_stats[i], cpu_values[i], elapsed);
+	}
+	live_page->update_time = now;
+
+	op_stats_page_end(live_page);
+}
+
+
+struct op_stats_histogram * opd_stats_histogram(char const * name)
+{
+	if (!live_page)
+		return NULL;
+	return op_stats_page_histogram(live_page, name);
+}
+
+
+void opd_stats_histogram_add(struct op_stats_histogram * hist, u64 value)
+{
+	op_stats_page_begin(live_page);
+	op_stats_histogram_add(hist, value);
+	op_stats_page_end(live_page);
+}
+
+
+u64 opd_read_lost_samples(void)
+{
+	DIR * dir;
+	struct dirent * dirent;
+	u64 lost;
+
+	lost = read_driver_stat("/dev/oprofile/stats", "event_lost_overflow");
+
+	if (!(dir = opendir("/dev/oprofile/stats/")))
+		return lost;
+	while ((dirent = readdir(dir))) {
+		int cpu_nr;
+		char path[256];
+		if (sscanf(dirent->d_name, "cpu%d", &cpu_nr) != 1)
+			continue;
+		snprintf(path, 256, "/dev/oprofile/stats/%s", dirent->d_name);
+		lost += read_driver_stat(path, "sample_lost_overflow");
+	}
+	closedir(dir);
+
+	return lost;
+}
@@ -12,6 +12,12 @@
 #ifndef OPD_STATS_H
 #define OPD_STATS_H
 
+#include "op_types.h"
+
+#include <stddef.h>
+
+struct op_stats_histogram;
+
 extern unsigned long opd_stats[];
 
 enum {	OPD_SAMPLES, /**< nr. samples */
@@ -23,9 +29,63 @@ enum {	OPD_SAMPLES, /**< nr. samples */
 	OPD_LOST_NO_MAPPING, /**< nr samples lost due to no mapping */
 	OPD_DUMP_COUNT, /**< nr. of times buffer is read */
 	OPD_DANGLING_CODE, /**< nr. partial code notifications (buffer overflow */
+	OPD_JIT_CONVERSIONS, /**< nr. of JIT dump conversions started */
+	OPD_JIT_LOST_SAMPLES, /**< nr. samples lost by the driver during JIT dump conversions */
 	OPD_MAX_STATS /**< end of stats */
 };
 
 void opd_print_stats(void);
 
+/** return the nr. of samples lost by the driver so far */
+u64 opd_read_lost_samples(void);
+
+/**
+ * opd_stats_page_init - create the live statistics page
+ * @param buffer_size  size in bytes of the daemon sample buffer
+ *
+ * Does nothing unless --stats-page or --self-profile was given. Failure
+ * to create the page is logged, the page is then not updated.
+ */
+void opd_stats_page_init(size_t buffer_size);
+
+/** unmap the statistics page, it stays readable until the next start */
+void opd_stats_page_exit(void);
+
+/**
+ * opd_stats_page_buffer - account a processed sample buffer
+ * @param fill  nr. of bytes read
+ * @param usecs  processing time in microseconds
+ */
+void opd_stats_page_buffer(size_t fill, u64 usecs);
+
+/**
+ * opd_stats_page_update - refresh counters and rates
+ *
+ * The counters are refreshed at most once per second unless force
+ * is non-zero. This reads the driver statistics, it is called from the
+ * alarm every OPD_STATS_PAGE_INTERVAL seconds, not per sample buffer.
+ */
+void opd_stats_page_update(int force);
+
+/** period in seconds of the statistics page refresh */
+#define OPD_STATS_PAGE_INTERVAL 1
+
+/** return non-zero if the statistics page is updated */
+int opd_stats_page_enabled(void);
+
+/**
+ * opd_stats_histogram - register an histogram in the statistics page
+ * @param name  histogram name
+ *
+ * Return NULL if there is no statistics page or it is full.
+ */
+struct op_stats_histogram * opd_stats_histogram(char const * name);
+
+/**
+ * opd_stats_histogram_add - add a value to an histogram of the page
+ * @param hist  histogram returned by opd_stats_histogram()
+ * @param value  the value
+ */
+void opd_stats_histogram_add(struct op_stats_histogram * hist, u64 value);
+
 #endif /* OPD_STATS_H */
@@ -23,6 +23,7 @@
 #include "opd_stats.h"
 #include "opd_printf.h"
 #include "opd_interface.h"
+#include "opd_selfprof.h"
  
 #include <limits.h>
 #include <string.h>
@@ -223,8 +224,12 @@ static void code_user_enter(struct transient * trans)
 
 static void code_module_loaded(struct transient * trans __attribute__((unused)))
 {
+	u64 start;
+
 	verbprintf(vmodule, "MODULE_LOADED_CODE\n");
+	start = opd_selfprof_start();
 	opd_reread_module_info();
+	opd_selfprof_end(OPD_PROF_MODULE_REREAD, start);
 	clear_trans_current(trans);
 	clear_trans_last(trans);
 }
@@ -315,6 +320,7 @@ void opd_process_samples(char const * buffer, size_t count)
 	 * generate a warning, this look like a stopper to use c98 types :/
 	 */
 	unsigned long long code;
+	u64 start;
 
 	if (special_processor) {
 		special_processor(&trans);
@@ -343,6 +349,8 @@ void opd_process_samples(char const * buffer, size_t count)
 			abort();
 		}
 
+		start = opd_selfprof_start();
 		handlers[code](&trans);
+		opd_selfprof_end(code, start);
 	}
 }
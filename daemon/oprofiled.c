@@ -64,6 +64,10 @@ int separate_lib;
 int separate_kernel;
 int separate_thread;
 int separate_cpu;
+int slice_interval;
+int export_interval;
+int self_profile;
+int stats_page;
 int no_vmlinux;
 char * vmlinux;
 char * kernel_range;
@@ -95,6 +99,10 @@ static struct poptOption options[] = {
 	{ "separate-kernel", 0, POPT_ARG_INT, &separate_kernel, 0, "separate kernel samples for each distinct application", "[0|1]", },
 	{ "separate-thread", 0, POPT_ARG_INT, &separate_thread, 0, "thread-profiling mode", "[0|1]" },
 	{ "separate-cpu", 0, POPT_ARG_INT, &separate_cpu, 0, "separate samples for each CPU", "[0|1]" },
+	{ "slice-interval", 0, POPT_ARG_INT, &slice_interval, 0, "rotate the current session into a new time slice every N seconds", "seconds" },
+	{ "export-interval", 0, POPT_ARG_INT, &export_interval, 0, "stream sample deltas every N seconds to collectors connected to the export socket", "seconds" },
+	{ "self-profile", 0, POPT_ARG_NONE, &self_profile, 0, "account the daemon processing time in the statistics page", NULL, },
+	{ "stats-page", 0, POPT_ARG_NONE, &stats_page, 0, "refresh the live statistics page every second", NULL, },
 	{ "events", 'e', POPT_ARG_STRING, &events, 0, "events list", "[events]" },
 	{ "version", 'v', POPT_ARG_NONE, &showvers, 0, "show version", NULL, },
 	{ "verbose", 'V', POPT_ARG_STRING, &verbose, 0, "be verbose in log file", "all,sfile,arcs,samples,module,misc", },
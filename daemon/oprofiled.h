@@ -59,6 +59,10 @@ extern int separate_lib;
 extern int separate_kernel;
 extern int separate_thread;
 extern int separate_cpu;
+extern int slice_interval;
+extern int export_interval;
+extern int self_profile;
+extern int stats_page;
 extern int no_vmlinux;
 extern char * vmlinux;
 extern char * kernel_range;
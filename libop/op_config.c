@@ -25,6 +25,8 @@ char op_samples_current_dir[PATH_MAX];
 char op_lock_file[PATH_MAX];
 char op_log_file[PATH_MAX];
 char op_pipe_file[PATH_MAX];
+char op_export_socket[PATH_MAX];
+char op_stats_page_file[PATH_MAX];
 char op_dump_status[PATH_MAX];
 
 /* paths in op_config_24.h */
@@ -60,6 +62,12 @@ init_op_config_dirs(char const * session_dir)
 	strcpy(op_pipe_file, op_session_dir);
 	strcat(op_pipe_file, "/opd_pipe");
 
+	strcpy(op_export_socket, op_session_dir);
+	strcat(op_export_socket, "/opd_export");
+
+	strcpy(op_stats_page_file, op_session_dir);
+	strcat(op_stats_page_file, "/opd_stats");
+
 	strcpy(op_log_file, op_samples_dir);
 	strcat(op_log_file, "oprofiled.log");
 
@@ -75,3 +83,18 @@ init_op_config_dirs(char const * session_dir)
 	strcpy(op_hash_device, op_session_dir);
 	strcat(op_hash_device, "/ophashmapdev");
 }
+
+
+int init_op_config_slice(unsigned int slice)
+{
+	char dir[PATH_MAX];
+	int len;
+
+	len = snprintf(dir, PATH_MAX, "%s/current/%s%u/",
+	               op_samples_dir, OP_SLICE_PREFIX, slice);
+	if (len < 0 || len >= PATH_MAX)
+		return -1;
+
+	strcpy(op_samples_current_dir, dir);
+	return 0;
+}
@@ -25,6 +25,16 @@ extern "C" {
  */
 void init_op_config_dirs(char const * session_dir);
 
+/**
+ * redirect op_samples_current_dir to the given time slice sub-directory
+ * of the current session, must be called after init_op_config_dirs()
+ * @param slice  the slice number
+ *
+ * Return -1, leaving op_samples_current_dir unchanged, if the path of
+ * the slice is too long, 0 otherwise.
+ */
+int init_op_config_slice(unsigned int slice);
+
 #define OP_SESSION_DIR_DEFAULT "/var/lib/oprofile/"
 
 /* 
@@ -37,6 +47,8 @@ extern char op_samples_current_dir[];
 extern char op_lock_file[];
 extern char op_log_file[];
 extern char op_pipe_file[];
+extern char op_export_socket[];
+extern char op_stats_page_file[];
 extern char op_dump_status[];
 
 /* Global directory that stores debug files */
@@ -44,6 +56,12 @@ extern char op_dump_status[];
 #define DEBUGDIR "/usr/lib/debug"
 #endif
 
+/* time slices of the current session are stored under
+ * op_samples_dir/current/OP_SLICE_PREFIX<nr>/, each slice directory holding
+ * the start time, in seconds since the Epoch, in OP_SLICE_START_FILE */
+#define OP_SLICE_PREFIX "slice-"
+#define OP_SLICE_START_FILE "start_time"
+
 #define OPD_MAGIC "DAE\n"
 #define OPD_VERSION 0x11
 
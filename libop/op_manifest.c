@@ -0,0 +1,300 @@
+/**
+ * @file op_manifest.c
+ * Index of the sample files of a session
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "op_manifest.h"
+#include "op_config.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+
+/* return -1 with errno set if the name doesn't fit in PATH_MAX */
+static int manifest_name(char * name, char const * dir, char const * suffix)
+{
+	int len;
+
+	len = snprintf(name, PATH_MAX, "%s/%s%s", dir, OP_MANIFEST_FILE, suffix);
+	if (len < 0 || len >= PATH_MAX) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	return 0;
+}
+
+
+static int write_header(int fd)
+{
+	struct op_manifest_header header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, OP_MANIFEST_MAGIC, sizeof(header.magic));
+	header.version = OP_MANIFEST_VERSION;
+
+	if (write(fd, &header, sizeof(header)) != sizeof(header))
+		return -1;
+	return 0;
+}
+
+
+/* a single write() so concurrent appends don't interleave */
+static int write_record(int fd, char const * path,
+                        struct opd_header const * header)
+{
+	struct op_manifest_record record;
+	size_t const len = strlen(path);
+	size_t const size = sizeof(record) + len;
+	char * buf;
+	ssize_t len_written;
+	int ret = 0;
+
+	memset(&record, 0, sizeof(record));
+	record.header = *header;
+	record.path_len = len;
+
+	buf = malloc(size);
+	if (!buf)
+		return -1;
+	memcpy(buf, &record, sizeof(record));
+	memcpy(buf + sizeof(record), path, len);
+
+	len_written = write(fd, buf, size);
+	if (len_written != (ssize_t)size) {
+		if (len_written >= 0)
+			errno = ENOSPC;
+		ret = -1;
+	}
+
+	free(buf);
+	return ret;
+}
+
+
+int op_manifest_create(char const * dir)
+{
+	char name[PATH_MAX];
+	int fd;
+	int ret;
+
+	if (manifest_name(name, dir, ""))
+		return -1;
+	fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1)
+		return -1;
+
+	ret = write_header(fd);
+	close(fd);
+	return ret;
+}
+
+
+int op_manifest_append(char const * dir, char const * path,
+                       struct opd_header const * header)
+{
+	char name[PATH_MAX];
+	int fd;
+	int ret;
+
+	if (manifest_name(name, dir, ""))
+		return -1;
+	fd = open(name, O_WRONLY | O_APPEND);
+	if (fd == -1)
+		return -1;
+
+	ret = write_record(fd, path, header);
+	close(fd);
+	return ret;
+}
+
+
+int op_manifest_read(char const * dir, op_manifest_fn fn, void * data)
+{
+	char name[PATH_MAX];
+	struct op_manifest_header header;
+	struct op_manifest_record record;
+	char * path = NULL;
+	size_t path_size = 0;
+	FILE * fp;
+	size_t len;
+	int ret = 0;
+
+	if (manifest_name(name, dir, ""))
+		return -1;
+	fp = fopen(name, "r");
+	if (!fp)
+		return -1;
+
+	if (fread(&header, sizeof(header), 1, fp) != 1 ||
+	    memcmp(header.magic, OP_MANIFEST_MAGIC, sizeof(header.magic)) ||
+	    header.version != OP_MANIFEST_VERSION) {
+		fclose(fp);
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (;;) {
+		len = fread(&record, 1, sizeof(record), fp);
+		if (len == 0)
+			break;
+
+		/* a record truncated by a crash, the session may hold a
+		 * sample file we don't know about */
+		if (len != sizeof(record)) {
+			errno = EINVAL;
+			ret = -1;
+			break;
+		}
+
+		if (record.path_len >= path_size) {
+			path_size = record.path_len + 1;
+			free(path);
+			path = malloc(path_size);
+			if (!path) {
+				ret = -1;
+				break;
+			}
+		}
+		if (fread(path, 1, record.path_len, fp) != record.path_len) {
+			errno = EINVAL;
+			ret = -1;
+			break;
+		}
+		path[record.path_len] = '\0';
+
+		ret = fn(path, &record.header, data);
+		if (ret)
+			break;
+	}
+
+	if (!ret && ferror(fp))
+		ret = -1;
+
+	free(path);
+	fclose(fp);
+	return ret;
+}
+
+
+/* record the sample file path[base_len..] if it is one */
+static int add_file(int fd, char const * path, size_t base_len)
+{
+	struct opd_header header;
+	ssize_t len;
+	int in;
+
+	in = open(path, O_RDONLY);
+	if (in == -1)
+		return 0;
+
+	len = read(in, &header, sizeof(header));
+	close(in);
+
+	if (len != sizeof(header) ||
+	    memcmp(header.magic, OPD_MAGIC, sizeof(header.magic)))
+		return 0;
+
+	if (write_record(fd, path + base_len, &header))
+		return -1;
+	return 1;
+}
+
+
+/* walk the directory path, of length len, which has room for PATH_MAX */
+static int walk(int fd, char * path, size_t len, size_t base_len)
+{
+	DIR * dir;
+	struct dirent * dirent;
+	struct stat st;
+	int count = 0;
+	int ret;
+
+	dir = opendir(path);
+	if (!dir)
+		return 0;
+
+	while ((dirent = readdir(dir)) != NULL) {
+		size_t const name_len = strlen(dirent->d_name);
+		if (!strcmp(dirent->d_name, ".") ||
+		    !strcmp(dirent->d_name, ".."))
+			continue;
+		if (len + name_len + 2 > PATH_MAX)
+			continue;
+
+		path[len] = '/';
+		strcpy(path + len + 1, dirent->d_name);
+		if (lstat(path, &st))
+			continue;
+
+		if (S_ISDIR(st.st_mode))
+			ret = walk(fd, path, len + 1 + name_len, base_len);
+		else if (S_ISREG(st.st_mode))
+			ret = add_file(fd, path, base_len);
+		else
+			ret = 0;
+
+		if (ret < 0) {
+			count = -1;
+			break;
+		}
+		count += ret;
+	}
+
+	path[len] = '\0';
+	closedir(dir);
+	return count;
+}
+
+
+int op_manifest_rebuild(char const * dir)
+{
+	char name[PATH_MAX];
+	char tmp_name[PATH_MAX];
+	char path[PATH_MAX];
+	size_t len;
+	int fd;
+	int count;
+
+	len = strlen(dir);
+	while (len > 1 && dir[len - 1] == '/')
+		--len;
+	if (len >= PATH_MAX) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	memcpy(path, dir, len);
+	path[len] = '\0';
+
+	if (manifest_name(name, path, "") ||
+	    manifest_name(tmp_name, path, ".tmp"))
+		return -1;
+
+	fd = open(tmp_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1)
+		return -1;
+
+	count = -1;
+	if (!write_header(fd))
+		count = walk(fd, path, len, len + 1);
+
+	if (close(fd))
+		count = -1;
+
+	if (count < 0 || rename(tmp_name, name)) {
+		unlink(tmp_name);
+		return -1;
+	}
+
+	return count;
+}
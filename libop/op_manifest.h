@@ -0,0 +1,98 @@
+/**
+ * @file op_manifest.h
+ * Index of the sample files of a session
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * A session directory can hold a manifest listing all its sample files
+ * with their header, so the pp tools don't need to walk the session tree
+ * nor to open each file to know its event. The manifest is a
+ * struct op_manifest_header followed by one struct op_manifest_record per
+ * sample file, itself followed by the path_len bytes of the file path
+ * relative to the session directory, without terminating zero.
+ *
+ * The daemon appends a record each time it creates a sample file or
+ * changes the header of an existing one, the last record of a path is
+ * the current one. Each record is written with a single write() to a
+ * file opened with O_APPEND. The sample files removed since they were
+ * recorded are skipped by the readers. op_manifest_rebuild() creates the manifest of a session
+ * which has none.
+ */
+
+#ifndef OP_MANIFEST_H
+#define OP_MANIFEST_H
+
+#include "op_types.h"
+#include "op_sample_file.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define OP_MANIFEST_FILE "manifest"
+#define OP_MANIFEST_MAGIC "OPMF"
+#define OP_MANIFEST_VERSION 1
+
+struct op_manifest_header {
+	u8 magic[4];
+	u32 version;
+};
+
+struct op_manifest_record {
+	struct opd_header header;
+	u32 path_len;
+	u32 reserved;
+};
+
+/**
+ * op_manifest_create - create an empty manifest
+ * @param dir  the session directory
+ *
+ * An existing manifest is truncated. Return 0 on success, -1 with errno
+ * set on failure.
+ */
+int op_manifest_create(char const * dir);
+
+/**
+ * op_manifest_append - add a sample file to a manifest
+ * @param dir  the session directory
+ * @param path  the sample file path relative to dir
+ * @param header  the sample file header
+ *
+ * The manifest is not created if it doesn't exist. Return 0 on success,
+ * -1 with errno set on failure.
+ */
+int op_manifest_append(char const * dir, char const * path,
+                       struct opd_header const * header);
+
+typedef int (*op_manifest_fn)(char const * path,
+                              struct opd_header const * header, void * data);
+
+/**
+ * op_manifest_read - iterate over the records of a manifest
+ * @param dir  the session directory
+ * @param fn  called for each record with the relative path
+ * @param data  passed to fn
+ *
+ * Iteration stops at the first non-zero return of fn, which is returned.
+ * Return -1 with errno set if the manifest doesn't exist or is invalid,
+ * in which case fn may have been called for the valid records.
+ */
+int op_manifest_read(char const * dir, op_manifest_fn fn, void * data);
+
+/**
+ * op_manifest_rebuild - create the manifest of a session
+ * @param dir  the session directory
+ *
+ * Walk dir and record all the sample files found, any previous manifest
+ * is replaced atomically. Return the number of sample files recorded or
+ * -1 with errno set on failure.
+ */
+int op_manifest_rebuild(char const * dir);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* OP_MANIFEST_H */
@@ -0,0 +1,261 @@
+/**
+ * @file op_report_export.c
+ * Binary columnar export of a profile
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "op_report_export.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+enum table {
+	TABLE_NONE,
+	TABLE_CLASSES,
+	TABLE_SYMBOLS,
+	TABLE_SAMPLES,
+	TABLE_ARCS
+};
+
+struct column_desc {
+	enum table table;
+	unsigned int value_size;
+	/* one array of values per profile class */
+	int per_class;
+};
+
+static struct column_desc const columns[OP_REPORT_EXPORT_NR_SECTIONS] = {
+	{ TABLE_NONE, 1, 0 },		/* OP_REPORT_EXPORT_STRINGS */
+	{ TABLE_CLASSES, 4, 0 },	/* OP_REPORT_EXPORT_CLASS_NAME */
+	{ TABLE_CLASSES, 4, 0 },	/* OP_REPORT_EXPORT_CLASS_LONGNAME */
+	{ TABLE_SYMBOLS, 4, 0 },	/* OP_REPORT_EXPORT_SYM_IMAGE */
+	{ TABLE_SYMBOLS, 4, 0 },	/* OP_REPORT_EXPORT_SYM_APP */
+	{ TABLE_SYMBOLS, 4, 0 },	/* OP_REPORT_EXPORT_SYM_NAME */
+	{ TABLE_SYMBOLS, 4, 0 },	/* OP_REPORT_EXPORT_SYM_FILE */
+	{ TABLE_SYMBOLS, 4, 0 },	/* OP_REPORT_EXPORT_SYM_LINE */
+	{ TABLE_SYMBOLS, 8, 0 },	/* OP_REPORT_EXPORT_SYM_VMA */
+	{ TABLE_SYMBOLS, 8, 0 },	/* OP_REPORT_EXPORT_SYM_SIZE */
+	{ TABLE_SYMBOLS, 8, 1 },	/* OP_REPORT_EXPORT_SYM_COUNTS */
+	{ TABLE_SAMPLES, 4, 0 },	/* OP_REPORT_EXPORT_SAMPLE_SYMBOL */
+	{ TABLE_SAMPLES, 8, 0 },	/* OP_REPORT_EXPORT_SAMPLE_VMA */
+	{ TABLE_SAMPLES, 4, 0 },	/* OP_REPORT_EXPORT_SAMPLE_FILE */
+	{ TABLE_SAMPLES, 4, 0 },	/* OP_REPORT_EXPORT_SAMPLE_LINE */
+	{ TABLE_SAMPLES, 8, 1 },	/* OP_REPORT_EXPORT_SAMPLE_COUNTS */
+	{ TABLE_ARCS, 4, 0 },		/* OP_REPORT_EXPORT_ARC_SYMBOL */
+	{ TABLE_ARCS, 4, 0 },		/* OP_REPORT_EXPORT_ARC_KIND */
+	{ TABLE_ARCS, 4, 0 },		/* OP_REPORT_EXPORT_ARC_IMAGE */
+	{ TABLE_ARCS, 4, 0 },		/* OP_REPORT_EXPORT_ARC_APP */
+	{ TABLE_ARCS, 4, 0 },		/* OP_REPORT_EXPORT_ARC_NAME */
+	{ TABLE_ARCS, 8, 0 },		/* OP_REPORT_EXPORT_ARC_VMA */
+	{ TABLE_ARCS, 8, 1 },		/* OP_REPORT_EXPORT_ARC_COUNTS */
+};
+
+
+static u64 align(u64 offset)
+{
+	return (offset + 7) & ~(u64)7;
+}
+
+
+static u64 nr_rows(struct op_report_export_header const * header,
+                   enum table table)
+{
+	switch (table) {
+	case TABLE_CLASSES:
+		return header->nr_classes;
+	case TABLE_SYMBOLS:
+		return header->nr_symbols;
+	case TABLE_SAMPLES:
+		return header->nr_samples;
+	case TABLE_ARCS:
+		return header->nr_arcs;
+	case TABLE_NONE:
+		break;
+	}
+	return 0;
+}
+
+
+/**
+ * column_size - compute the size of a column
+ * @param header  the export header
+ * @param section  the column
+ * @param size  the size, set on success
+ *
+ * Return -1 if the size doesn't fit in a size_t, a corrupted row count
+ * must not wrap around to the size written in the header.
+ */
+static int column_size(struct op_report_export_header const * header,
+                       int section, u64 * size)
+{
+	struct column_desc const * desc = &columns[section];
+	u64 const rows = nr_rows(header, desc->table);
+	u64 const nr_arrays = desc->per_class ? header->nr_classes : 1;
+
+	if (nr_arrays && rows > SIZE_MAX / desc->value_size / nr_arrays)
+		return -1;
+
+	*size = rows * desc->value_size * nr_arrays;
+	return 0;
+}
+
+
+u64 op_report_export_init_header(struct op_report_export_header * header,
+                                 u32 nr_classes, u64 nr_symbols,
+                                 u64 nr_samples, u64 nr_arcs,
+                                 u64 strings_size)
+{
+	u64 offset = align(sizeof(*header));
+	int i;
+
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, OP_REPORT_EXPORT_MAGIC, sizeof(header->magic));
+	header->version = OP_REPORT_EXPORT_VERSION;
+	header->byte_order = OP_REPORT_EXPORT_BYTE_ORDER;
+	header->nr_classes = nr_classes;
+	header->nr_symbols = nr_symbols;
+	header->nr_samples = nr_samples;
+	header->nr_arcs = nr_arcs;
+
+	for (i = 0; i < OP_REPORT_EXPORT_NR_SECTIONS; ++i) {
+		u64 size = strings_size;
+
+		if (i != OP_REPORT_EXPORT_STRINGS &&
+		    column_size(header, i, &size))
+			return 0;
+		if (size > SIZE_MAX - 7 - offset)
+			return 0;
+
+		header->sections[i].offset = offset;
+		header->sections[i].size = size;
+		offset = align(offset + size);
+	}
+
+	return offset;
+}
+
+
+static int check_export(struct op_report_export const * exp)
+{
+	struct op_report_export_header const * header = exp->header;
+	struct op_report_export_section_desc const * strings;
+	char const * base;
+	u64 size;
+	int i;
+
+	if (exp->size < sizeof(*header) ||
+	    memcmp(header->magic, OP_REPORT_EXPORT_MAGIC,
+	           sizeof(header->magic)) ||
+	    header->version != OP_REPORT_EXPORT_VERSION ||
+	    header->byte_order != OP_REPORT_EXPORT_BYTE_ORDER)
+		return -1;
+
+	for (i = 0; i < OP_REPORT_EXPORT_NR_SECTIONS; ++i) {
+		struct op_report_export_section_desc const * desc =
+			&header->sections[i];
+
+		if (desc->offset % 8 || desc->offset > exp->size ||
+		    desc->size > exp->size - desc->offset)
+			return -1;
+		if (i == OP_REPORT_EXPORT_STRINGS)
+			continue;
+		if (column_size(header, i, &size) || desc->size != size)
+			return -1;
+	}
+
+	/* the empty string is at offset 0 and all strings are terminated */
+	strings = &header->sections[OP_REPORT_EXPORT_STRINGS];
+	base = (char const *)exp->base + strings->offset;
+	if (!strings->size || base[0] != '\0' ||
+	    base[strings->size - 1] != '\0')
+		return -1;
+
+	return 0;
+}
+
+
+int op_report_export_open(struct op_report_export * exp, char const * filename)
+{
+	struct stat st;
+	int fd;
+	int err;
+
+	fd = open(filename, O_RDONLY);
+	if (fd == -1)
+		return -1;
+
+	if (fstat(fd, &st)) {
+		err = errno;
+		close(fd);
+		errno = err;
+		return -1;
+	}
+
+	if ((u64)st.st_size < sizeof(struct op_report_export_header)) {
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+
+	exp->size = st.st_size;
+	exp->base = mmap(0, exp->size, PROT_READ, MAP_SHARED, fd, 0);
+	err = errno;
+	close(fd);
+	if (exp->base == MAP_FAILED) {
+		errno = err;
+		return -1;
+	}
+	exp->header = exp->base;
+
+	if (check_export(exp)) {
+		munmap(exp->base, exp->size);
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+
+void op_report_export_close(struct op_report_export * exp)
+{
+	munmap(exp->base, exp->size);
+	exp->base = 0;
+	exp->header = 0;
+}
+
+
+void const * op_report_export_column(struct op_report_export const * exp,
+                                     enum op_report_export_section section)
+{
+	return (char const *)exp->base + exp->header->sections[section].offset;
+}
+
+
+char const * op_report_export_string(struct op_report_export const * exp,
+                                     u32 offset)
+{
+	if (offset >= exp->header->sections[OP_REPORT_EXPORT_STRINGS].size)
+		return 0;
+	return (char const *)op_report_export_column(exp,
+		OP_REPORT_EXPORT_STRINGS) + offset;
+}
+
+
+u64 op_report_export_count(struct op_report_export const * exp,
+                           enum op_report_export_section section,
+                           u32 pclass, u64 row)
+{
+	u64 const * counts = op_report_export_column(exp, section);
+	u64 const rows = nr_rows(exp->header, columns[section].table);
+
+	return counts[pclass * rows + row];
+}
@@ -0,0 +1,187 @@
+/**
+ * @file op_report_export.h
+ * Binary columnar export of a profile
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * opreport --binary-out writes the symbols of a report in a file meant to
+ * be mapped by the tools analysing it rather than parsed. The file is a
+ * struct op_report_export_header followed by the sections it describes, each
+ * starting on an 8 bytes boundary. All the values are in the byte order
+ * of the host which wrote the file.
+ *
+ * A section is either the string table or a column, an array holding one
+ * value per row of a table. The tables are the profile classes, the
+ * symbols, the samples of the symbols, written with --details, and the
+ * call graph arcs, written with --callgraph. A count column holds one
+ * array per profile class, each one holding the counts of all the rows
+ * of its table: the count of row r for class c is at c * nr_rows + r.
+ *
+ * The strings are zero terminated and referred to by their offset in
+ * the string table. The offset 0 is the empty string, used for missing
+ * debug information. Filenames are full paths, symbol names are
+ * demangled as opreport does.
+ *
+ * This file and op_report_export.c only depend on op_types.h so they can be
+ * built into the tools reading the export.
+ */
+
+#ifndef OP_REPORT_EXPORT_H
+#define OP_REPORT_EXPORT_H
+
+#include <stddef.h>
+
+#include "op_types.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define OP_REPORT_EXPORT_MAGIC "OPEXPORT"
+#define OP_REPORT_EXPORT_VERSION 1
+/** written as a u32 to detect a file of the other byte order */
+#define OP_REPORT_EXPORT_BYTE_ORDER 0x01020304
+
+enum op_report_export_section {
+	/* string table: char */
+	OP_REPORT_EXPORT_STRINGS,
+
+	/* profile classes: u32 string offsets */
+	OP_REPORT_EXPORT_CLASS_NAME,
+	OP_REPORT_EXPORT_CLASS_LONGNAME,
+
+	/* symbols */
+	OP_REPORT_EXPORT_SYM_IMAGE,	/**< u32 string offset */
+	OP_REPORT_EXPORT_SYM_APP,	/**< u32 string offset */
+	OP_REPORT_EXPORT_SYM_NAME,	/**< u32 string offset */
+	OP_REPORT_EXPORT_SYM_FILE,	/**< u32 string offset */
+	OP_REPORT_EXPORT_SYM_LINE,	/**< u32 */
+	OP_REPORT_EXPORT_SYM_VMA,	/**< u64 */
+	OP_REPORT_EXPORT_SYM_SIZE,	/**< u64 */
+	OP_REPORT_EXPORT_SYM_COUNTS,	/**< u64 per class */
+
+	/* samples of the symbols */
+	OP_REPORT_EXPORT_SAMPLE_SYMBOL,	/**< u32 row in the symbols */
+	OP_REPORT_EXPORT_SAMPLE_VMA,		/**< u64 */
+	OP_REPORT_EXPORT_SAMPLE_FILE,		/**< u32 string offset */
+	OP_REPORT_EXPORT_SAMPLE_LINE,		/**< u32 */
+	OP_REPORT_EXPORT_SAMPLE_COUNTS,	/**< u64 per class */
+
+	/* call graph arcs between a symbol and its callers or callees */
+	OP_REPORT_EXPORT_ARC_SYMBOL,	/**< u32 row in the symbols */
+	/** u32 enum op_report_export_arc_kind */
+	OP_REPORT_EXPORT_ARC_KIND,
+	OP_REPORT_EXPORT_ARC_IMAGE,	/**< u32 string offset */
+	OP_REPORT_EXPORT_ARC_APP,	/**< u32 string offset */
+	OP_REPORT_EXPORT_ARC_NAME,	/**< u32 string offset */
+	OP_REPORT_EXPORT_ARC_VMA,	/**< u64 */
+	OP_REPORT_EXPORT_ARC_COUNTS,	/**< u64 per class */
+
+	OP_REPORT_EXPORT_NR_SECTIONS
+};
+
+enum op_report_export_arc_kind {
+	/** the other end of the arc calls the symbol */
+	OP_REPORT_EXPORT_ARC_CALLER,
+	/** the symbol calls the other end of the arc */
+	OP_REPORT_EXPORT_ARC_CALLEE
+};
+
+struct op_report_export_section_desc {
+	u64 offset;
+	u64 size;
+};
+
+struct op_report_export_header {
+	u8 magic[8];
+	u32 version;
+	u32 byte_order;
+	u32 nr_classes;
+	/** string offset of the cpu description */
+	u32 cpu_info;
+	u64 nr_symbols;
+	u64 nr_samples;
+	u64 nr_arcs;
+	struct op_report_export_section_desc
+		sections[OP_REPORT_EXPORT_NR_SECTIONS];
+};
+
+/**
+ * op_report_export_init_header - lay out an export
+ * @param header  the header to fill
+ * @param nr_classes  number of profile classes
+ * @param nr_symbols  number of symbols
+ * @param nr_samples  number of samples
+ * @param nr_arcs  number of call graph arcs
+ * @param strings_size  size of the string table
+ *
+ * Fill all the fields of header but cpu_info. Return the size of the
+ * file, the sections are written at the offsets set in header, or 0 if
+ * the export is too large to be mapped.
+ */
+u64 op_report_export_init_header(struct op_report_export_header * header,
+                                 u32 nr_classes, u64 nr_symbols,
+                                 u64 nr_samples, u64 nr_arcs,
+                                 u64 strings_size);
+
+/** a mapped export */
+struct op_report_export {
+	void * base;
+	size_t size;
+	struct op_report_export_header const * header;
+};
+
+/**
+ * op_report_export_open - map an export
+ * @param exp  the export to fill
+ * @param filename  the file to map
+ *
+ * The header and the layout of the sections are checked. Return 0 on
+ * success, -1 with errno set on failure, EINVAL if the file isn't a
+ * valid export.
+ */
+int op_report_export_open(struct op_report_export * exp, char const * filename);
+
+/**
+ * op_report_export_close - unmap an export
+ * @param exp  an export successfully opened
+ */
+void op_report_export_close(struct op_report_export * exp);
+
+/**
+ * op_report_export_column - get a section
+ * @param exp  the export
+ * @param section  the section
+ *
+ * Return the start of the section, to be cast to the type of its values.
+ */
+void const * op_report_export_column(struct op_report_export const * exp,
+                                     enum op_report_export_section section);
+
+/**
+ * op_report_export_string - get a string
+ * @param exp  the export
+ * @param offset  offset of the string in the string table
+ *
+ * Return NULL if offset is out of the string table.
+ */
+char const * op_report_export_string(struct op_report_export const * exp,
+                                     u32 offset);
+
+/**
+ * op_report_export_count - get a count
+ * @param exp  the export
+ * @param section  one of the count columns
+ * @param pclass  the profile class
+ * @param row  the row of the table of the column
+ */
+u64 op_report_export_count(struct op_report_export const * exp,
+                           enum op_report_export_section section,
+                           u32 pclass, u64 row);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* OP_REPORT_EXPORT_H */
@@ -0,0 +1,173 @@
+/**
+ * @file op_stats_page.c
+ * Live statistics page shared by the daemon with monitoring tools
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "op_stats_page.h"
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+/** nr. of tries before a reader gives up on a page being updated */
+#define MAX_READ_TRIES 1000
+
+
+struct op_stats_page * op_stats_page_create(char const * file)
+{
+	struct op_stats_page * page;
+	int err;
+	int fd;
+
+	fd = open(file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1)
+		return NULL;
+
+	if (ftruncate(fd, sizeof(struct op_stats_page))) {
+		err = errno;
+		close(fd);
+		errno = err;
+		return NULL;
+	}
+
+	page = mmap(0, sizeof(struct op_stats_page), PROT_READ | PROT_WRITE,
+	            MAP_SHARED, fd, 0);
+	err = errno;
+	close(fd);
+	if (page == MAP_FAILED) {
+		errno = err;
+		return NULL;
+	}
+
+	/* the file is zero filled, seq starts even */
+	page->version = OP_STATS_PAGE_VERSION;
+	page->pid = getpid();
+	page->start_time = page->update_time = time(NULL);
+	__sync_synchronize();
+	memcpy(page->magic, OP_STATS_PAGE_MAGIC, sizeof(page->magic));
+
+	return page;
+}
+
+
+void op_stats_page_close(struct op_stats_page * page)
+{
+	munmap(page, sizeof(struct op_stats_page));
+}
+
+
+void op_stats_page_begin(struct op_stats_page * page)
+{
+	++page->seq;
+	__sync_synchronize();
+}
+
+
+void op_stats_page_end(struct op_stats_page * page)
+{
+	__sync_synchronize();
+	++page->seq;
+}
+
+
+struct op_stats_counter *
+op_stats_page_counter(struct op_stats_page * page, char const * name)
+{
+	struct op_stats_counter * counter;
+
+	if (page->nr_counters == OP_STATS_MAX_COUNTERS)
+		return NULL;
+
+	counter = &page->counters[page->nr_counters];
+	strncpy(counter->name, name, OP_STATS_NAME_LEN - 1);
+	op_stats_page_begin(page);
+	++page->nr_counters;
+	op_stats_page_end(page);
+	return counter;
+}
+
+
+struct op_stats_histogram *
+op_stats_page_histogram(struct op_stats_page * page, char const * name)
+{
+	struct op_stats_histogram * hist;
+
+	if (page->nr_histograms == OP_STATS_MAX_HISTOGRAMS)
+		return NULL;
+
+	hist = &page->histograms[page->nr_histograms];
+	strncpy(hist->name, name, OP_STATS_NAME_LEN - 1);
+	op_stats_page_begin(page);
+	++page->nr_histograms;
+	op_stats_page_end(page);
+	return hist;
+}
+
+
+void op_stats_histogram_add(struct op_stats_histogram * hist, u64 value)
+{
+	size_t bucket = 0;
+
+	while (value >> bucket && bucket < OP_STATS_HIST_BUCKETS - 1)
+		++bucket;
+
+	++hist->buckets[bucket];
+	++hist->count;
+	hist->total += value;
+}
+
+
+int op_stats_page_read(char const * file, struct op_stats_page * page)
+{
+	struct op_stats_page const * shared;
+	struct stat st;
+	u32 seq;
+	int tries;
+	int fd;
+	int ret = -1;
+
+	fd = open(file, O_RDONLY);
+	if (fd == -1)
+		return -1;
+
+	if (fstat(fd, &st) || st.st_size < (off_t)sizeof(struct op_stats_page)) {
+		close(fd);
+		return -1;
+	}
+
+	shared = mmap(0, sizeof(struct op_stats_page), PROT_READ, MAP_SHARED,
+	              fd, 0);
+	close(fd);
+	if (shared == MAP_FAILED)
+		return -1;
+
+	for (tries = 0; tries < MAX_READ_TRIES; ++tries) {
+		seq = *(u32 volatile const *)&shared->seq;
+		if (seq & 1)
+			continue;
+		__sync_synchronize();
+		memcpy(page, shared, sizeof(struct op_stats_page));
+		__sync_synchronize();
+		if (*(u32 volatile const *)&shared->seq == seq) {
+			ret = 0;
+			break;
+		}
+	}
+
+	munmap((void *)shared, sizeof(struct op_stats_page));
+
+	if (ret == 0 &&
+	    (memcmp(page->magic, OP_STATS_PAGE_MAGIC, sizeof(page->magic)) ||
+	     page->version != OP_STATS_PAGE_VERSION))
+		ret = -1;
+
+	return ret;
+}
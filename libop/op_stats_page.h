@@ -0,0 +1,121 @@
+/**
+ * @file op_stats_page.h
+ * Live statistics page shared by the daemon with monitoring tools
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * The daemon maps the file op_stats_page_file and updates it in place.
+ * Readers map it read-only and copy it with op_stats_page_read(), which
+ * retries while the daemon is in the middle of an update: seq is odd
+ * during an update and changes for each update.
+ *
+ * Histogram bucket 0 counts the value 0, bucket i > 0 counts the values
+ * in [2^(i-1), 2^i), the last bucket also counts all larger values.
+ */
+
+#ifndef OP_STATS_PAGE_H
+#define OP_STATS_PAGE_H
+
+#include "op_types.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define OP_STATS_PAGE_MAGIC "OPST"
+#define OP_STATS_PAGE_VERSION 1
+
+#define OP_STATS_NAME_LEN 48
+#define OP_STATS_MAX_COUNTERS 48
+#define OP_STATS_MAX_HISTOGRAMS 24
+#define OP_STATS_HIST_BUCKETS 32
+
+struct op_stats_counter {
+	char name[OP_STATS_NAME_LEN];
+	u64 value;
+	/** per second, over the last update period */
+	u64 rate;
+};
+
+struct op_stats_histogram {
+	char name[OP_STATS_NAME_LEN];
+	/** nr. of values added, sum of them */
+	u64 count;
+	u64 total;
+	u64 buckets[OP_STATS_HIST_BUCKETS];
+};
+
+struct op_stats_page {
+	u8 magic[4];
+	u32 version;
+	u32 seq;
+	u32 pid;
+	/** seconds since the Epoch */
+	u64 start_time;
+	u64 update_time;
+	/** daemon buffer size, fill of the last read and maximum fill, in bytes */
+	u64 buffer_size;
+	u64 buffer_fill;
+	u64 buffer_fill_max;
+	u32 nr_counters;
+	u32 nr_histograms;
+	struct op_stats_counter counters[OP_STATS_MAX_COUNTERS];
+	struct op_stats_histogram histograms[OP_STATS_MAX_HISTOGRAMS];
+};
+
+/**
+ * op_stats_page_create - create and map the statistics page
+ * @param file  file to create, truncated if it exists
+ *
+ * Return the initialized page or NULL on failure, errno is then set.
+ */
+struct op_stats_page * op_stats_page_create(char const * file);
+
+/** unmap a page returned by op_stats_page_create() */
+void op_stats_page_close(struct op_stats_page * page);
+
+/** start an update, readers retry until op_stats_page_end() */
+void op_stats_page_begin(struct op_stats_page * page);
+
+/** end an update started with op_stats_page_begin() */
+void op_stats_page_end(struct op_stats_page * page);
+
+/**
+ * op_stats_page_counter - register a counter
+ * @param page  the page
+ * @param name  counter name
+ *
+ * Return the counter or NULL if the page is full.
+ */
+struct op_stats_counter *
+op_stats_page_counter(struct op_stats_page * page, char const * name);
+
+/**
+ * op_stats_page_histogram - register an histogram
+ * @param page  the page
+ * @param name  histogram name
+ *
+ * Return the histogram or NULL if the page is full.
+ */
+struct op_stats_histogram *
+op_stats_page_histogram(struct op_stats_page * page, char const * name);
+
+/** add value to the histogram */
+void op_stats_histogram_add(struct op_stats_histogram * hist, u64 value);
+
+/**
+ * op_stats_page_read - take a consistent snapshot of a statistics page
+ * @param file  the statistics page file
+ * @param page  where to store the snapshot
+ *
+ * Return 0 on success, -1 if the file can't be read, is not a statistics
+ * page or stays inconsistent.
+ */
+int op_stats_page_read(char const * file, struct op_stats_page * page);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* OP_STATS_PAGE_H */
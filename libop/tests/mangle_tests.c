@@ -45,6 +45,28 @@ static struct test_input const tests[] = {
 };
 
 
+static void check_slice(void)
+{
+	char const * expect =
+		"/session/samples//current/slice-3/{root}/bar/{dep}/{root}/foo/EVENT.0.0.all.all.all";
+	char * result;
+
+	init_op_config_dirs("/session");
+	if (init_op_config_slice(3)) {
+		fprintf(stderr, "init_op_config_slice() failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	result = op_mangle_filename(&tests[0].values);
+	if (strcmp(result, expect)) {
+		fprintf(stderr, "slice test:\nfound: %s\nexpect: %s\n",
+			result, expect);
+		exit(EXIT_FAILURE);
+	}
+	free(result);
+}
+
+
 int main(void)
 {
 	struct test_input const * test;
@@ -63,5 +85,7 @@ int main(void)
 		free(result);
 	}
 
+	check_slice();
+
 	return EXIT_SUCCESS;
 }
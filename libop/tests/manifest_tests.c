@@ -0,0 +1,151 @@
+/**
+ * @file manifest_tests.c
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "op_manifest.h"
+#include "op_config.h"
+#include "op_file.h"
+
+static char dir[] = "/tmp/manifest_tests.XXXXXX";
+
+struct read_result {
+	int count;
+	int found_root;
+	int found_slice;
+	int found_new;
+};
+
+
+static void make_file(char const * path, int sample_file, u32 event)
+{
+	char name[PATH_MAX];
+	struct opd_header header;
+	FILE * fp;
+
+	snprintf(name, sizeof(name), "%s/%s", dir, path);
+	memset(&header, 0, sizeof(header));
+	if (sample_file)
+		memcpy(header.magic, OPD_MAGIC, sizeof(header.magic));
+	header.ctr_event = event;
+
+	if (create_path(name)) {
+		perror(name);
+		exit(EXIT_FAILURE);
+	}
+
+	fp = fopen(name, "w");
+	if (!fp || fwrite(&header, sizeof(header), 1, fp) != 1) {
+		perror(name);
+		exit(EXIT_FAILURE);
+	}
+	fclose(fp);
+}
+
+
+static int check_record(char const * path, struct opd_header const * header,
+                        void * data)
+{
+	struct read_result * result = data;
+
+	++result->count;
+	if (!strcmp(path, "{root}/bin/ls/{dep}/{root}/bin/ls/CYCLES.100.0")) {
+		result->found_root = header->ctr_event == 1;
+	} else if (!strcmp(path, "slice-0/{kern}/vmlinux/CYCLES.100.0")) {
+		result->found_slice = header->ctr_event == 2;
+	} else if (!strcmp(path, "{root}/new")) {
+		result->found_new = header->ctr_event == 3;
+	} else {
+		fprintf(stderr, "unexpected manifest entry %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	return 0;
+}
+
+
+static void cleanup(void)
+{
+	if (remove_tree(dir))
+		fprintf(stderr, "couldn't remove %s\n", dir);
+}
+
+
+int main(void)
+{
+	struct read_result result;
+	struct opd_header header;
+	char name[PATH_MAX];
+	int ret;
+
+	if (!mkdtemp(dir)) {
+		perror(dir);
+		return EXIT_FAILURE;
+	}
+	atexit(cleanup);
+
+	make_file("{root}/bin/ls/{dep}/{root}/bin/ls/CYCLES.100.0", 1, 1);
+	make_file("slice-0/{kern}/vmlinux/CYCLES.100.0", 1, 2);
+	make_file("slice-0/start_time", 0, 0);
+
+	memset(&result, 0, sizeof(result));
+	if (op_manifest_read(dir, check_record, &result) != -1) {
+		fprintf(stderr, "read of a missing manifest succeeded\n");
+		return EXIT_FAILURE;
+	}
+
+	ret = op_manifest_rebuild(dir);
+	if (ret != 2) {
+		fprintf(stderr, "op_manifest_rebuild() returned %d\n", ret);
+		return EXIT_FAILURE;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, OPD_MAGIC, sizeof(header.magic));
+	header.ctr_event = 3;
+	if (op_manifest_append(dir, "{root}/new", &header)) {
+		perror("op_manifest_append()");
+		return EXIT_FAILURE;
+	}
+
+	memset(&result, 0, sizeof(result));
+	ret = op_manifest_read(dir, check_record, &result);
+	if (ret || result.count != 3 || !result.found_root ||
+	    !result.found_slice || !result.found_new) {
+		fprintf(stderr, "bad manifest content\n");
+		return EXIT_FAILURE;
+	}
+
+	/* a truncated record invalidates the manifest */
+	snprintf(name, sizeof(name), "%s/%s", dir, OP_MANIFEST_FILE);
+	if (truncate(name, sizeof(struct op_manifest_header) +
+	             sizeof(struct op_manifest_record) + 4)) {
+		perror(name);
+		return EXIT_FAILURE;
+	}
+	memset(&result, 0, sizeof(result));
+	if (op_manifest_read(dir, check_record, &result) != -1) {
+		fprintf(stderr, "truncated manifest accepted\n");
+		return EXIT_FAILURE;
+	}
+
+	/* a new manifest is empty */
+	if (op_manifest_create(dir)) {
+		perror("op_manifest_create()");
+		return EXIT_FAILURE;
+	}
+	memset(&result, 0, sizeof(result));
+	if (op_manifest_read(dir, check_record, &result) || result.count) {
+		fprintf(stderr, "bad empty manifest\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file report_export_tests.c
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "op_report_export.h"
+
+static char filename[] = "/tmp/report_export_tests.XXXXXX";
+
+/* two classes, two symbols, one sample and one arc */
+static char const strings[] = "\0/bin/ls\0main\0ls.c\0event\0";
+#define STR_LS 1
+#define STR_MAIN 9
+#define STR_FILE 14
+#define STR_EVENT 19
+
+
+static void put(char * file, struct op_report_export_header const * header,
+                enum op_report_export_section section,
+                void const * data)
+{
+	memcpy(file + header->sections[section].offset, data,
+	       header->sections[section].size);
+}
+
+
+static void write_export(int fd, int bad_size)
+{
+	struct op_report_export_header header;
+	u32 const class_name[2] = { STR_EVENT, STR_EVENT };
+	u32 const sym_str[2] = { STR_LS, STR_LS };
+	u32 const sym_name[2] = { STR_MAIN, 0 };
+	u32 const sym_file[2] = { STR_FILE, 0 };
+	u32 const sym_line[2] = { 12, 0 };
+	u64 const sym_vma[2] = { 0x1000, 0x2000 };
+	u64 const sym_size[2] = { 0x100, 0x10 };
+	/* class 0 then class 1 */
+	u64 const sym_counts[4] = { 10, 20, 30, 40 };
+	u32 const sample_symbol[1] = { 1 };
+	u64 const sample_vma[1] = { 0x2008 };
+	u64 const sample_counts[2] = { 20, 40 };
+	u32 const arc_kind[1] = { OP_REPORT_EXPORT_ARC_CALLEE };
+	u64 const arc_counts[2] = { 5, 6 };
+	u64 size;
+	char * file;
+
+	size = op_report_export_init_header(&header, 2, 2, 1, 1,
+	                                    sizeof(strings));
+	header.cpu_info = STR_EVENT;
+	if (bad_size)
+		header.sections[OP_REPORT_EXPORT_SYM_VMA].size -= 8;
+
+	file = calloc(1, size);
+	memcpy(file, &header, sizeof(header));
+	put(file, &header, OP_REPORT_EXPORT_STRINGS, strings);
+	put(file, &header, OP_REPORT_EXPORT_CLASS_NAME, class_name);
+	put(file, &header, OP_REPORT_EXPORT_CLASS_LONGNAME, class_name);
+	put(file, &header, OP_REPORT_EXPORT_SYM_IMAGE, sym_str);
+	put(file, &header, OP_REPORT_EXPORT_SYM_APP, sym_str);
+	put(file, &header, OP_REPORT_EXPORT_SYM_NAME, sym_name);
+	put(file, &header, OP_REPORT_EXPORT_SYM_FILE, sym_file);
+	put(file, &header, OP_REPORT_EXPORT_SYM_LINE, sym_line);
+	put(file, &header, OP_REPORT_EXPORT_SYM_VMA, sym_vma);
+	put(file, &header, OP_REPORT_EXPORT_SYM_SIZE, sym_size);
+	put(file, &header, OP_REPORT_EXPORT_SYM_COUNTS, sym_counts);
+	put(file, &header, OP_REPORT_EXPORT_SAMPLE_SYMBOL, sample_symbol);
+	put(file, &header, OP_REPORT_EXPORT_SAMPLE_VMA, sample_vma);
+	put(file, &header, OP_REPORT_EXPORT_SAMPLE_FILE, sym_file + 1);
+	put(file, &header, OP_REPORT_EXPORT_SAMPLE_LINE, sym_line + 1);
+	put(file, &header, OP_REPORT_EXPORT_SAMPLE_COUNTS, sample_counts);
+	put(file, &header, OP_REPORT_EXPORT_ARC_SYMBOL, sample_symbol);
+	put(file, &header, OP_REPORT_EXPORT_ARC_KIND, arc_kind);
+	put(file, &header, OP_REPORT_EXPORT_ARC_IMAGE, sym_str);
+	put(file, &header, OP_REPORT_EXPORT_ARC_APP, sym_str);
+	put(file, &header, OP_REPORT_EXPORT_ARC_NAME, sym_name);
+	put(file, &header, OP_REPORT_EXPORT_ARC_VMA, sym_vma);
+	put(file, &header, OP_REPORT_EXPORT_ARC_COUNTS, arc_counts);
+
+	if (ftruncate(fd, 0) || pwrite(fd, file, size, 0) != (ssize_t)size) {
+		perror(filename);
+		exit(EXIT_FAILURE);
+	}
+	free(file);
+}
+
+
+static u64 count(struct op_report_export const * exp,
+                 enum op_report_export_section section, u32 pclass, u64 row)
+{
+	return op_report_export_count(exp, section, pclass, row);
+}
+
+
+static void check(int ok, char const * what)
+{
+	if (!ok) {
+		fprintf(stderr, "report_export_tests: %s\n", what);
+		exit(EXIT_FAILURE);
+	}
+}
+
+
+int main(void)
+{
+	struct op_report_export exp;
+	struct op_report_export_header header;
+	u32 const * name;
+	u64 const * vma;
+	u32 const * sample_symbol;
+	int fd;
+	int i;
+
+	fd = mkstemp(filename);
+	if (fd == -1) {
+		perror(filename);
+		return EXIT_FAILURE;
+	}
+
+	write_export(fd, 0);
+	check(!op_report_export_open(&exp, filename),
+	      "op_report_export_open() failed");
+
+	check(exp.header->nr_classes == 2 && exp.header->nr_symbols == 2,
+	      "bad header");
+	check(!strcmp(op_report_export_string(&exp, exp.header->cpu_info),
+	              "event"), "bad cpu info");
+	check(!op_report_export_string(&exp, sizeof(strings)),
+	      "string out of the table");
+
+	name = op_report_export_column(&exp, OP_REPORT_EXPORT_SYM_NAME);
+	vma = op_report_export_column(&exp, OP_REPORT_EXPORT_SYM_VMA);
+	check(!strcmp(op_report_export_string(&exp, name[0]), "main") &&
+	      !strcmp(op_report_export_string(&exp, name[1]), "") &&
+	      vma[1] == 0x2000, "bad symbols");
+
+	check(count(&exp, OP_REPORT_EXPORT_SYM_COUNTS, 0, 1) == 20 &&
+	      count(&exp, OP_REPORT_EXPORT_SYM_COUNTS, 1, 0) == 30,
+	      "bad symbol counts");
+
+	sample_symbol = op_report_export_column(&exp,
+		OP_REPORT_EXPORT_SAMPLE_SYMBOL);
+	check(sample_symbol[0] == 1 &&
+	      count(&exp, OP_REPORT_EXPORT_SAMPLE_COUNTS, 1, 0) == 40,
+	      "bad samples");
+
+	check(count(&exp, OP_REPORT_EXPORT_ARC_COUNTS, 1, 0) == 6,
+	      "bad arcs");
+
+	op_report_export_close(&exp);
+
+	/* a column of the wrong size invalidates the export */
+	write_export(fd, 1);
+	check(op_report_export_open(&exp, filename) && errno == EINVAL,
+	      "bad column size accepted");
+
+	/* so does a truncated file */
+	write_export(fd, 0);
+	check(!ftruncate(fd, sizeof(struct op_report_export_header) + 8),
+	      "ftruncate() failed");
+	check(op_report_export_open(&exp, filename) && errno == EINVAL,
+	      "truncated export accepted");
+
+	/* a row count whose column sizes wrap around to the header ones */
+	write_export(fd, 0);
+	check(pread(fd, &header, sizeof(header), 0) == sizeof(header),
+	      "pread() failed");
+	header.nr_symbols = 1ULL << 62;
+	for (i = OP_REPORT_EXPORT_SYM_IMAGE; i <= OP_REPORT_EXPORT_SYM_COUNTS;
+	     ++i)
+		header.sections[i].size = 0;
+	check(pwrite(fd, &header, sizeof(header), 0) == sizeof(header),
+	      "pwrite() failed");
+	check(op_report_export_open(&exp, filename) && errno == EINVAL,
+	      "overflowing column size accepted");
+
+	/* nor can such an export be laid out */
+	check(!op_report_export_init_header(&header, 2, 1ULL << 62, 0, 0, 1),
+	      "overflowing export laid out");
+
+	close(fd);
+	unlink(filename);
+	return EXIT_SUCCESS;
+}
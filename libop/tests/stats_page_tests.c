@@ -0,0 +1,132 @@
+/**
+ * @file stats_page_tests.c
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "op_stats_page.h"
+
+struct hist_test {
+	u64 value;
+	size_t bucket;
+};
+
+static struct hist_test const hist_tests[] = {
+	{ 0, 0 },
+	{ 1, 1 },
+	{ 2, 2 },
+	{ 3, 2 },
+	{ 4, 3 },
+	{ 1023, 10 },
+	{ 1024, 11 },
+	{ ~0ULL, OP_STATS_HIST_BUCKETS - 1 },
+};
+
+#define NR_HIST_TESTS (sizeof(hist_tests) / sizeof(hist_tests[0]))
+
+
+static void check_histogram(void)
+{
+	struct op_stats_histogram hist;
+	size_t i;
+
+	for (i = 0; i < NR_HIST_TESTS; ++i) {
+		memset(&hist, 0, sizeof(hist));
+		op_stats_histogram_add(&hist, hist_tests[i].value);
+		if (hist.buckets[hist_tests[i].bucket] != 1 || hist.count != 1) {
+			fprintf(stderr, "value %llu not in bucket %lu\n",
+			        hist_tests[i].value,
+			        (unsigned long)hist_tests[i].bucket);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+
+static void check_page(char const * file)
+{
+	struct op_stats_page * page;
+	struct op_stats_page copy;
+	struct op_stats_counter * counter;
+	struct op_stats_histogram * hist;
+	size_t i;
+
+	page = op_stats_page_create(file);
+	if (!page) {
+		perror("op_stats_page_create");
+		exit(EXIT_FAILURE);
+	}
+
+	counter = op_stats_page_counter(page, "samples");
+	hist = op_stats_page_histogram(page, "latency");
+
+	op_stats_page_begin(page);
+	counter->value = 42;
+	counter->rate = 7;
+	op_stats_histogram_add(hist, 5);
+	page->buffer_fill = 100;
+	op_stats_page_end(page);
+
+	if (op_stats_page_read(file, &copy)) {
+		fprintf(stderr, "op_stats_page_read failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (copy.nr_counters != 1 || strcmp(copy.counters[0].name, "samples") ||
+	    copy.counters[0].value != 42 || copy.counters[0].rate != 7 ||
+	    copy.nr_histograms != 1 || copy.histograms[0].buckets[3] != 1 ||
+	    copy.buffer_fill != 100 || copy.pid != (u32)getpid() ||
+	    copy.seq & 1) {
+		fprintf(stderr, "bad page copy\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* a page stuck in the middle of an update can't be read */
+	op_stats_page_begin(page);
+	if (!op_stats_page_read(file, &copy)) {
+		fprintf(stderr, "inconsistent page read\n");
+		exit(EXIT_FAILURE);
+	}
+	op_stats_page_end(page);
+
+	for (i = 1; i < OP_STATS_MAX_COUNTERS; ++i)
+		op_stats_page_counter(page, "filler");
+	if (op_stats_page_counter(page, "overflow")) {
+		fprintf(stderr, "counter overflow not detected\n");
+		exit(EXIT_FAILURE);
+	}
+
+	op_stats_page_close(page);
+}
+
+
+int main(void)
+{
+	char file[] = "/tmp/stats_page_testsXXXXXX";
+	int fd;
+
+	check_histogram();
+
+	fd = mkstemp(file);
+	if (fd == -1) {
+		perror("mkstemp");
+		return EXIT_FAILURE;
+	}
+	close(fd);
+
+	check_page(file);
+
+	if (!op_stats_page_read("/dev/null", NULL)) {
+		fprintf(stderr, "/dev/null read as a stats page\n");
+		return EXIT_FAILURE;
+	}
+
+	unlink(file);
+	return 0;
+}
@@ -25,6 +25,7 @@
 #include "xml_utils.h"
 #include "parse_filename.h"
 #include "locate_images.h"
+#include "timings.h"
 
 using namespace std;
 
@@ -249,34 +250,36 @@ opd_header const get_first_header(profile_class const & pclass)
 		profile_dep_set const & dep = *(profile.deps.begin());
 		list<profile_sample_files> const & files = dep.files;
 		profile_sample_files const & sample_files = *(files.begin());
-		if (!sample_files.sample_filename.empty())
-			file = sample_files.sample_filename;
+		if (!sample_files.sample_filenames.empty())
+			file = sample_files.sample_filenames.front();
 		else
 			file = *sample_files.cg_files.begin();
 	} else {
 		profile_sample_files const & sample_files 
 			= *(profile.files.begin());
-		if (!sample_files.sample_filename.empty())
-			file = sample_files.sample_filename;
+		if (!sample_files.sample_filenames.empty())
+			file = sample_files.sample_filenames.front();
 		else
 			file = *sample_files.cg_files.begin();
 	}
 
-	return read_header(file);
+	return read_cached_header(file);
 }
 
 /// merge sample file header in the profile_sample_files
 void merge_header(profile_sample_files const & files, opd_header & header)
 {
-	if (!files.sample_filename.empty()) {
-		opd_header const temp = read_header(files.sample_filename);
+	list<string>::const_iterator it = files.sample_filenames.begin();
+	list<string>::const_iterator end = files.sample_filenames.end();
+	for ( ; it != end; ++it) {
+		opd_header const temp = read_cached_header(*it);
 		header.ctr_um |=  temp.ctr_um;
 	}
 
-	list<string>::const_iterator it = files.cg_files.begin();
-	list<string>::const_iterator const end = files.cg_files.end();
+	it = files.cg_files.begin();
+	end = files.cg_files.end();
 	for ( ; it != end; ++it) {
-		opd_header const temp = read_header(*it);
+		opd_header const temp = read_cached_header(*it);
 		header.ctr_um |= temp.ctr_um;
 	}
 }
@@ -501,22 +504,20 @@ profile_class & find_class(set<profile_class> & classes,
 }
 
 /**
- * Sanity check : we can't overwrite sample_filename, if we abort here it means
- * we fail to detect that parsed sample filename for two distinct samples
- * filename must go in two distinct profile_sample_files. This assumption is
- * false for callgraph samples files so this function is only called for non cg
- * files.
+ * Sanity check : a sample filename can only be added once, if we abort here
+ * it means the same sample file was listed twice. The sample files of
+ * distinct time slices parse the same and all go in the same
+ * profile_sample_files. Only called for non cg files.
  */
 void sanitize_profile_sample_files(profile_sample_files const & sample_files,
     parsed_filename const & parsed)
 {
-	// We can't allow to overwrite sample_filename.
-	if (!sample_files.sample_filename.empty()) {
+	if (find(sample_files.sample_filenames.begin(),
+	         sample_files.sample_filenames.end(), parsed.filename)
+	    != sample_files.sample_filenames.end()) {
 		ostringstream out;
 		out << "sanitize_profile_sample_files(): sample file "
-		    << "parsed twice ?\nsample_filename:\n"
-		    << sample_files.sample_filename << endl
-		    << parsed << endl;
+		    << "parsed twice ?\n" << parsed << endl;
 		throw op_fatal_error(out.str());
 	}
 }
@@ -530,10 +531,9 @@ add_to_profile_sample_files(profile_sample_files & sample_files,
     parsed_filename const & parsed)
 {
 	if (parsed.cg_image.empty()) {
-		// We can't allow to overwrite sample_filename.
 		sanitize_profile_sample_files(sample_files, parsed);
 
-		sample_files.sample_filename = parsed.filename;
+		sample_files.sample_filenames.push_back(parsed.filename);
 	} else {
 		sample_files.cg_files.push_back(parsed.filename);
 	}
@@ -552,9 +552,9 @@ find_profile_sample_files(list<profile_sample_files> & files,
 	list<profile_sample_files>::iterator it;
 	list<profile_sample_files>::iterator const end = files.end();
 	for (it = files.begin(); it != end; ++it) {
-		if (!it->sample_filename.empty()) {
+		if (!it->sample_filenames.empty()) {
 			parsed_filename psample_filename =
-			  parse_filename(it->sample_filename, extra);
+			  parse_filename(it->sample_filenames.front(), extra);
 			if (psample_filename.lib_image == parsed.lib_image &&
 			    psample_filename.image == parsed.image &&
 			    psample_filename.profile_spec_equal(parsed))
@@ -649,6 +649,8 @@ profile_classes const
 arrange_profiles(list<string> const & files, merge_option const & merge_by,
 		 extra_images const & extra)
 {
+	scoped_timer timer("arrange profiles");
+
 	set<profile_class> temp_classes;
 
 	list<string>::const_iterator it = files.begin();
@@ -695,7 +697,10 @@ arrange_profiles(list<string> const & files, merge_option const & merge_by,
 
 ostream & operator<<(ostream & out, profile_sample_files const & sample_files)
 {
-	out << "sample_filename: " << sample_files.sample_filename << endl;
+	out << "sample filenames:\n";
+	copy(sample_files.sample_filenames.begin(),
+	     sample_files.sample_filenames.end(),
+	     ostream_iterator<string>(out, "\n"));
 	out << "callgraph filenames:\n";
 	copy(sample_files.cg_files.begin(), sample_files.cg_files.end(),
 	     ostream_iterator<string>(out, "\n"));
@@ -826,6 +831,8 @@ verify_and_fill(app_map_t & app_map, list<inverted_profile> & plist,
 list<inverted_profile> const
 invert_profiles(profile_classes const & classes)
 {
+	scoped_timer timer("invert profiles");
+
 	app_map_t app_map;
 
 	size_t nr_classes = classes.v.size();
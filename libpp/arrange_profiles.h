@@ -47,16 +47,18 @@ struct profile_template {
 
 
 /**
- * A samples filename + its associated callgraph sample filename.
+ * The samples filenames + their associated callgraph sample filename.
  */
 struct profile_sample_files {
 	/**
-	 * This member can be empty since it is possible to get callgraph
-	 * w/o any samples to the binary. e.g an application which defer all
-	 * works to shared library but if arrange_profiles receive a sample
-	 * file list filtered from cg file sample_filename can't be empty
+	 * The sample files of each time slice, with the same image and
+	 * profile specification, their samples are summed. This member can
+	 * be empty since it is possible to get callgraph w/o any samples to
+	 * the binary. e.g an application which defer all works to shared
+	 * library but if arrange_profiles receive a sample file list
+	 * filtered from cg file sample_filenames can't be empty
 	 */
-	std::string sample_filename;
+	std::list<std::string> sample_filenames;
 	/**
 	 * List of callgraph sample filename. If the {dep} part of
 	 * cg_filename != {cg} part it's a cross binary samples file.
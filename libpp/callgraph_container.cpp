@@ -27,8 +27,10 @@
 #include "populate.h"
 #include "string_filter.h"
 #include "op_bfd.h"
+#include "op_bfd_cache.h"
 #include "op_sample_file.h"
 #include "locate_images.h"
+#include "timings.h"
 
 using namespace std;
 
@@ -400,32 +402,40 @@ void callgraph_container::populate(list<inverted_profile> const & iprofiles,
 	// non callgraph samples container, we record sample at symbol level
 	// not at vma level.
 	profile_container pc(debug_info, false, extra_found_images);
+	// the images are opened once for their samples and for every
+	// callgraph file they are the caller or the callee of
+	op_bfd_cache bfd_cache;
 
 	list<inverted_profile>::const_iterator it;
 	list<inverted_profile>::const_iterator const end = iprofiles.end();
 	for (it = iprofiles.begin(); it != end; ++it) {
 		// populate_caller_image take care about empty sample filename
-		populate_for_image(pc, *it, sym_filter, 0);
+		populate_for_image(pc, *it, sym_filter, 0, &bfd_cache);
 	}
 
 	add_symbols(pc);
 
 	total_count = pc.samples_count();
 
-	for (it = iprofiles.begin(); it != end; ++it) {
-		for (size_t i = 0; i < it->groups.size(); ++i) {
-			populate(it->groups[i], it->image,
-				i, pc, debug_info, merge_lib);
+	{
+		scoped_timer timer("populate call graph");
+		for (it = iprofiles.begin(); it != end; ++it) {
+			for (size_t i = 0; i < it->groups.size(); ++i) {
+				populate(it->groups[i], it->image, i, pc,
+				         debug_info, merge_lib, bfd_cache);
+			}
 		}
 	}
 
+	scoped_timer timer("process call graph");
 	recorder.process(total_count, threshold / 100.0, sym_filter);
 }
 
 
 void callgraph_container::populate(list<image_set> const & lset,
 	string const & app_image, size_t pclass,
-	profile_container const & pc, bool debug_info, bool merge_lib)
+	profile_container const & pc, bool debug_info, bool merge_lib,
+	op_bfd_cache & bfd_cache)
 {
 	list<image_set>::const_iterator lit;
 	list<image_set>::const_iterator const lend = lset.end();
@@ -434,8 +444,8 @@ void callgraph_container::populate(list<image_set> const & lset,
 		list<profile_sample_files>::const_iterator pend
 			= lit->files.end();
 		for (pit = lit->files.begin(); pit != pend; ++pit) {
-			populate(pit->cg_files, app_image,
-				 pclass, pc, debug_info, merge_lib);
+			populate(pit->cg_files, app_image, pclass, pc,
+				 debug_info, merge_lib, bfd_cache);
 		}
 	}
 }
@@ -443,47 +453,45 @@ void callgraph_container::populate(list<image_set> const & lset,
 
 void callgraph_container::populate(list<string> const & cg_files,
 	string const & app_image, size_t pclass,
-	profile_container const & pc, bool debug_info, bool merge_lib)
+	profile_container const & pc, bool debug_info, bool merge_lib,
+	op_bfd_cache & bfd_cache)
 {
 	list<string>::const_iterator it;
 	list<string>::const_iterator const end = cg_files.end();
 	for (it = cg_files.begin(); it != end; ++it) {
 		cverb << vdebug << "samples file : " << *it << endl;
 
-		parsed_filename caller_file =
+		parsed_filename const file =
 			parse_filename(*it, extra_found_images);
-		string const app_name = caller_file.image;
+		string const app_name = file.image;
 
 		image_error error;
-		extra_found_images.find_image_path(caller_file.lib_image,
+		extra_found_images.find_image_path(file.lib_image,
 				error, false);
 
 		if (error != image_ok)
-			report_image_error(caller_file.lib_image,
+			report_image_error(file.lib_image,
 					   error, false, extra_found_images);
 
 		bool caller_bfd_ok = true;
-		op_bfd caller_bfd(caller_file.lib_image,
-			string_filter(), extra_found_images, caller_bfd_ok);
+		cached_op_bfd caller(bfd_cache, file.lib_image,
+		                     extra_found_images, caller_bfd_ok);
 		if (!caller_bfd_ok)
-			report_image_error(caller_file.lib_image,
+			report_image_error(file.lib_image,
 			                   image_format_failure, false,
 					   extra_found_images);
 
-		parsed_filename callee_file =
-			parse_filename(*it, extra_found_images);
-
-		extra_found_images.find_image_path(callee_file.cg_image,
+		extra_found_images.find_image_path(file.cg_image,
 				error, false);
 		if (error != image_ok)
-			report_image_error(callee_file.cg_image,
+			report_image_error(file.cg_image,
 					   error, false, extra_found_images);
 
 		bool callee_bfd_ok = true;
-		op_bfd callee_bfd(callee_file.cg_image,
-			string_filter(), extra_found_images, callee_bfd_ok);
+		cached_op_bfd callee(bfd_cache, file.cg_image,
+		                     extra_found_images, callee_bfd_ok);
 		if (!callee_bfd_ok)
-			report_image_error(callee_file.cg_image,
+			report_image_error(file.cg_image,
 		                           image_format_failure, false,
 					   extra_found_images);
 
@@ -491,7 +499,7 @@ void callgraph_container::populate(list<string> const & cg_files,
 		// We can't use start_offset support in profile_t, give
 		// it a zero offset and we will fix that in add()
 		profile.add_sample_file(*it);
-		add(profile, caller_bfd, caller_bfd_ok, callee_bfd,
+		add(profile, caller.get(), caller_bfd_ok, callee.get(),
 		    merge_lib ? app_image : app_name, pc,
 		    debug_info, pclass);
 	}
@@ -26,6 +26,7 @@ class inverted_profile;
 class profile_t;
 class image_set;
 class op_bfd;
+class op_bfd_cache;
 
 
 /**
@@ -149,11 +150,13 @@ private:
 	void populate(std::list<image_set> const & lset,
 		      std::string const & app_image,
 		      size_t pclass, profile_container const & pc,
-		      bool debug_info, bool merge_lib);
+		      bool debug_info, bool merge_lib,
+		      op_bfd_cache & bfd_cache);
 	void populate(std::list<std::string> const & cg_files,
 		      std::string const & app_image,
 		      size_t pclass, profile_container const & pc,
-		      bool debug_info, bool merge_lib);
+		      bool debug_info, bool merge_lib,
+		      op_bfd_cache & bfd_cache);
 
 	/// record all main symbols
 	void add_symbols(profile_container const & pc);
@@ -15,7 +15,9 @@
 #endif
 
 #include "diff_container.h"
+#include "timings.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -40,6 +42,12 @@ bool rough_less(symbol_entry const & lhs, symbol_entry const & rhs)
 }
 
 
+bool rough_greater(symbol_entry const & lhs, symbol_entry const & rhs)
+{
+	return rough_less(rhs, lhs);
+}
+
+
 /// possibly add a diff sym
 void
 add_sym(diff_collection & syms, diff_symbol const & sym,
@@ -104,28 +112,39 @@ void symbol_diff(diff_collection & syms,
 }; // namespace anon
 
 
-diff_container::diff_container(profile_container const & c1,
-                               profile_container const & c2)
-	: pc1(c1), pc2(c2),
-	  total1(pc1.samples_count()), total2(pc2.samples_count())
+diff_container::diff_container(profile_container const & pc1)
+	: old_symbols(pc1.begin_symbol(), pc1.end_symbol()),
+	  total1(pc1.samples_count())
 {
+	// the symbol container order is already suitable (see less_symbol),
+	// sort only if it changes
+	if (adjacent_find(old_symbols.begin(), old_symbols.end(),
+	                  rough_greater) != old_symbols.end()) {
+		stable_sort(old_symbols.begin(), old_symbols.end(),
+		            rough_less);
+	}
 }
 
 
 diff_collection const
-diff_container::get_symbols(profile_container::symbol_choice & choice) const
+diff_container::get_symbols(profile_container const & pc2,
+                            profile_container::symbol_choice & choice)
 {
+	scoped_timer timer("diff symbols");
+
 	diff_collection syms;
 
+	total2 = pc2.samples_count();
+
 	/*
 	 * Do a pairwise comparison of the two symbol sets. We're
 	 * relying here on the symbol container being sorted such
 	 * that rough_less() is suitable for iterating through the
-	 * two lists (see less_symbol).
+	 * new symbols (see less_symbol).
 	 */
 
-	symbol_container::symbols_t::iterator it1 = pc1.begin_symbol();
-	symbol_container::symbols_t::iterator end1 = pc1.end_symbol();
+	vector<symbol_entry>::const_iterator it1 = old_symbols.begin();
+	vector<symbol_entry>::const_iterator const end1 = old_symbols.end();
 	symbol_container::symbols_t::iterator it2 = pc2.begin_symbol();
 	symbol_container::symbols_t::iterator end2 = pc2.end_symbol();
 
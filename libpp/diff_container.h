@@ -12,38 +12,44 @@
 #ifndef DIFF_CONTAINER_H
 #define DIFF_CONTAINER_H
 
+#include <vector>
+
 #include "profile_container.h"
 
 
 /**
- * Store two profiles for diffing.
+ * Diff two profiles. The symbols of the old profile are copied sorted by
+ * image, application and name so its profile_container can be freed
+ * before the new profile is populated, get_symbols() then merge-joins
+ * them with the symbols of the new profile in one pass.
  */
 class diff_container : noncopyable {
 public:
-	/// populate the collection of diffed symbols
-	diff_container(profile_container const & pc1,
-	               profile_container const & pc2);
+	/// record the symbols of the old profile
+	explicit diff_container(profile_container const & pc1);
 
 	~diff_container() {}
  
-	/// return a collection of diffed symbols
+	/**
+	 * return a collection of the symbols diffed against the new
+	 * profile, dropping the ones under the choice threshold before
+	 * they are stored
+	 */
 	diff_collection const
-		get_symbols(profile_container::symbol_choice & choice) const;
+		get_symbols(profile_container const & pc2,
+		            profile_container::symbol_choice & choice);
 
-	/// total count for 'new' profile
+	/// total count for 'new' profile, set by get_symbols()
 	count_array_t const samples_count() const;
 
 private:
-	/// first profile
-	profile_container const & pc1;
-
-	/// second profile
-	profile_container const & pc2;
+	/// the symbols of the old profile
+	std::vector<symbol_entry> old_symbols;
 
-	/// samples count for pc1
+	/// samples count for the old profile
 	count_array_t total1;
 
-	/// samples count for pc2
+	/// samples count for the new profile
 	count_array_t total2;
 };
 
@@ -19,6 +19,8 @@
 #include <iomanip>
 #include <iostream>
 #include <cmath>
+#include <utility>
+#include <vector>
 
 #include "string_manip.h"
 #include "string_filter.h"
@@ -37,40 +39,65 @@ using namespace std;
 namespace {
 
 
-string const get_linenr_info(file_location const floc, bool lf)
+/// the size of the output written at once
+size_t const buffer_size = 64 * 1024;
+
+
+void append_count(string & out, unsigned long long count)
 {
-	ostringstream out;
+	char buf[24];
+	char * p = buf + sizeof(buf);
+	do {
+		*--p = '0' + count % 10;
+		count /= 10;
+	} while (count);
+	out.append(p, buf + sizeof(buf));
+}
 
+
+void append_linenr_info(string & out, file_location const floc, bool lf)
+{
 	string const & filename = lf
 		? debug_names.name(floc.filename)
 		: debug_names.basename(floc.filename);
 
-	if (!filename.empty())
-		out << filename << ":" << floc.linenr;
-	else 
-		out << "(no location information)";
-
-	return out.str();
+	if (!filename.empty()) {
+		out += filename;
+		out += ':';
+		append_count(out, floc.linenr);
+	} else {
+		out += "(no location information)";
+	}
 }
 
-string get_vma(bfd_vma vma, bool vma_64)
-{
-	ostringstream out;
-	int width = vma_64 ? 16 : 8;
 
-	out << hex << setw(width) << setfill('0') << vma;
-
-	return out.str();
+void append_vma(string & out, bfd_vma vma, bool vma_64)
+{
+	static char const digits[] = "0123456789abcdef";
+	char buf[2 * sizeof(bfd_vma)];
+	char * p = buf + sizeof(buf);
+	do {
+		*--p = digits[vma & 0xf];
+		vma >>= 4;
+	} while (vma);
+
+	size_t const len = buf + sizeof(buf) - p;
+	size_t const width = vma_64 ? 16 : 8;
+	if (len < width)
+		out.append(width - len, '0');
+	out.append(p, len);
 }
 
-string get_percent(count_type dividend, count_type divisor)
+
+void append_percent(string & out, count_type dividend, count_type divisor)
 {
 	double ratio = op_ratio(dividend, divisor);
 
-	return ::format_percent(ratio * 100, percent_int_width,
-	                     percent_fract_width);
+	::append_percent(out, ratio * 100, percent_int_width,
+	                 percent_fract_width);
 }
 
+
 bool extract_linenr_info(string const & info, string & file, size_t & line)
 {
 	line = 0;
@@ -112,6 +139,8 @@ formatter::formatter(extra_images const & extra)
 	format_map[ff_percent_details] = field_description(9, "%", &formatter::format_percent_details);
 	format_map[ff_percent_cumulated_details] = field_description(10, "cum. %", &formatter::format_cumulated_percent_details);
 	format_map[ff_diff] = field_description(10, "diff %", &formatter::format_diff);
+
+	buffer.reserve(buffer_size);
 }
 
 
@@ -165,53 +194,65 @@ void formatter::output_header(ostream & out)
 
 	// first output the vma field
 	if (flags & ff_vma)
-		padding = output_header_field(out, ff_vma, padding);
+		padding = output_header_field(ff_vma, padding);
 
 	// the field repeated for each profile class
 	for (size_t pclass = 0 ; pclass < nr_classes; ++pclass) {
 		if (flags & ff_nr_samples)
-			padding = output_header_field(out,
-			      ff_nr_samples, padding);
+			padding = output_header_field(ff_nr_samples, padding);
 
 		if (flags & ff_nr_samples_cumulated)
-			padding = output_header_field(out, 
-			       ff_nr_samples_cumulated, padding);
+			padding = output_header_field(ff_nr_samples_cumulated,
+			                              padding);
 
 		if (flags & ff_percent)
-			padding = output_header_field(out,
-			       ff_percent, padding);
+			padding = output_header_field(ff_percent, padding);
 
 		if (flags & ff_percent_cumulated)
-			padding = output_header_field(out,
-			       ff_percent_cumulated, padding);
+			padding = output_header_field(ff_percent_cumulated,
+			                              padding);
 
 		if (flags & ff_diff)
-			padding = output_header_field(out,
-				ff_diff, padding);
+			padding = output_header_field(ff_diff, padding);
 
 		if (flags & ff_percent_details)
-			padding = output_header_field(out,
-			       ff_percent_details, padding);
+			padding = output_header_field(ff_percent_details,
+			                              padding);
 
 		if (flags & ff_percent_cumulated_details)
-			padding = output_header_field(out,
+			padding = output_header_field(
 			       ff_percent_cumulated_details, padding);
 	}
 
 	// now the remaining field
 	if (flags & ff_linenr_info)
-		padding = output_header_field(out, ff_linenr_info, padding);
+		padding = output_header_field(ff_linenr_info, padding);
 
 	if (flags & ff_image_name)
-		padding = output_header_field(out, ff_image_name, padding);
+		padding = output_header_field(ff_image_name, padding);
 
 	if (flags & ff_app_name)
-		padding = output_header_field(out, ff_app_name, padding);
+		padding = output_header_field(ff_app_name, padding);
 
 	if (flags & ff_symb_name)
-		padding = output_header_field(out, ff_symb_name, padding);
+		padding = output_header_field(ff_symb_name, padding);
+
+	buffer += '\n';
+	flush_if_full(out);
+}
+
 
-	out << "\n";
+void formatter::flush(ostream & out)
+{
+	out.write(buffer.data(), buffer.size());
+	buffer.clear();
+}
+
+
+void formatter::flush_if_full(ostream & out)
+{
+	if (buffer.size() >= buffer_size)
+		flush(out);
 }
 
 
@@ -221,22 +262,23 @@ void formatter::output_header(ostream & out)
 // lib[n?]curses to get the console width (look info source) (so on add a fixed
 // field flags)
 size_t formatter::
-output_field(ostream & out, field_datum const & datum,
+output_field(field_datum const & datum,
              format_flags fl, size_t padding, bool hide_immutable)
 {
+	field_description const & field(format_map[fl]);
+
 	if (!hide_immutable) {
-		out << string(padding, ' ');
+		buffer.append(padding, ' ');
 
-		field_description const & field(format_map[fl]);
-		string str = (this->*field.formatter)(datum);
-		out << str;
+		size_t const start = buffer.size();
+		(this->*field.formatter)(datum);
+		size_t const length = buffer.size() - start;
 
 		// at least one separator char
 		padding = 1;
-		if (str.length() < field.width)
-			padding = field.width - str.length();
+		if (length < field.width)
+			padding = field.width - length;
 	} else {
-		field_description const & field(format_map[fl]);
 		padding += field.width;
 	}
 
@@ -244,13 +286,12 @@ output_field(ostream & out, field_datum const & datum,
 }
 
  
-size_t formatter::
-output_header_field(ostream & out, format_flags fl, size_t padding)
+size_t formatter::output_header_field(format_flags fl, size_t padding)
 {
-	out << string(padding, ' ');
+	buffer.append(padding, ' ');
 
 	field_description const & field(format_map[fl]);
-	out << field.header_name;
+	buffer += field.header_name;
 
 	// at least one separator char
 	padding = 1;
@@ -261,21 +302,21 @@ output_header_field(ostream & out, format_flags fl, size_t padding)
 }
  
 
-string formatter::format_vma(field_datum const & f)
+void formatter::format_vma(field_datum const & f)
 {
-	return get_vma(f.sample.vma, vma_64);
+	append_vma(buffer, f.sample.vma, vma_64);
 }
 
  
-string formatter::format_symb_name(field_datum const & f)
+void formatter::format_symb_name(field_datum const & f)
 {
-	return symbol_names.demangle(f.symbol.name);
+	buffer += symbol_names.demangle(f.symbol.name);
 }
 
 
-string formatter::format_image_name(field_datum const & f)
+void formatter::format_image_name(field_datum const & f)
 {
-	return get_image_name(f.symbol.image_name, 
+	buffer += get_image_name(f.symbol.image_name, 
 		long_filenames 
 			? image_name_storage::int_real_filename
 			: image_name_storage::int_real_basename,
@@ -283,9 +324,9 @@ string formatter::format_image_name(field_datum const & f)
 }
 
  
-string formatter::format_app_name(field_datum const & f)
+void formatter::format_app_name(field_datum const & f)
 {
-	return get_image_name(f.symbol.app_name,
+	buffer += get_image_name(f.symbol.app_name,
 		long_filenames 
 			? image_name_storage::int_real_filename
 			: image_name_storage::int_real_basename,
@@ -293,75 +334,81 @@ string formatter::format_app_name(field_datum const & f)
 }
 
  
-string formatter::format_linenr_info(field_datum const & f)
+void formatter::format_linenr_info(field_datum const & f)
 {
-	return get_linenr_info(f.sample.file_loc, long_filenames);
+	append_linenr_info(buffer, f.sample.file_loc, long_filenames);
 }
 
  
-string formatter::format_nr_samples(field_datum const & f)
+void formatter::format_nr_samples(field_datum const & f)
 {
-	ostringstream out;
-	out << f.sample.counts[f.pclass];
-	return out.str();
+	append_count(buffer, f.sample.counts[f.pclass]);
 }
 
  
-string formatter::format_nr_cumulated_samples(field_datum const & f)
+void formatter::format_nr_cumulated_samples(field_datum const & f)
 {
-	if (f.diff == -INFINITY)
-		return "---";
-	ostringstream out;
+	if (f.diff == -INFINITY) {
+		buffer += "---";
+		return;
+	}
 	f.counts.cumulated_samples[f.pclass] += f.sample.counts[f.pclass];
-	out << f.counts.cumulated_samples[f.pclass];
-	return out.str();
+	append_count(buffer, f.counts.cumulated_samples[f.pclass]);
 }
 
  
-string formatter::format_percent(field_datum const & f)
+void formatter::format_percent(field_datum const & f)
 {
-	if (f.diff == -INFINITY)
-		return "---";
-	return get_percent(f.sample.counts[f.pclass], f.counts.total[f.pclass]);
+	if (f.diff == -INFINITY) {
+		buffer += "---";
+		return;
+	}
+	append_percent(buffer, f.sample.counts[f.pclass],
+	               f.counts.total[f.pclass]);
 }
 
  
-string formatter::format_cumulated_percent(field_datum const & f)
+void formatter::format_cumulated_percent(field_datum const & f)
 {
-	if (f.diff == -INFINITY)
-		return "---";
+	if (f.diff == -INFINITY) {
+		buffer += "---";
+		return;
+	}
 	f.counts.cumulated_percent[f.pclass] += f.sample.counts[f.pclass];
 
-	return get_percent(f.counts.cumulated_percent[f.pclass],
-	                   f.counts.total[f.pclass]);
+	append_percent(buffer, f.counts.cumulated_percent[f.pclass],
+	               f.counts.total[f.pclass]);
 }
 
  
-string formatter::format_percent_details(field_datum const & f)
+void formatter::format_percent_details(field_datum const & f)
 {
-	return get_percent(f.sample.counts[f.pclass],
-		f.counts.total[f.pclass]);
+	append_percent(buffer, f.sample.counts[f.pclass],
+	               f.counts.total[f.pclass]);
 }
 
  
-string formatter::format_cumulated_percent_details(field_datum const & f)
+void formatter::format_cumulated_percent_details(field_datum const & f)
 {
 	f.counts.cumulated_percent_details[f.pclass] += f.sample.counts[f.pclass];
 
-	return get_percent(f.counts.cumulated_percent_details[f.pclass],
-	                   f.counts.total[f.pclass]);
+	append_percent(buffer, f.counts.cumulated_percent_details[f.pclass],
+	               f.counts.total[f.pclass]);
 }
 
 
-string formatter::format_diff(field_datum const & f)
+void formatter::format_diff(field_datum const & f)
 {
-	if (f.diff == INFINITY)
-		return "+++";
-	else if (f.diff == -INFINITY)
-		return "---";
+	if (f.diff == INFINITY) {
+		buffer += "+++";
+		return;
+	} else if (f.diff == -INFINITY) {
+		buffer += "---";
+		return;
+	}
 
-	return ::format_percent(f.diff, percent_int_width,
-                                percent_fract_width, true);
+	::append_percent(buffer, f.diff, percent_int_width,
+	                 percent_fract_width, true);
 }
 
 
@@ -374,7 +421,7 @@ do_output(ostream & out, symbol_entry const & symb, sample_entry const & sample,
 	// first output the vma field
 	field_datum datum(symb, sample, 0, c, extra_found_images);
 	if (flags & ff_vma)
-		padding = output_field(out, datum, ff_vma, padding, false);
+		padding = output_field(datum, ff_vma, padding, false);
 
 	// repeated fields for each profile class
 	for (size_t pclass = 0 ; pclass < nr_classes; ++pclass) {
@@ -382,52 +429,53 @@ do_output(ostream & out, symbol_entry const & symb, sample_entry const & sample,
 				  extra_found_images, diffs[pclass]);
 
 		if (flags & ff_nr_samples)
-			padding = output_field(out, datum,
+			padding = output_field(datum,
 			       ff_nr_samples, padding, false);
 
 		if (flags & ff_nr_samples_cumulated)
-			padding = output_field(out, datum, 
+			padding = output_field(datum, 
 			       ff_nr_samples_cumulated, padding, false);
 
 		if (flags & ff_percent)
-			padding = output_field(out, datum,
+			padding = output_field(datum,
 			       ff_percent, padding, false);
 
 		if (flags & ff_percent_cumulated)
-			padding = output_field(out, datum,
+			padding = output_field(datum,
 			       ff_percent_cumulated, padding, false);
 
 		if (flags & ff_diff)
-			padding = output_field(out, datum,
+			padding = output_field(datum,
 				ff_diff, padding, false);
 
 		if (flags & ff_percent_details)
-			padding = output_field(out, datum,
+			padding = output_field(datum,
 			       ff_percent_details, padding, false);
 
 		if (flags & ff_percent_cumulated_details)
-			padding = output_field(out, datum,
+			padding = output_field(datum,
 			       ff_percent_cumulated_details, padding, false);
 	}
 
 	// now the remaining field
 	if (flags & ff_linenr_info)
-		padding = output_field(out, datum, ff_linenr_info,
+		padding = output_field(datum, ff_linenr_info,
 		       padding, false);
 
 	if (flags & ff_image_name)
-		padding = output_field(out, datum, ff_image_name,
+		padding = output_field(datum, ff_image_name,
 		       padding, hide_immutable);
 
 	if (flags & ff_app_name)
-		padding = output_field(out, datum, ff_app_name,
+		padding = output_field(datum, ff_app_name,
 		       padding, hide_immutable);
 
 	if (flags & ff_symb_name)
-		padding = output_field(out, datum, ff_symb_name,
+		padding = output_field(datum, ff_symb_name,
 		       padding, hide_immutable);
 
-	out << "\n";
+	buffer += '\n';
+	flush_if_full(out);
 }
 
 
@@ -465,6 +513,8 @@ output(ostream & out, symbol_collection const & syms)
 	symbol_collection::const_iterator end = syms.end();
 	for (; it != end; ++it)
 		output(out, *it);
+
+	flush(out);
 }
 
 
@@ -483,7 +533,7 @@ output_details(ostream & out, symbol_entry const * symb)
 	sample_container::samples_iterator it = profile.begin(symb);
 	sample_container::samples_iterator end = profile.end(symb);
 	for (; it != end; ++it) {
-		out << "  ";
+		buffer += "  ";
 		do_output(out, *symb, it->second, c, diff_array_t(), true);
 	}
 }
@@ -504,7 +554,8 @@ void cg_formatter::output(ostream & out, symbol_collection const & syms)
 
 	output_header(out);
 
-	out << string(79, '-') << endl;
+	buffer.append(79, '-');
+	buffer += '\n';
 
 	symbol_collection::const_iterator it;
 	symbol_collection::const_iterator end = syms.end();
@@ -522,7 +573,7 @@ void cg_formatter::output(ostream & out, symbol_collection const & syms)
 			c.total = sym->total_caller_count;
 
 		for (cit = sym->callers.begin(); cit != cend; ++cit) {
-			out << child_parent_prefix;
+			buffer += child_parent_prefix;
 			do_output(out, *cit, cit->sample, c);
 		}
 
@@ -537,12 +588,15 @@ void cg_formatter::output(ostream & out, symbol_collection const & syms)
 		cend = sym->callees.end();
 
 		for (cit = sym->callees.begin(); cit != cend; ++cit) {
-			out << child_parent_prefix;
+			buffer += child_parent_prefix;
 			do_output(out, *cit, cit->sample, c);
 		}
 
-		out << string(79, '-') << endl;
+		buffer.append(79, '-');
+		buffer += '\n';
 	}
+
+	flush(out);
 }
 
 
@@ -563,11 +617,15 @@ void diff_formatter::output(ostream & out, diff_collection const & syms)
 	diff_collection::const_iterator end = syms.end();
 	for (; it != end; ++it)
 		do_output(out, *it, it->sample, counts, it->diffs);
+
+	flush(out);
 }
 
 // local variables used in generation of XML
-// buffer details for output later
-ostringstream bytes_out;
+// symbols whose contents go in the bytes table and their table id, the
+// contents are read back from the binaries when the table is output
+typedef vector<pair<symbol_entry const *, size_t> > symbol_bytes_t;
+symbol_bytes_t symbol_bytes;
 
 // module+symbol table for detecting duplicate symbols
 map<string, size_t> symbol_data_table;
@@ -588,13 +646,23 @@ size_t xml_get_symbol_index(string const & name)
 }
 
 
+/// a symbol and the range of profile classes of its details
+struct detail_range {
+	detail_range(symbol_entry const * s, size_t l, size_t h)
+		: symb(s), lo(l), hi(h) {}
+	symbol_entry const * symb;
+	size_t lo;
+	size_t hi;
+};
+
 class symbol_details_t {
 public:
 	symbol_details_t() { size = index = 0; id = -1; }
 	int id;
 	size_t size;
 	size_t index;
-	string details;
+	/// the details are output from these after the symbol table
+	vector<detail_range> ranges;
 };
 
 typedef growable_vector<symbol_details_t> symbol_details_array_t;
@@ -631,27 +699,56 @@ void xml_formatter::output(ostream & out)
 	xml_support->output_program_structure(out);
 	output_symbol_data(out);
 	if (need_details) {
-		out << open_element(DETAIL_TABLE);
-		for (size_t i = 0; i < symbol_details.size(); ++i) {
-			int id = symbol_details[i].id;
-
-			if (id >= 0) {
-				out << open_element(SYMBOL_DETAILS, true);
-				out << init_attr(TABLE_ID, (size_t)id);
-				out << close_element(NONE, true);
-				out << symbol_details[i].details;
-				out << close_element(SYMBOL_DETAILS);
-			}
+		output_detail_table(out);
+		output_bytes_table(out);
+	}
+
+	out << close_element(PROFILE);
+}
+
+
+void xml_formatter::output_detail_table(ostream & out)
+{
+	out << open_element(DETAIL_TABLE);
+	for (size_t i = 0; i < symbol_details.size(); ++i) {
+		symbol_details_t const & sd = symbol_details[i];
+
+		if (sd.id < 0)
+			continue;
+
+		out << open_element(SYMBOL_DETAILS, true);
+		out << init_attr(TABLE_ID, (size_t)sd.id);
+		out << close_element(NONE, true);
+
+		// same numbering as the detaillo/detailhi of the symbols
+		size_t detail_index = 0;
+		for (size_t j = 0; j < sd.ranges.size(); ++j) {
+			detail_range const & r = sd.ranges[j];
+			output_symbol_details(out, r.symb, detail_index,
+			                      r.lo, r.hi);
 		}
-		out << close_element(DETAIL_TABLE);
 
-		// output bytesTable
-		out << open_element(BYTES_TABLE);
-		out << bytes_out.str();
-		out << close_element(BYTES_TABLE);
+		out << close_element(SYMBOL_DETAILS);
 	}
+	out << close_element(DETAIL_TABLE);
+}
 
-	out << close_element(PROFILE);
+
+void xml_formatter::output_bytes_table(ostream & out)
+{
+	op_bfd * abfd = NULL;
+
+	out << open_element(BYTES_TABLE);
+	for (size_t i = 0; i < symbol_bytes.size(); ++i) {
+		symbol_entry const * symb = symbol_bytes[i].first;
+		if (get_bfd_object(symb, abfd)) {
+			xml_support->output_symbol_bytes(out, symb,
+				symbol_bytes[i].second, *abfd);
+		}
+	}
+	out << close_element(BYTES_TABLE);
+
+	delete abfd;
 }
 
 bool
@@ -724,7 +821,7 @@ output_the_symbol_data(ostream & out, symbol_entry const * symb, op_bfd * & abfd
 			if (need_details) {
 				get_bfd_object(symb, abfd);
 				if (abfd && abfd->symbol_has_contents(symb->sym_index))
-					xml_support->output_symbol_bytes(bytes_out, symb, sd_it->second, *abfd);
+					symbol_bytes.push_back(make_pair(symb, sd_it->second));
 			}
 		}
 		out << close_element();
@@ -776,17 +873,36 @@ void xml_formatter::output_symbol_data(ostream & out)
 	delete abfd;
 }
 
-string  xml_formatter::
-output_symbol_details(symbol_entry const * symb,
+size_t xml_formatter::
+count_symbol_details(symbol_entry const * symb, size_t lo, size_t hi) const
+{
+	if (!has_sample_counts(symb->sample.counts, lo, hi))
+		return 0;
+
+	size_t count = 0;
+	sample_container::samples_iterator it = profile->begin(symb);
+	sample_container::samples_iterator end = profile->end(symb);
+	for (; it != end; ++it) {
+		for (size_t p = lo; p <= hi; ++p) {
+			if (it->second.counts[p] != 0)
+				++count;
+		}
+	}
+
+	return count;
+}
+
+
+void xml_formatter::
+output_symbol_details(ostream & str, symbol_entry const * symb,
     size_t & detail_index, size_t const lo, size_t const hi)
 {
 	if (!has_sample_counts(symb->sample.counts, lo, hi))
-		return "";
+		return;
 
 	sample_container::samples_iterator it = profile->begin(symb);
 	sample_container::samples_iterator end = profile->end(symb);
 
-	ostringstream str;
 	for (; it != end; ++it) {
 		counts_t c;
 
@@ -807,8 +923,10 @@ output_symbol_details(symbol_entry const * symb,
 				size_t sym_line;
 				string samp_file;
 				size_t samp_line;
-				string sym_info = get_linenr_info(symb->sample.file_loc, true);
-				string samp_info = get_linenr_info(it->second.file_loc, true);
+				string sym_info;
+				string samp_info;
+				append_linenr_info(sym_info, symb->sample.file_loc, true);
+				append_linenr_info(samp_info, it->second.file_loc, true);
 
 				if (extract_linenr_info(samp_info, samp_file, samp_line)) {
 					if (extract_linenr_info(sym_info, sym_file, sym_line)) {
@@ -829,26 +947,17 @@ output_symbol_details(symbol_entry const * symb,
 			str << close_element(DETAIL_DATA);
 		}
 	}
-	return str.str();
 }
 
 void xml_formatter::
 output_symbol(ostream & out,
 	symbol_entry const * symb, size_t lo, size_t hi, bool is_module)
 {
-	ostringstream str;
 	// pointless reference to is_module, remove insane compiler warning
 	size_t indx = is_module ? 0 : 1;
 
-	// output symbol's summary data for each profile class
-	bool got_samples = false;
-
-	for (size_t p = lo; p <= hi; ++p) {
-		got_samples |= xml_support->output_summary_data(str,
-		    symb->sample.counts, p);
-	}
-
-	if (!got_samples)
+	// the summary data is output for the profile classes with samples
+	if (!has_sample_counts(symb->sample.counts, lo, hi))
 		return;
 
 	if (cverb << vxml)
@@ -869,27 +978,23 @@ output_symbol(ostream & out,
 	out << init_attr(ID_REF, indx);
 
 	if (need_details) {
-		ostringstream details;
 		symbol_details_t & sd = symbol_details[indx];
-		size_t const detail_lo = sd.index;
-
-		string detail_str = output_symbol_details(symb, sd.index, lo, hi);
+		size_t const nr_details = count_symbol_details(symb, lo, hi);
 
-		if (detail_str.size() > 0) {
+		// the details are output with the detail table
+		if (nr_details) {
 			if (sd.id < 0)
 				sd.id = indx;
-			details << detail_str;
-		}
-
-		if (sd.index > detail_lo) {
-			sd.details = sd.details + details.str();
-			out << init_attr(DETAIL_LO, detail_lo);
+			sd.ranges.push_back(detail_range(symb, lo, hi));
+			out << init_attr(DETAIL_LO, sd.index);
+			sd.index += nr_details;
 			out << init_attr(DETAIL_HI, sd.index-1);
 		}
 	}
 	out << close_element(NONE, true);
 	// output summary
-	out << str.str();
+	for (size_t p = lo; p <= hi; ++p)
+		xml_support->output_summary_data(out, symb->sample.counts, p);
 	out << close_element(SYMBOL);
 }
 
@@ -911,7 +1016,11 @@ output_attribute(ostream & out, field_datum const & datum,
 {
 	field_description const & field(format_map[fl]);
 
-	string str = (this->*field.formatter)(datum);
+	// the XML output doesn't go through the buffer, take the field back
+	size_t const start = buffer.size();
+	(this->*field.formatter)(datum);
+	string const str(buffer, start);
+	buffer.erase(start);
 
 	if (!str.empty()) {
 		if (fl == ff_linenr_info && (tag == SOURCE_LINE || tag == SOURCE_FILE)) {
@@ -68,6 +68,9 @@ public:
 	/// output_header_field()
 	void output_header(std::ostream & out);
 
+	/// write the buffered output to out
+	void flush(std::ostream & out);
+
 protected:
 	struct counts_t {
 		/// total sample count
@@ -96,25 +99,25 @@ protected:
 		double diff;
 	};
  
-	/// format callback type
-	typedef std::string (formatter::*fct_format)(field_datum const &);
+	/// format callback type, the field is appended to buffer
+	typedef void (formatter::*fct_format)(field_datum const &);
  
 	/** @name format functions.
 	 * The set of formatting functions, used internally by output().
 	 */
 	//@{
-	std::string format_vma(field_datum const &);
-	std::string format_symb_name(field_datum const &);
-	std::string format_image_name(field_datum const &);
-	std::string format_app_name(field_datum const &);
-	std::string format_linenr_info(field_datum const &);
-	std::string format_nr_samples(field_datum const &);
-	std::string format_nr_cumulated_samples(field_datum const &);
-	std::string format_percent(field_datum const &);
-	std::string format_cumulated_percent(field_datum const &);
-	std::string format_percent_details(field_datum const &);
-	std::string format_cumulated_percent_details(field_datum const &);
-	std::string format_diff(field_datum const &);
+	void format_vma(field_datum const &);
+	void format_symb_name(field_datum const &);
+	void format_image_name(field_datum const &);
+	void format_app_name(field_datum const &);
+	void format_linenr_info(field_datum const &);
+	void format_nr_samples(field_datum const &);
+	void format_nr_cumulated_samples(field_datum const &);
+	void format_percent(field_datum const &);
+	void format_cumulated_percent(field_datum const &);
+	void format_percent_details(field_datum const &);
+	void format_cumulated_percent_details(field_datum const &);
+	void format_diff(field_datum const &);
 	//@}
  
 	/// decribe one field of the colummned output.
@@ -138,17 +141,26 @@ protected:
 	              bool hide_immutable_field = false);
  
 	/// returns the nr of char needed to pad this field
-	size_t output_header_field(std::ostream & out, format_flags fl,
-	                           size_t padding);
+	size_t output_header_field(format_flags fl, size_t padding);
 
 	/// returns the nr of char needed to pad this field
-	size_t output_field(std::ostream & out, field_datum const & datum,
+	size_t output_field(field_datum const & datum,
 			   format_flags fl, size_t padding,
 			   bool hide_immutable);
+
+	/// write the buffered output to out if the buffer is large enough
+	void flush_if_full(std::ostream & out);
  
 	/// stores functors for doing actual formatting
 	format_map_t format_map;
 
+	/**
+	 * The output not yet written. All the fields are formatted in it
+	 * and it's written in large chunks, it keeps its capacity so
+	 * formatting doesn't allocate once it has grown.
+	 */
+	std::string buffer;
+
 	/// number of profile classes
 	size_t nr_classes;
 
@@ -252,8 +264,9 @@ public:
 		bool is_module);
 
 	/// output details for the symbol
-	std::string output_symbol_details(symbol_entry const * symb,
-		size_t & detail_index, size_t const lo, size_t const hi);
+	void output_symbol_details(std::ostream & out,
+		symbol_entry const * symb, size_t & detail_index,
+		size_t const lo, size_t const hi);
 
 	/// set the output_details boolean
 	void show_details(bool);
@@ -281,6 +294,16 @@ private:
 	void output_sample_data(std::ostream & out,
 		sample_entry const & sample, size_t count);
 
+	/// nr. of details output_symbol_details() outputs for symb
+	size_t count_symbol_details(symbol_entry const * symb,
+		size_t lo, size_t hi) const;
+
+	/// output the details of the symbols output so far
+	void output_detail_table(std::ostream & out);
+
+	/// output the contents of the symbols of the symbol table
+	void output_bytes_table(std::ostream & out);
+
 	/// output attribute in XML
 	void output_attribute(std::ostream & out, field_datum const & datum,
 			      format_flags fl, tag_t tag);
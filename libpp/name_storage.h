@@ -15,6 +15,7 @@
 #include <string>
 
 #include "unique_storage.h"
+#include "string_manip.h"
 
 class extra_images;
 
@@ -27,7 +28,16 @@ struct stored_name {
 		return name < rhs.name;
 	}
 
+	bool operator==(stored_name const & rhs) const {
+		return name == rhs.name;
+	}
+
+	std::size_t hash() const {
+		return hash_string(name);
+	}
+
 	std::string name;
+	/// demangled or base name, computed on first use
 	mutable std::string name_processed;
 };
 
@@ -62,6 +72,14 @@ struct stored_filename {
 		return filename < rhs.filename;
 	}
 
+	bool operator==(stored_filename const & rhs) const {
+		return filename == rhs.filename;
+	}
+
+	std::size_t hash() const {
+		return hash_string(filename);
+	}
+
 	std::string filename;
 	mutable std::string base_filename;
 	mutable std::string real_filename;
@@ -0,0 +1,112 @@
+/**
+ * @file op_bfd_cache.cpp
+ * Shared, reference counted op_bfd instances
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "op_bfd_cache.h"
+#include "op_bfd.h"
+#include "locate_images.h"
+#include "string_filter.h"
+#include "timings.h"
+
+using namespace std;
+
+namespace {
+
+/// scoped lock of a pthread mutex
+class mutex_lock : noncopyable {
+public:
+	explicit mutex_lock(pthread_mutex_t & m) : mutex(m) {
+		pthread_mutex_lock(&mutex);
+	}
+	~mutex_lock() { pthread_mutex_unlock(&mutex); }
+private:
+	pthread_mutex_t & mutex;
+};
+
+}  // anonymous namespace
+
+
+op_bfd_cache::op_bfd_cache(size_t max)
+	: unused_symbols(0), max_symbols(max)
+{
+	pthread_mutex_init(&mutex, 0);
+}
+
+
+op_bfd_cache::~op_bfd_cache()
+{
+	entries_t::iterator it;
+	for (it = entries.begin(); it != entries.end(); ++it)
+		delete it->second.abfd;
+	pthread_mutex_destroy(&mutex);
+}
+
+
+op_bfd_cache::entries_t::iterator
+op_bfd_cache::acquire(string const & image, extra_images const & extra)
+{
+	mutex_lock lock(mutex);
+
+	key_t const key(image, extra.get_uid());
+	entries_t::iterator it = entries.find(key);
+	if (it != entries.end()) {
+		entry & e = it->second;
+		if (e.refcount++ == 0) {
+			unused.erase(e.unused_pos);
+			unused_symbols -= e.abfd->syms.size();
+		}
+		timings::count("op_bfd cache hits");
+		return it;
+	}
+
+	// the op_bfd is built with the lock held, bfd isn't thread safe
+	entry e;
+	e.ok = true;
+	e.abfd = new op_bfd(image, string_filter(), extra, e.ok);
+	e.refcount = 1;
+	return entries.insert(make_pair(key, e)).first;
+}
+
+
+void op_bfd_cache::release(entries_t::iterator it)
+{
+	mutex_lock lock(mutex);
+
+	entry & e = it->second;
+	if (--e.refcount)
+		return;
+
+	e.unused_pos = unused.insert(unused.end(), it->first);
+	unused_symbols += e.abfd->syms.size();
+	trim();
+}
+
+
+void op_bfd_cache::trim()
+{
+	while (unused_symbols > max_symbols) {
+		entries_t::iterator it = entries.find(unused.front());
+		unused.pop_front();
+		unused_symbols -= it->second.abfd->syms.size();
+		delete it->second.abfd;
+		entries.erase(it);
+	}
+}
+
+
+cached_op_bfd::cached_op_bfd(op_bfd_cache & c, string const & image,
+                             extra_images const & extra, bool & ok)
+	: cache(c), it(cache.acquire(image, extra))
+{
+	ok = it->second.ok;
+}
+
+
+cached_op_bfd::~cached_op_bfd()
+{
+	cache.release(it);
+}
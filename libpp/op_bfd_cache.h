@@ -0,0 +1,92 @@
+/**
+ * @file op_bfd_cache.h
+ * Shared, reference counted op_bfd instances
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * Populating a callgraph opens the caller and the callee image of every
+ * callgraph file, the same few images are opened again and again. The
+ * cache keeps one op_bfd per image, built with an empty symbol filter,
+ * for as long as it's used and keeps unused ones around until the
+ * symbols they hold exceed a bound.
+ */
+
+#ifndef OP_BFD_CACHE_H
+#define OP_BFD_CACHE_H
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "utility.h"
+
+class op_bfd;
+class extra_images;
+
+class op_bfd_cache : noncopyable {
+public:
+	/**
+	 * Unused op_bfd are freed, least recently used first, when they
+	 * hold more than max_symbols symbols.
+	 */
+	explicit op_bfd_cache(size_t max_symbols = 1 << 19);
+	~op_bfd_cache();
+
+private:
+	friend class cached_op_bfd;
+
+	/// image name and extra_images uid
+	typedef std::pair<std::string, int> key_t;
+	typedef std::list<key_t> unused_list;
+
+	struct entry {
+		op_bfd * abfd;
+		/// the ok result of the op_bfd ctor
+		bool ok;
+		size_t refcount;
+		/// position in unused if refcount is zero
+		unused_list::iterator unused_pos;
+	};
+
+	typedef std::map<key_t, entry> entries_t;
+
+	entries_t::iterator acquire(std::string const & image,
+	                            extra_images const & extra);
+	void release(entries_t::iterator it);
+	/// free unused op_bfd until they hold at most max_symbols symbols
+	void trim();
+
+	entries_t entries;
+	/// least recently used first
+	unused_list unused;
+	/// number of symbols held by unused op_bfd
+	size_t unused_symbols;
+	size_t const max_symbols;
+	pthread_mutex_t mutex;
+};
+
+
+/// An op_bfd shared through an op_bfd_cache for the lifetime of this object
+class cached_op_bfd : noncopyable {
+public:
+	/**
+	 * Get the op_bfd for image, ok is set as the op_bfd ctor would
+	 * set it when passed true.
+	 */
+	cached_op_bfd(op_bfd_cache & cache, std::string const & image,
+	              extra_images const & extra, bool & ok);
+	~cached_op_bfd();
+
+	op_bfd const & get() const { return *it->second.abfd; }
+
+private:
+	op_bfd_cache & cache;
+	op_bfd_cache::entries_t::iterator it;
+};
+
+#endif /* !OP_BFD_CACHE_H */
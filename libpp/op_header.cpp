@@ -14,6 +14,7 @@
 #include <iostream>
 #include <cstdlib>
 #include <iomanip>
+#include <map>
 #include <set>
 #include <sstream>
 #include <cstring>
@@ -154,6 +155,29 @@ opd_header const read_header(string const & sample_filename)
 }
 
 
+namespace {
+
+typedef map<string, opd_header> header_map;
+header_map cached_headers;
+
+}
+
+
+void cache_header(string const & sample_filename, opd_header const & header)
+{
+	cached_headers[sample_filename] = header;
+}
+
+
+opd_header const read_cached_header(string const & sample_filename)
+{
+	header_map::const_iterator it = cached_headers.find(sample_filename);
+	if (it != cached_headers.end())
+		return it->second;
+	return read_header(sample_filename);
+}
+
+
 namespace {
 
 string const op_print_event(op_cpu cpu_type, u32 type, u32 um, u32 count)
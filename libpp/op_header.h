@@ -44,6 +44,22 @@ void check_mtime(std::string const & file, opd_header const & header);
  */
 opd_header const read_header(std::string const & sample_filename);
 
+/**
+ * @param sample_filename  a sample file listed by a session manifest
+ * @param header  its header as recorded in the manifest
+ *
+ * Record header so read_cached_header() doesn't need to open the file.
+ */
+void cache_header(std::string const & sample_filename,
+                  opd_header const & header);
+
+/**
+ * As read_header() but return the header recorded by cache_header() if
+ * any, the header fields fixed at the sample file creation, the event
+ * and the unit mask, are the same.
+ */
+opd_header const read_cached_header(std::string const & sample_filename);
+
 /**
  * output a readable form of header, this don't include the cpu type
  * and speed
@@ -16,67 +16,131 @@
 #include "profile_container.h"
 #include "arrange_profiles.h"
 #include "op_bfd.h"
+#include "op_bfd_cache.h"
 #include "op_header.h"
+#include "op_exception.h"
+#include "string_filter.h"
+#include "timings.h"
 #include "populate.h"
 #include "populate_for_spu.h"
+#include "cverb.h"
 
 #include "image_errors.h"
 
+#include <pthread.h>
+
 #include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <vector>
 
 using namespace std;
 
 namespace {
 
-/// load merged files for one set of sample files
-bool
-populate_from_files(profile_t & profile, op_bfd const & abfd,
-                    list<profile_sample_files> const & files)
+/**
+ * The profiles of one binary image, one per image_set of each group in
+ * order, NULL for an image_set without sample file.
+ */
+typedef vector<profile_t *> image_profiles;
+
+
+/// load merged files for one set of sample files, logging them to log
+profile_t * populate_from_files(list<profile_sample_files> const & files,
+                                ostream & log)
 {
 	list<profile_sample_files>::const_iterator it = files.begin();
 	list<profile_sample_files>::const_iterator const end = files.end();
 
+	auto_ptr<profile_t> profile(new profile_t);
+
 	bool found = false;
 	// we can't handle cg files here obviously
 	for (; it != end; ++it) {
 		// A bit ugly but we must accept silently empty sample filename
 		// since we can create a profile_sample_files for cg file only
 		// (i.e no sample to the binary)
-		if (!it->sample_filename.empty()) {
-			profile.add_sample_file(it->sample_filename);
-			profile.set_offset(abfd);
+		list<string>::const_iterator fit = it->sample_filenames.begin();
+		for (; fit != it->sample_filenames.end(); ++fit) {
+			log << "reading samples file " << *fit << endl;
+			profile->add_sample_file(*fit);
+			timings::count("sample files read");
 			found = true;
 		}
 	}
 
-	return found;
+	return found ? profile.release() : 0;
 }
 
-}  // anon namespace
 
+void free_profiles(image_profiles & profiles)
+{
+	for (size_t i = 0; i < profiles.size(); ++i)
+		delete profiles[i];
+	profiles.clear();
+}
 
-void
-populate_for_image(profile_container & samples, inverted_profile const & ip,
-	string_filter const & symbol_filter, bool * has_debug_info)
+
+/**
+ * read the sample files of an image, doesn't touch the binary. Nothing
+ * but log is written to, so it can run in a worker thread.
+ */
+void load_profiles(image_profiles & profiles, inverted_profile const & ip,
+                   ostream & log)
 {
-	if (is_spu_profile(ip)) {
-		populate_for_spu_image(samples, ip, symbol_filter,
-				       has_debug_info);
-		return;
+	scoped_timer timer("read sample files");
+
+	try {
+		for (size_t i = 0; i < ip.groups.size(); ++i) {
+			list<image_set>::const_iterator it
+				= ip.groups[i].begin();
+			list<image_set>::const_iterator const end
+				= ip.groups[i].end();
+			for (; it != end; ++it)
+				profiles.push_back(
+					populate_from_files(it->files, log));
+		}
+	} catch (...) {
+		free_profiles(profiles);
+		throw;
 	}
+}
 
+
+/// add the loaded profiles of an image to the container
+void add_profiles(profile_container & samples, inverted_profile const & ip,
+                  image_profiles const & profiles,
+                  string_filter const & symbol_filter, bool * has_debug_info,
+                  op_bfd_cache * bfd_cache = 0)
+{
 	bool ok = ip.error == image_ok;
-	op_bfd abfd(ip.image, symbol_filter,
-		    samples.extra_found_images, ok);
+
+	// a cached op_bfd is built with an empty filter, and a failed
+	// image must get the fake op_bfd
+	scoped_ptr<cached_op_bfd> cached;
+	scoped_ptr<op_bfd> own;
+	if (bfd_cache && ok && symbol_filter.match_all()) {
+		cached.reset(new cached_op_bfd(*bfd_cache, ip.image,
+		             samples.extra_found_images, ok));
+	} else {
+		own.reset(new op_bfd(ip.image, symbol_filter,
+		          samples.extra_found_images, ok));
+	}
+	op_bfd const & abfd = cached.get() ? cached->get() : *own;
+
 	if (!ok && ip.error == image_ok)
 		ip.error = image_format_failure;
 
 	if (ip.error == image_format_failure)
 		report_image_error(ip, false, samples.extra_found_images);
 
+	scoped_timer timer("populate samples");
+
 	opd_header header;
 
 	bool found = false;
+	size_t pos = 0;
 	for (size_t i = 0; i < ip.groups.size(); ++i) {
 		list<image_set>::const_iterator it
 			= ip.groups[i].begin();
@@ -87,11 +151,12 @@ populate_for_image(profile_container & samples, inverted_profile const & ip,
 		// image_set's files - this is because it->app_image
 		// changes, and the .add() would mis-attribute
 		// to the wrong app_image otherwise
-		for (; it != end; ++it) {
-			profile_t profile;
-			if (populate_from_files(profile, abfd, it->files)) {
-				header = profile.get_header();
-				samples.add(profile, abfd, it->app_image, i);
+		for (; it != end; ++it, ++pos) {
+			profile_t * profile = profiles[pos];
+			if (profile) {
+				profile->set_offset(abfd);
+				header = profile->get_header();
+				samples.add(*profile, abfd, it->app_image, i);
 				found = true;
 			}
 		}
@@ -108,3 +173,255 @@ populate_for_image(profile_container & samples, inverted_profile const & ip,
 	if (has_debug_info)
 		*has_debug_info = abfd.has_debug_info();
 }
+
+
+/**
+ * Images whose sample files are loaded by worker threads while the
+ * calling thread adds the previous images to the container. BFD and the
+ * container are not thread safe so they are only used by the calling
+ * thread, in the order of the images, making the result identical to a
+ * sequential populate.
+ */
+class image_loader : noncopyable {
+public:
+	image_loader(list<inverted_profile> const & iprofiles,
+	             size_t nr_threads);
+	~image_loader();
+
+	/**
+	 * wait until the profiles of image nr are loaded and take them,
+	 * output the log of the worker and rethrow any error met while
+	 * loading them
+	 */
+	void get(size_t nr, image_profiles & profiles);
+
+private:
+	struct job {
+		job() : ip(0), skip(false), done(false), failed(false),
+		        out_of_memory(false) {}
+		inverted_profile const * ip;
+		/// the image is populated by the caller, e.g. SPU profiles
+		bool skip;
+		bool done;
+		image_profiles profiles;
+		/// what the worker would have written to cverb
+		string log;
+		bool failed;
+		/// the error was a std::bad_alloc, rethrown as such
+		bool out_of_memory;
+		string error;
+	};
+
+	static void * worker_main(void * loader);
+	void work();
+
+	vector<job> jobs;
+	vector<pthread_t> threads;
+	/// next job to start
+	size_t next;
+	/// jobs before this one are taken by the caller
+	size_t taken;
+	/// max nr. of jobs loaded ahead of the caller
+	size_t max_ahead;
+	/// cverb << vsfile is enabled, read once by the caller
+	bool verbose_sfile;
+	pthread_mutex_t mutex;
+	pthread_cond_t job_done;
+	pthread_cond_t job_taken;
+};
+
+
+image_loader::image_loader(list<inverted_profile> const & iprofiles,
+                           size_t nr_threads)
+	: jobs(iprofiles.size()), next(0), taken(0),
+	  max_ahead(2 * nr_threads), verbose_sfile(cverb << vsfile)
+{
+	list<inverted_profile>::const_iterator it = iprofiles.begin();
+	for (size_t i = 0; i < jobs.size(); ++i, ++it) {
+		jobs[i].ip = &*it;
+		jobs[i].skip = is_spu_profile(*it);
+	}
+
+	pthread_mutex_init(&mutex, 0);
+	pthread_cond_init(&job_done, 0);
+	pthread_cond_init(&job_taken, 0);
+
+	for (size_t i = 0; i < nr_threads; ++i) {
+		pthread_t thread;
+		if (pthread_create(&thread, 0, worker_main, this))
+			break;
+		threads.push_back(thread);
+	}
+
+	if (threads.empty())
+		throw op_fatal_error("couldn't create any worker thread");
+}
+
+
+image_loader::~image_loader()
+{
+	pthread_mutex_lock(&mutex);
+	// stop the workers, e.g. when unwinding from an error
+	next = jobs.size();
+	taken = jobs.size();
+	pthread_cond_broadcast(&job_taken);
+	pthread_mutex_unlock(&mutex);
+
+	for (size_t i = 0; i < threads.size(); ++i)
+		pthread_join(threads[i], 0);
+
+	for (size_t i = 0; i < jobs.size(); ++i)
+		free_profiles(jobs[i].profiles);
+
+	pthread_cond_destroy(&job_taken);
+	pthread_cond_destroy(&job_done);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+void * image_loader::worker_main(void * loader)
+{
+	static_cast<image_loader *>(loader)->work();
+	return 0;
+}
+
+
+void image_loader::work()
+{
+	pthread_mutex_lock(&mutex);
+
+	while (next < jobs.size()) {
+		if (next >= taken + max_ahead) {
+			pthread_cond_wait(&job_taken, &mutex);
+			continue;
+		}
+
+		job & current = jobs[next++];
+		pthread_mutex_unlock(&mutex);
+
+		// cverb and cerr are not thread safe, the caller outputs
+		// the log when it takes the job
+		ostringstream log;
+		if (!verbose_sfile)
+			log.setstate(ios::badbit);
+
+		image_profiles profiles;
+		bool failed = true;
+		bool out_of_memory = false;
+		string error;
+		try {
+			if (!current.skip)
+				load_profiles(profiles, *current.ip, log);
+			failed = false;
+		} catch (op_exception const & e) {
+			error = e.what();
+		} catch (bad_alloc const &) {
+			out_of_memory = true;
+		} catch (exception const & e) {
+			error = e.what();
+		} catch (...) {
+			error = "unknown error reading the sample files of "
+				+ current.ip->image;
+		}
+
+		pthread_mutex_lock(&mutex);
+		current.profiles.swap(profiles);
+		current.log = log.str();
+		current.failed = failed;
+		current.out_of_memory = out_of_memory;
+		current.error = error;
+		current.done = true;
+		pthread_cond_broadcast(&job_done);
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+
+void image_loader::get(size_t nr, image_profiles & profiles)
+{
+	pthread_mutex_lock(&mutex);
+	while (!jobs[nr].done)
+		pthread_cond_wait(&job_done, &mutex);
+	profiles.swap(jobs[nr].profiles);
+	job const current = jobs[nr];
+	taken = nr + 1;
+	pthread_cond_broadcast(&job_taken);
+	pthread_mutex_unlock(&mutex);
+
+	cverb << vsfile << current.log;
+
+	if (current.out_of_memory)
+		throw bad_alloc();
+	if (current.failed)
+		throw op_fatal_error(current.error);
+}
+
+}  // anon namespace
+
+
+void
+populate_for_image(profile_container & samples, inverted_profile const & ip,
+	string_filter const & symbol_filter, bool * has_debug_info,
+	op_bfd_cache * bfd_cache)
+{
+	if (is_spu_profile(ip)) {
+		populate_for_spu_image(samples, ip, symbol_filter,
+				       has_debug_info);
+		return;
+	}
+
+	image_profiles profiles;
+	load_profiles(profiles, ip, cverb << vsfile);
+	add_profiles(samples, ip, profiles, symbol_filter, has_debug_info,
+	             bfd_cache);
+	free_profiles(profiles);
+}
+
+
+void
+populate_for_images(profile_container & samples,
+	list<inverted_profile> const & iprofiles,
+	string_filter const & symbol_filter, size_t nr_threads,
+	bool * has_debug_info)
+{
+	if (has_debug_info)
+		*has_debug_info = false;
+
+	list<inverted_profile>::const_iterator it = iprofiles.begin();
+	list<inverted_profile>::const_iterator const end = iprofiles.end();
+
+	if (nr_threads <= 1 || iprofiles.size() <= 1) {
+		for (; it != end; ++it) {
+			bool debug_info = false;
+			populate_for_image(samples, *it, symbol_filter,
+			                   &debug_info);
+			if (has_debug_info && debug_info)
+				*has_debug_info = true;
+		}
+		return;
+	}
+
+	image_loader loader(iprofiles, nr_threads);
+
+	for (size_t nr = 0; it != end; ++it, ++nr) {
+		bool debug_info = false;
+		image_profiles profiles;
+		loader.get(nr, profiles);
+		if (is_spu_profile(*it)) {
+			populate_for_spu_image(samples, *it, symbol_filter,
+			                       &debug_info);
+		} else {
+			try {
+				add_profiles(samples, *it, profiles,
+				             symbol_filter, &debug_info);
+			} catch (...) {
+				free_profiles(profiles);
+				throw;
+			}
+			free_profiles(profiles);
+		}
+		if (has_debug_info && debug_info)
+			*has_debug_info = true;
+	}
+}
@@ -12,14 +12,36 @@
 #ifndef POPULATE_H
 #define POPULATE_H
 
+#include <list>
+#include <cstddef>
+
 class profile_container;
 class inverted_profile;
 class string_filter;
+class op_bfd_cache;
 
 
-/// Load all sample file information for exactly one binary image.
+/**
+ * Load all sample file information for exactly one binary image. If
+ * bfd_cache is non-NULL and symbol_filter matches all symbols the
+ * op_bfd for the image is taken from it.
+ */
 void
 populate_for_image(profile_container & samples, inverted_profile const & ip,
-   string_filter const & symbol_filter, bool * has_debug_info);
+   string_filter const & symbol_filter, bool * has_debug_info,
+   op_bfd_cache * bfd_cache = 0);
+
+/**
+ * Load all sample file information for a list of binary images, the
+ * sample files of the next images are read by up to nr_threads threads
+ * while the current image is added. The result doesn't depend on
+ * nr_threads. has_debug_info, if non-NULL, is set if any image has debug
+ * information.
+ */
+void
+populate_for_images(profile_container & samples,
+   std::list<inverted_profile> const & iprofiles,
+   string_filter const & symbol_filter, size_t nr_threads,
+   bool * has_debug_info);
 
 #endif /* POPULATE_H */
@@ -59,10 +59,12 @@ populate_spu_profile_from_files(list<profile_sample_files> const & files,
 	list<profile_sample_files>::const_iterator const end = files.end();
 	for (; it != end; ++it) {
 		profile_t profile;
-		if (it->sample_filename.empty())
+		if (it->sample_filenames.empty())
 			continue;
 
-		profile.add_sample_file(it->sample_filename);
+		list<string>::const_iterator fit = it->sample_filenames.begin();
+		for (; fit != it->sample_filenames.end(); ++fit)
+			profile.add_sample_file(*fit);
 		opd_header header = profile.get_header();
 		if (header.embedded_offset) {
 			abfd = new op_bfd(header.embedded_offset,
@@ -144,8 +146,8 @@ bool is_spu_profile(inverted_profile const & ip)
 			list<profile_sample_files>::const_iterator sfiles_end =
 				grp_it->files.end();
 			for (; sfiles_it != sfiles_end; ++sfiles_it) {
-				if (!sfiles_it->sample_filename.empty()) {
-					sfname = sfiles_it->sample_filename;
+				if (!sfiles_it->sample_filenames.empty()) {
+					sfname = sfiles_it->sample_filenames.front();
 					goto do_check;
 				}
 			}
@@ -11,12 +11,15 @@
  */
 
 #include <unistd.h>
+#include <pthread.h>
 #include <cstring>
 
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
+#include <vector>
 
 #include <cerrno>
 
@@ -31,6 +34,123 @@
 
 using namespace std;
 
+namespace {
+
+/// libodb shares opened files through a global table, sample files can
+/// be loaded by several threads, see populate_for_images()
+pthread_mutex_t odb_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+class odb_lock : noncopyable {
+public:
+	odb_lock() { pthread_mutex_lock(&odb_mutex); }
+	~odb_lock() { pthread_mutex_unlock(&odb_mutex); }
+};
+
+
+void close_sample_file(odb_t & db)
+{
+	odb_lock lock;
+	odb_close(&db);
+}
+
+
+typedef pair<odb_key_t, count_type> sample_entry;
+
+/// order entries by key only, used for lookup in a sorted array
+struct less_key {
+	bool operator()(sample_entry const & lhs, odb_key_t rhs) const {
+		return lhs.first < rhs;
+	}
+};
+
+
+/**
+ * Sort samples by key with a LSD radix sort, 8 bits per pass. Passes
+ * for which all keys have the same digit, e.g. the high bytes of most
+ * non-callgraph keys, are skipped.
+ */
+void radix_sort(vector<sample_entry> & samples)
+{
+	size_t const nr_digits = sizeof(odb_key_t);
+	size_t const size = samples.size();
+
+	if (size < 2)
+		return;
+
+	vector<size_t> counts(nr_digits * 256);
+	for (size_t i = 0; i < size; ++i) {
+		odb_key_t key = samples[i].first;
+		for (size_t d = 0; d < nr_digits; ++d)
+			++counts[d * 256 + ((key >> (d * 8)) & 0xff)];
+	}
+
+	vector<sample_entry> temp(size);
+	vector<sample_entry> * from = &samples;
+	vector<sample_entry> * to = &temp;
+
+	for (size_t d = 0; d < nr_digits; ++d) {
+		size_t * count = &counts[d * 256];
+		odb_key_t first_digit = (samples[0].first >> (d * 8)) & 0xff;
+		if (count[first_digit] == size)
+			continue;
+
+		size_t pos = 0;
+		for (size_t i = 0; i < 256; ++i) {
+			size_t nr = count[i];
+			count[i] = pos;
+			pos += nr;
+		}
+
+		for (size_t i = 0; i < size; ++i) {
+			sample_entry const & entry = (*from)[i];
+			(*to)[count[(entry.first >> (d * 8)) & 0xff]++] = entry;
+		}
+
+		swap(from, to);
+	}
+
+	if (from != &samples)
+		samples.swap(temp);
+}
+
+
+/// merge the sorted new_samples into the sorted samples, cumulating
+/// the counts of identical keys
+void merge_samples(vector<sample_entry> & samples,
+                   vector<sample_entry> const & new_samples)
+{
+	vector<sample_entry> result;
+	result.reserve(samples.size() + new_samples.size());
+
+	vector<sample_entry>::const_iterator it = samples.begin();
+	vector<sample_entry>::const_iterator end = samples.end();
+	vector<sample_entry>::const_iterator new_it = new_samples.begin();
+	vector<sample_entry>::const_iterator new_end = new_samples.end();
+
+	while (it != end || new_it != new_end) {
+		sample_entry entry;
+		if (new_it == new_end ||
+		    (it != end && it->first < new_it->first)) {
+			entry = *it++;
+		} else if (it == end || new_it->first < it->first) {
+			entry = *new_it++;
+		} else {
+			entry = *it++;
+			entry.second += new_it++->second;
+		}
+
+		if (!result.empty() && result.back().first == entry.first)
+			result.back().second += entry.second;
+		else
+			result.push_back(entry);
+	}
+
+	samples.swap(result);
+}
+
+}  // anonymous namespace
+
+
 profile_t::profile_t()
 	: start_offset(0)
 {
@@ -51,7 +171,7 @@ count_type profile_t::sample_count(string const & filename)
 	for (pos = 0; pos < node_nr; ++pos)
 		count += node[pos].value;
 
-	odb_close(&samples_db);
+	close_sample_file(samples_db);
 
 	return count;
 }
@@ -65,7 +185,7 @@ enum profile_type profile_t::is_spu_sample_file(string const & filename)
 	opd_header const & hdr =
 		*static_cast<opd_header *>(odb_get_data(&samples_db));
 	retval = hdr.spu_profile ? cell_spu_profile: normal_profile;
-	odb_close(&samples_db);
+	close_sample_file(samples_db);
 	return retval;
 }
 
@@ -84,6 +204,7 @@ void profile_t::open_sample_file(string const & filename, odb_t & db)
 		throw op_fatal_error(os.str());
 	}
 
+	odb_lock lock;
 	int rc = odb_open(&db, filename.c_str(), ODB_RDONLY,
 		sizeof(struct opd_header));
 
@@ -109,19 +230,22 @@ void profile_t::add_sample_file(string const & filename)
 	odb_node_nr_t node_nr, pos;
 	odb_node_t * node = odb_get_iterator(&samples_db, &node_nr);
 
+	// keys are unique inside a sample file
+	vector<sample_entry> new_samples;
+	new_samples.reserve(node_nr);
 	for (pos = 0; pos < node_nr; ++pos) {
-		ordered_samples_t::iterator it = 
-		    ordered_samples.find(node[pos].key);
-		if (it != ordered_samples.end()) {
-			it->second += node[pos].value;
-		} else {
-			ordered_samples_t::value_type
-				val(node[pos].key, node[pos].value);
-			ordered_samples.insert(val);
-		}
+		new_samples.push_back(sample_entry(node[pos].key,
+		                                   node[pos].value));
 	}
 
-	odb_close(&samples_db);
+	close_sample_file(samples_db);
+
+	radix_sort(new_samples);
+
+	if (ordered_samples.empty())
+		ordered_samples.swap(new_samples);
+	else
+		merge_samples(ordered_samples, new_samples);
 }
 
 
@@ -167,10 +291,44 @@ profile_t::samples_range(odb_key_t start, odb_key_t end) const
 			"oprofile-list@lists.sourceforge.net");
 	}
 
-	ordered_samples_t::const_iterator first = 
-		ordered_samples.lower_bound(start);
+	ordered_samples_t::const_iterator first =
+		lower_bound(ordered_samples.begin(), ordered_samples.end(),
+		            start, less_key());
 	ordered_samples_t::const_iterator last =
-		ordered_samples.lower_bound(end);
+		lower_bound(first, ordered_samples.end(), end, less_key());
+
+	return make_pair(const_iterator(first, start_offset),
+		const_iterator(last, start_offset));
+}
+
+
+profile_t::iterator_pair
+profile_t::samples_range(odb_key_t start, odb_key_t end,
+                         const_iterator hint) const
+{
+	// see above, the empty range keeps hint valid for the next call
+	if (start < start_offset)
+		return make_pair(hint, hint);
+
+	start -= start_offset;
+	end -= start_offset;
+
+	if (start > end) {
+		throw op_fatal_error("profile_t::samples_range(): start > end"
+			" something wrong with kernel or module layout ?\n"
+			"please report problem to "
+			"oprofile-list@lists.sourceforge.net");
+	}
+
+	ordered_samples_t::const_iterator first = hint.it;
+	ordered_samples_t::const_iterator const last_sample =
+		ordered_samples.end();
+	while (first != last_sample && first->first < start)
+		++first;
+
+	ordered_samples_t::const_iterator last = first;
+	while (last != last_sample && last->first < end)
+		++last;
 
 	return make_pair(const_iterator(first, start_offset),
 		const_iterator(last, start_offset));
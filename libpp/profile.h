@@ -14,7 +14,7 @@
 #define PROFILE_H
 
 #include <string>
-#include <map>
+#include <vector>
 #include <iterator>
 
 #include "odb.h"
@@ -90,6 +90,18 @@ public:
 	iterator_pair
 	samples_range(odb_key_t start, odb_key_t end) const;
 
+	/**
+	 * @param start  start offset
+	 * @param end  end offset
+	 * @param hint  no sample of [start, end) is before hint
+	 *
+	 * As above but search forward from hint, walking ranges of increasing
+	 * start offset with hint set to the first iterator of the previous
+	 * range visits the samples once.
+	 */
+	iterator_pair samples_range(odb_key_t start, odb_key_t end,
+	                            const_iterator hint) const;
+
 	/// return a pair of iterator for all samples
 	iterator_pair samples_range() const;
 
@@ -102,14 +114,16 @@ private:
 	/// copy of the samples file header
 	scoped_ptr<opd_header> file_header;
 
-	/// storage type for samples sorted by eip
-	typedef std::map<odb_key_t, count_type> ordered_samples_t;
+	/// storage type for samples sorted by eip, one entry per eip
+	typedef std::vector<std::pair<odb_key_t, count_type> >
+		ordered_samples_t;
 
 	/**
 	 * Samples are stored in hash table, iterating over hash table don't
 	 * provide any ordering, the above count() interface rely on samples
-	 * ordered by eip. This map is only a temporary storage where samples
-	 * are ordered by eip.
+	 * ordered by eip. This array is only a temporary storage where
+	 * samples are ordered by eip, the samples of each new file are
+	 * sorted then merged into it.
 	 */
 	ordered_samples_t ordered_samples;
 
@@ -180,6 +194,8 @@ public:
 	}
 
 private:
+	friend class profile_t;
+
 	iterator_t it;
 	u64 start_offset;
 };
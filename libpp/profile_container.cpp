@@ -77,6 +77,12 @@ void profile_container::add(profile_t const & profile,
 	string const image_name = abfd.get_filename();
 	opd_header header = profile.get_header();
 
+	// symbols and samples are both sorted by offset, sweep them together:
+	// hint is the first sample not before the previous symbol start
+	profile_t::iterator_pair const all_samples = profile.samples_range();
+	profile_t::const_iterator hint = all_samples.first;
+	unsigned long long prev_start = 0;
+
 	for (symbol_index_t i = 0; i < abfd.syms.size(); ++i) {
 
 		unsigned long long start = 0, end = 0;
@@ -84,8 +90,19 @@ void profile_container::add(profile_t const & profile,
 
 		abfd.get_symbol_range(i, start, end);
 
+		// file offsets are not always in vma order, restart the sweep
+		if (start < prev_start)
+			hint = all_samples.first;
+		prev_start = start;
+
+		// skip symbols with no samples without any lookup
+		if (hint == all_samples.second || hint.vma() >= end)
+			continue;
+
 		profile_t::iterator_pair p_it =
-			profile.samples_range(start, end);
+			profile.samples_range(start, end, hint);
+		hint = p_it.first;
+
 		count_type count = accumulate(p_it.first, p_it.second, 0ull);
 
 		// skip entries with no samples
@@ -127,6 +144,8 @@ void profile_container::add(profile_t const & profile,
 		if (need_details)
 			add_samples(abfd, i, p_it, symbol, pclass, start);
 	}
+
+	samples->finalize();
 }
 
 
@@ -0,0 +1,341 @@
+/**
+ * @file profile_export.cpp
+ * Export the symbols of a profile in the format of op_report_export.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "profile_export.h"
+#include "profile_container.h"
+#include "arrange_profiles.h"
+#include "op_exception.h"
+#include "op_report_export.h"
+#include "timings.h"
+
+using namespace std;
+
+namespace {
+
+/// a count column, one array of counts per profile class
+typedef vector<vector<u64> > count_column;
+
+
+/// the columns of an export, built in memory and written at once
+class export_writer {
+public:
+	explicit export_writer(profile_classes const & classes);
+
+	/// add a symbol, return its row
+	u32 add_symbol(symbol_entry const & symb);
+
+	void add_sample(u32 symbol, sample_entry const & sample);
+
+	void add_arc(u32 symbol, op_report_export_arc_kind kind,
+	             symbol_entry const & symb);
+
+	void write(string const & filename);
+
+private:
+	/// return the offset of str in the string table
+	u32 add_string(string const & str);
+	u32 add_image_name(image_name_id id);
+	u32 add_filename(file_location const & file_loc);
+	void add_counts(count_column & column, count_array_t const & counts);
+
+	/// write zeros up to offset
+	void pad(ostream & out, u64 & pos, u64 offset);
+	void write_column(ostream & out, u64 & pos,
+	                  op_report_export_section section, void const * data);
+	template <typename T>
+	void write_column(ostream & out, u64 & pos,
+	                  op_report_export_section section,
+	                  vector<T> const & v) {
+		write_column(out, pos, section, v.empty() ? 0 : &v[0]);
+	}
+	void write_counts(ostream & out, u64 & pos,
+	                  op_report_export_section section,
+	                  count_column const & c);
+
+	op_report_export_header header;
+	extra_images const & extra_found_images;
+	size_t const nr_classes;
+
+	vector<char> strings;
+	map<string, u32> string_offsets;
+	u32 cpu_info;
+
+	vector<u32> class_name;
+	vector<u32> class_longname;
+
+	vector<u32> sym_image;
+	vector<u32> sym_app;
+	vector<u32> sym_name;
+	vector<u32> sym_file;
+	vector<u32> sym_line;
+	vector<u64> sym_vma;
+	vector<u64> sym_size;
+	count_column sym_counts;
+
+	vector<u32> sample_symbol;
+	vector<u64> sample_vma;
+	vector<u32> sample_file;
+	vector<u32> sample_line;
+	count_column sample_counts;
+
+	vector<u32> arc_symbol;
+	vector<u32> arc_kind;
+	vector<u32> arc_image;
+	vector<u32> arc_app;
+	vector<u32> arc_name;
+	vector<u64> arc_vma;
+	count_column arc_counts;
+};
+
+
+export_writer::export_writer(profile_classes const & classes)
+	:
+	extra_found_images(classes.extra_found_images),
+	nr_classes(classes.v.size()),
+	sym_counts(nr_classes),
+	sample_counts(nr_classes),
+	arc_counts(nr_classes)
+{
+	// the empty string is at offset 0
+	add_string(string());
+	cpu_info = add_string(classes.cpuinfo);
+
+	for (size_t i = 0; i < nr_classes; ++i) {
+		class_name.push_back(add_string(classes.v[i].name));
+		class_longname.push_back(add_string(classes.v[i].longname));
+	}
+}
+
+
+u32 export_writer::add_symbol(symbol_entry const & symb)
+{
+	if (sym_vma.size() > u32(-1))
+		throw op_runtime_error("export: too many symbols");
+
+	sym_image.push_back(add_image_name(symb.image_name));
+	sym_app.push_back(add_image_name(symb.app_name));
+	sym_name.push_back(add_string(symbol_names.demangle(symb.name)));
+	sym_file.push_back(add_filename(symb.sample.file_loc));
+	sym_line.push_back(symb.sample.file_loc.linenr);
+	sym_vma.push_back(symb.sample.vma);
+	sym_size.push_back(symb.size);
+	add_counts(sym_counts, symb.sample.counts);
+
+	return sym_vma.size() - 1;
+}
+
+
+void export_writer::add_sample(u32 symbol, sample_entry const & sample)
+{
+	sample_symbol.push_back(symbol);
+	sample_vma.push_back(sample.vma);
+	sample_file.push_back(add_filename(sample.file_loc));
+	sample_line.push_back(sample.file_loc.linenr);
+	add_counts(sample_counts, sample.counts);
+}
+
+
+void export_writer::add_arc(u32 symbol, op_report_export_arc_kind kind,
+                            symbol_entry const & symb)
+{
+	arc_symbol.push_back(symbol);
+	arc_kind.push_back(kind);
+	arc_image.push_back(add_image_name(symb.image_name));
+	arc_app.push_back(add_image_name(symb.app_name));
+	arc_name.push_back(add_string(symbol_names.demangle(symb.name)));
+	arc_vma.push_back(symb.sample.vma);
+	add_counts(arc_counts, symb.sample.counts);
+}
+
+
+u32 export_writer::add_string(string const & str)
+{
+	map<string, u32>::const_iterator it = string_offsets.find(str);
+	if (it != string_offsets.end())
+		return it->second;
+
+	if (strings.size() + str.length() + 1 > u32(-1))
+		throw op_runtime_error("export: string table overflow");
+
+	u32 const offset = strings.size();
+	strings.insert(strings.end(), str.begin(), str.end());
+	strings.push_back('\0');
+	string_offsets[str] = offset;
+	return offset;
+}
+
+
+u32 export_writer::add_image_name(image_name_id id)
+{
+	return add_string(get_image_name(id, image_name_storage::int_filename,
+	                                 extra_found_images));
+}
+
+
+u32 export_writer::add_filename(file_location const & file_loc)
+{
+	return add_string(debug_names.name(file_loc.filename));
+}
+
+
+void export_writer::
+add_counts(count_column & column, count_array_t const & counts)
+{
+	for (size_t i = 0; i < nr_classes; ++i)
+		column[i].push_back(counts[i]);
+}
+
+
+void export_writer::pad(ostream & out, u64 & pos, u64 offset)
+{
+	static char const zeros[8] = { 0 };
+
+	// the sections are 8 bytes aligned
+	out.write(zeros, offset - pos);
+	pos = offset;
+}
+
+
+void export_writer::write_column(ostream & out, u64 & pos,
+                                 op_report_export_section section,
+                                 void const * data)
+{
+	op_report_export_section_desc const & desc = header.sections[section];
+
+	pad(out, pos, desc.offset);
+	if (desc.size)
+		out.write(static_cast<char const *>(data), desc.size);
+	pos = desc.offset + desc.size;
+}
+
+
+void export_writer::write_counts(ostream & out, u64 & pos,
+                                 op_report_export_section section,
+                                 count_column const & column)
+{
+	op_report_export_section_desc const & desc = header.sections[section];
+
+	pad(out, pos, desc.offset);
+	for (size_t i = 0; i < nr_classes; ++i) {
+		if (!column[i].empty()) {
+			out.write(reinterpret_cast<char const *>(&column[i][0]),
+			          column[i].size() * sizeof(u64));
+		}
+	}
+	pos = desc.offset + desc.size;
+}
+
+
+void export_writer::write(string const & filename)
+{
+	u64 const size = op_report_export_init_header(&header, nr_classes,
+		sym_vma.size(), sample_vma.size(), arc_vma.size(),
+		strings.size());
+	if (!size)
+		throw op_runtime_error("export: too large for " + filename);
+	header.cpu_info = cpu_info;
+
+	ofstream out(filename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!out)
+		throw op_runtime_error("export: can't create " + filename);
+
+	out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+	u64 pos = sizeof(header);
+
+	write_column(out, pos, OP_REPORT_EXPORT_STRINGS, strings);
+	write_column(out, pos, OP_REPORT_EXPORT_CLASS_NAME, class_name);
+	write_column(out, pos, OP_REPORT_EXPORT_CLASS_LONGNAME, class_longname);
+
+	write_column(out, pos, OP_REPORT_EXPORT_SYM_IMAGE, sym_image);
+	write_column(out, pos, OP_REPORT_EXPORT_SYM_APP, sym_app);
+	write_column(out, pos, OP_REPORT_EXPORT_SYM_NAME, sym_name);
+	write_column(out, pos, OP_REPORT_EXPORT_SYM_FILE, sym_file);
+	write_column(out, pos, OP_REPORT_EXPORT_SYM_LINE, sym_line);
+	write_column(out, pos, OP_REPORT_EXPORT_SYM_VMA, sym_vma);
+	write_column(out, pos, OP_REPORT_EXPORT_SYM_SIZE, sym_size);
+	write_counts(out, pos, OP_REPORT_EXPORT_SYM_COUNTS, sym_counts);
+
+	write_column(out, pos, OP_REPORT_EXPORT_SAMPLE_SYMBOL, sample_symbol);
+	write_column(out, pos, OP_REPORT_EXPORT_SAMPLE_VMA, sample_vma);
+	write_column(out, pos, OP_REPORT_EXPORT_SAMPLE_FILE, sample_file);
+	write_column(out, pos, OP_REPORT_EXPORT_SAMPLE_LINE, sample_line);
+	write_counts(out, pos, OP_REPORT_EXPORT_SAMPLE_COUNTS, sample_counts);
+
+	write_column(out, pos, OP_REPORT_EXPORT_ARC_SYMBOL, arc_symbol);
+	write_column(out, pos, OP_REPORT_EXPORT_ARC_KIND, arc_kind);
+	write_column(out, pos, OP_REPORT_EXPORT_ARC_IMAGE, arc_image);
+	write_column(out, pos, OP_REPORT_EXPORT_ARC_APP, arc_app);
+	write_column(out, pos, OP_REPORT_EXPORT_ARC_NAME, arc_name);
+	write_column(out, pos, OP_REPORT_EXPORT_ARC_VMA, arc_vma);
+	write_counts(out, pos, OP_REPORT_EXPORT_ARC_COUNTS, arc_counts);
+
+	// the last section is padded too
+	pad(out, pos, size);
+
+	out.close();
+	if (!out)
+		throw op_runtime_error("export: can't write " + filename);
+}
+
+}  // anonymous namespace
+
+
+void export_profile(string const & filename, profile_classes const & classes,
+                    profile_container const & pc,
+                    symbol_collection const & symbols, bool details)
+{
+	scoped_timer timer("export");
+
+	export_writer writer(classes);
+
+	symbol_collection::const_iterator it = symbols.begin();
+	symbol_collection::const_iterator const end = symbols.end();
+	for (; it != end; ++it) {
+		u32 const row = writer.add_symbol(**it);
+		if (!details)
+			continue;
+
+		sample_container::samples_iterator sit = pc.begin(*it);
+		sample_container::samples_iterator const send = pc.end(*it);
+		for (; sit != send; ++sit)
+			writer.add_sample(row, sit->second);
+	}
+
+	writer.write(filename);
+}
+
+
+void export_callgraph(string const & filename, profile_classes const & classes,
+                      symbol_collection const & symbols)
+{
+	scoped_timer timer("export");
+
+	export_writer writer(classes);
+
+	symbol_collection::const_iterator it = symbols.begin();
+	symbol_collection::const_iterator const end = symbols.end();
+	for (; it != end; ++it) {
+		u32 const row = writer.add_symbol(**it);
+
+		cg_symbol const * symb = dynamic_cast<cg_symbol const *>(*it);
+		if (!symb)
+			continue;
+
+		cg_symbol::children::const_iterator cit;
+		for (cit = symb->callers.begin(); cit != symb->callers.end(); ++cit)
+			writer.add_arc(row, OP_REPORT_EXPORT_ARC_CALLER, *cit);
+		for (cit = symb->callees.begin(); cit != symb->callees.end(); ++cit)
+			writer.add_arc(row, OP_REPORT_EXPORT_ARC_CALLEE, *cit);
+	}
+
+	writer.write(filename);
+}
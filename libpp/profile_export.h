@@ -0,0 +1,47 @@
+/**
+ * @file profile_export.h
+ * Export the symbols of a profile in the format of op_report_export.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#ifndef PROFILE_EXPORT_H
+#define PROFILE_EXPORT_H
+
+#include <string>
+
+#include "symbol.h"
+
+class profile_container;
+struct profile_classes;
+
+/**
+ * export_profile - export symbols of a profile
+ * @param filename  the file to create
+ * @param classes  the profile classes of the profile
+ * @param pc  the profile the symbols come from
+ * @param symbols  the symbols to export, in this order
+ * @param details  export the samples of each symbol too
+ *
+ * Throw an op_runtime_error if filename can't be written.
+ */
+void export_profile(std::string const & filename,
+                    profile_classes const & classes,
+                    profile_container const & pc,
+                    symbol_collection const & symbols, bool details);
+
+/**
+ * export_callgraph - export symbols of a call graph
+ * @param filename  the file to create
+ * @param classes  the profile classes of the profile
+ * @param symbols  cg_symbol from a callgraph_container, in this order
+ *
+ * The callers and callees of each symbol are exported as arcs. Throw an
+ * op_runtime_error if filename can't be written.
+ */
+void export_callgraph(std::string const & filename,
+                      profile_classes const & classes,
+                      symbol_collection const & symbols);
+
+#endif /* !PROFILE_EXPORT_H */
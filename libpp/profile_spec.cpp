@@ -13,10 +13,14 @@
 #include <sstream>
 #include <iterator>
 #include <iostream>
+#include <fstream>
+#include <cstring>
 #include <dirent.h>
+#include <pthread.h>
 
 #include "file_manip.h"
 #include "op_config.h"
+#include "op_manifest.h"
 #include "profile_spec.h"
 #include "string_manip.h"
 #include "glob_filter.h"
@@ -24,6 +28,9 @@
 #include "op_exception.h"
 #include "op_header.h"
 #include "op_fileio.h"
+#include "cverb.h"
+#include "timings.h"
+#include "tree_walker.h"
 
 using namespace std;
 
@@ -48,11 +55,39 @@ void fixup_image_spec(vector<string> & images, extra_images const & extra)
 		*it = fixup_image_spec(*it, extra);
 }
 
+
+/// a time: bound, seconds since the Epoch or hh:mm[:ss] of the current day
+time_t parse_time_bound(string const & str)
+{
+	if (str.empty())
+		return 0;
+
+	if (str.find(':') == string::npos)
+		return op_lexical_cast<time_t>(str);
+
+	vector<string> parts = separate_token(str, ':');
+	if (parts.size() > 3) {
+		throw invalid_argument("parse_time_bound(): "
+		                       "invalid time \"" + str + "\"");
+	}
+
+	time_t now = time(0);
+	struct tm tm = *localtime(&now);
+	tm.tm_hour = op_lexical_cast<int>(parts[0]);
+	tm.tm_min = op_lexical_cast<int>(parts[1]);
+	tm.tm_sec = parts.size() == 3 ? op_lexical_cast<int>(parts[2]) : 0;
+	tm.tm_isdst = -1;
+
+	return mktime(&tm);
+}
+
 }  // anon namespace
 
 
 profile_spec::profile_spec()
 	:
+	time_start(0),
+	time_end(0),
 	extra_found_images()
 {
 	parse_table["archive"] = &profile_spec::parse_archive_path;
@@ -68,6 +103,7 @@ profile_spec::profile_spec()
 	parse_table["tid"] = &profile_spec::parse_tid;
 	parse_table["tgid"] = &profile_spec::parse_tgid;
 	parse_table["cpu"] = &profile_spec::parse_cpu;
+	parse_table["time"] = &profile_spec::parse_time;
 }
 
 
@@ -180,6 +216,19 @@ void profile_spec::parse_cpu(string const & str)
 }
 
 
+void profile_spec::parse_time(string const & str)
+{
+	string::size_type pos = str.find('-');
+	if (pos == string::npos) {
+		throw invalid_argument("profile_spec::parse_time(): "
+		                       "expected start-end \"" + str + "\"");
+	}
+
+	time_start = parse_time_bound(str.substr(0, pos));
+	time_end = parse_time_bound(str.substr(pos + 1));
+}
+
+
 profile_spec::action_t
 profile_spec::get_handler(string const & tag_value, string & value)
 {
@@ -372,16 +421,68 @@ vector<string> filter_session(vector<string> const & session,
 	return result;
 }
 
-static bool invalid_sample_file;
+
+/// sample files of a session read from its manifest
+struct manifest_files {
+	string base_dir;
+	/// a file is recorded again when its header changes, the last
+	/// record wins
+	map<string, opd_header> files;
+};
+
+
+int add_manifest_file(char const * path, opd_header const * header,
+                      void * data)
+{
+	manifest_files * manifest = static_cast<manifest_files *>(data);
+	manifest->files[manifest->base_dir + "/" + path] = *header;
+	return 0;
+}
+
+
+/**
+ * Fill manifest from the manifest of the session base_dir, return false
+ * if the session has no valid manifest.
+ */
+bool read_manifest(string const & base_dir, manifest_files & manifest)
+{
+	manifest.base_dir = base_dir;
+	if (!op_manifest_read(base_dir.c_str(), add_manifest_file, &manifest))
+		return true;
+
+	cverb << vsfile << "no valid manifest in " << base_dir
+	      << ", walking the session" << endl;
+	manifest.files.clear();
+	return false;
+}
+
+/**
+ * Return true if filename is a sample file of the session base_dir
+ * selected by spec. invalid_sample_file is set if filename is one of the
+ * bogus sample files described below.
+ */
 bool valid_candidate(string const & base_dir, string const & filename,
+                     set<string> const & slices, bool only_slices,
                      profile_spec const & spec, bool exclude_dependent,
-                     bool exclude_cg)
+                     bool exclude_cg, bool & invalid_sample_file)
 {
 	if (exclude_cg && filename.find("{cg}") != string::npos)
 		return false;
 
+	string sub = filename.substr(base_dir.size(), string::npos);
+
+	// strip out files from time slices not selected
+	if (is_prefix(sub, "/" OP_SLICE_PREFIX)) {
+		string::size_type pos = sub.find('/', 1);
+		if (pos == string::npos ||
+		    slices.find(sub.substr(1, pos - 1)) == slices.end())
+			return false;
+		sub.erase(0, pos);
+	} else if (only_slices) {
+		return false;
+	}
+
 	// strip out non sample files
-	string const & sub = filename.substr(base_dir.size(), string::npos);
 	if (!is_prefix(sub, "/{root}/") && !is_prefix(sub, "/{kern}/"))
 		return false;
 
@@ -449,6 +550,94 @@ bool valid_candidate(string const & base_dir, string const & filename,
 }
 
 
+/**
+ * Select the sample files of a session while it is walked, the
+ * directories which can't hold a selected sample file are not walked.
+ */
+class candidate_visitor : public tree_visitor {
+public:
+	candidate_visitor(string const & base_dir_, set<string> const & slices_,
+	                  bool only_slices_, profile_spec const & spec_,
+	                  bool exclude_dependent_, bool exclude_cg_)
+		: base_dir(base_dir_), slices(slices_),
+		  only_slices(only_slices_), spec(spec_),
+		  exclude_dependent(exclude_dependent_),
+		  exclude_cg(exclude_cg_), found_file(false),
+		  invalid_sample_file(false) {
+		pthread_mutex_init(&mutex, 0);
+	}
+
+	~candidate_visitor() { pthread_mutex_destroy(&mutex); }
+
+	bool enter_dir(string const & path);
+	void file(string const & path);
+
+private:
+	string const & base_dir;
+	set<string> const & slices;
+	bool const only_slices;
+	profile_spec const & spec;
+	bool const exclude_dependent;
+	bool const exclude_cg;
+
+public:
+	/// true if the session isn't empty
+	bool found_file;
+	bool invalid_sample_file;
+	/// the selected sample files
+	list<string> files;
+
+private:
+	pthread_mutex_t mutex;
+};
+
+
+/// mirror the path checks of valid_candidate()
+bool candidate_visitor::enter_dir(string const & path)
+{
+	pthread_mutex_lock(&mutex);
+	found_file = true;
+	pthread_mutex_unlock(&mutex);
+
+	string const sub = path.substr(base_dir.size());
+	string::size_type const pos = sub.find('/', 1);
+
+	if (pos != string::npos) {
+		// below a slice only {root} and {kern} hold sample files
+		if (!is_prefix(sub, "/" OP_SLICE_PREFIX) ||
+		    sub.find('/', pos + 1) != string::npos)
+			return true;
+		string const top = sub.substr(pos);
+		return top == "/{root}" || top == "/{kern}";
+	}
+
+	if (is_prefix(sub, "/" OP_SLICE_PREFIX))
+		return slices.find(sub.substr(1)) != slices.end();
+
+	if (only_slices)
+		return false;
+
+	return sub == "/{root}" || sub == "/{kern}";
+}
+
+
+void candidate_visitor::file(string const & path)
+{
+	// timed with the whole walk, a timer per file costs more than this
+	bool invalid = false;
+	bool const valid = valid_candidate(base_dir, path, slices, only_slices,
+		spec, exclude_dependent, exclude_cg, invalid);
+
+	pthread_mutex_lock(&mutex);
+	found_file = true;
+	if (valid)
+		files.push_back(path);
+	if (invalid)
+		invalid_sample_file = true;
+	pthread_mutex_unlock(&mutex);
+}
+
+
 /**
  * Print a warning message if we detect any sample buffer overflows
  * occurred in the kernel driver. 
@@ -501,9 +690,56 @@ void warn_if_kern_buffs_overflow(string const & session_samples_dir)
 }  // anonymous namespace
 
 
+set<string> profile_spec::select_slices(string const & session_dir) const
+{
+	list<string> names;
+	create_file_list(names, session_dir, OP_SLICE_PREFIX "*");
+
+	// a slice ends when the next one starts
+	map<unsigned int, time_t> starts;
+	list<string>::const_iterator it = names.begin();
+	for (; it != names.end(); ++it) {
+		unsigned int nr;
+		try {
+			nr = op_lexical_cast<unsigned int>(
+				it->substr(strlen(OP_SLICE_PREFIX)));
+		} catch (invalid_argument const &) {
+			continue;
+		}
+
+		string const start_file =
+			session_dir + "/" + *it + "/" OP_SLICE_START_FILE;
+		ifstream in(start_file.c_str());
+		time_t start = 0;
+		in >> start;
+		starts[nr] = start;
+	}
+
+	set<string> result;
+	map<unsigned int, time_t>::const_iterator sit = starts.begin();
+	map<unsigned int, time_t>::const_iterator const send = starts.end();
+	for (; sit != send; ++sit) {
+		map<unsigned int, time_t>::const_iterator next = sit;
+		++next;
+		time_t const end = next == send ? time(0) : next->second;
+		if (time_end && sit->second >= time_end)
+			continue;
+		if (time_start && end <= time_start)
+			continue;
+		ostringstream name;
+		name << OP_SLICE_PREFIX << sit->first;
+		result.insert(name.str());
+	}
+
+	return result;
+}
+
+
 list<string> profile_spec::generate_file_list(bool exclude_dependent,
-  bool exclude_cg) const
+  bool exclude_cg, size_t nr_threads) const
 {
+	scoped_timer timer("list sample files");
+
 	// FIXME: isn't remove_duplicates faster than doing this, then copy() ?
 	set<string> unique_files;
 
@@ -531,29 +767,61 @@ list<string> profile_spec::generate_file_list(bool exclude_dependent,
 			continue;
 
 		string base_dir;
-		invalid_sample_file = false;
+		bool invalid_sample_file = false;
 		if ((*cit)[0] != '.' && (*cit)[0] != '/')
 			base_dir = archive_path + op_samples_dir;
 		base_dir += *cit;
 
 		base_dir = op_realpath(base_dir);
 
-		list<string> files;
-		create_file_list(files, base_dir, "*", true);
+		bool const only_slices = time_start || time_end;
+		set<string> const slices = select_slices(base_dir);
+		if (only_slices && slices.empty()) {
+			cerr << "Warning: no time slice of " << base_dir
+			     << " match the time: range" << endl;
+		}
+
+		bool session_found_file = false;
+		manifest_files manifest;
+		if (read_manifest(base_dir, manifest)) {
+			map<string, opd_header> const & files =
+				manifest.files;
+
+			map<string, opd_header>::const_iterator it =
+				files.begin();
+			map<string, opd_header>::const_iterator fend =
+				files.end();
+			for (; it != fend; ++it) {
+				session_found_file = true;
+				if (!valid_candidate(base_dir, it->first, slices,
+				    only_slices, *this, exclude_dependent,
+				    exclude_cg, invalid_sample_file))
+					continue;
+				// only the selected files are probed, one
+				// may have been removed since it was recorded
+				if (!op_file_readable(it->first))
+					continue;
+				unique_files.insert(it->first);
+				cache_header(it->first, it->second);
+			}
+		} else {
+			// parsing and filtering are done by the walking
+			// threads
+			scoped_timer walk_timer("walk session");
+			candidate_visitor visitor(base_dir, slices, only_slices,
+				*this, exclude_dependent, exclude_cg);
+			walk_tree(base_dir, visitor, nr_threads);
+			session_found_file = visitor.found_file;
+			invalid_sample_file = visitor.invalid_sample_file;
+			unique_files.insert(visitor.files.begin(),
+			                    visitor.files.end());
+		}
 
-		if (!files.empty()) {
+		if (session_found_file) {
 			found_file = true;
 			warn_if_kern_buffs_overflow(base_dir + "/");
 		}
 
-		list<string>::const_iterator it = files.begin();
-		list<string>::const_iterator fend = files.end();
-		for (; it != fend; ++it) {
-			if (valid_candidate(base_dir, *it, *this,
-			    exclude_dependent, exclude_cg)) {
-				unique_files.insert(*it);
-			}
-		}
 		if (invalid_sample_file) {
 			cerr << "Warning: Invalid sample files found in "
 			     << base_dir << endl;
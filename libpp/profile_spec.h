@@ -14,6 +14,8 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <set>
+#include <ctime>
 
 #include "filename_spec.h"
 #include "comma_list.h"
@@ -45,11 +47,14 @@ public:
 	/**
 	 * @param exclude_dependent  whether to exclude dependent sub-images
 	 * @param exclude_cg  whether to exclude call graph file
+	 * @param nr_threads  nr. of threads walking a session without
+	 *   manifest
 	 *
 	 * Use the spec to generate the list of candidate sample files.
 	 */
 	std::list<std::string>
-	generate_file_list(bool exclude_dependent, bool exclude_cg) const;
+	generate_file_list(bool exclude_dependent, bool exclude_cg,
+	                   size_t nr_threads = 1) const;
 
 	/**
 	 * @param file_spec  the filename specification to check
@@ -65,6 +70,15 @@ public:
 	std::string get_archive_path() const;
 
 private:
+	/**
+	 * @param session_dir  a session directory
+	 *
+	 * return the time slices sub-directory names of session_dir matching
+	 * the time: tag, all time slices if no time: tag was given.
+	 */
+	std::set<std::string>
+	select_slices(std::string const & session_dir) const;
+
 	profile_spec();
 
 	/**
@@ -103,6 +117,7 @@ private:
 	void parse_tid(std::string const &);
 	void parse_tgid(std::string const &);
 	void parse_cpu(std::string const &);
+	void parse_time(std::string const &);
 
 	typedef void (profile_spec::*action_t)(std::string const &);
 	typedef std::map<std::string, action_t> parse_table_t;
@@ -132,6 +147,9 @@ private:
 	comma_list<pid_t> tid;
 	comma_list<pid_t> tgid;
 	comma_list<int> cpu;
+	/// time slice range, a zero bound means unbounded
+	time_t time_start;
+	time_t time_end;
 	// specified by user on command like opreport image1 image2 ...
 	std::vector<std::string> image_or_lib_image;
 
@@ -9,6 +9,7 @@
  * @author John Levon
  */
 
+#include <cassert>
 #include <climits>
 #include <set>
 #include <numeric>
@@ -30,17 +31,52 @@ count_array_t add_counts(count_array_t const & counts,
 	return temp;
 }
 
+
+typedef sample_container::samples_storage::value_type entry_t;
+
+/// order samples by their (symbol, vma) key
+struct less_entry {
+	bool operator()(entry_t const & lhs, entry_t const & rhs) const {
+		return lhs.first < rhs.first;
+	}
+};
+
+
+struct less_index {
+	template <typename Key>
+	bool operator()(entry_t const & lhs, Key const & rhs) const {
+		return lhs.first < rhs;
+	}
+
+	template <typename Key>
+	bool operator()(Key const & lhs, entry_t const & rhs) const {
+		return lhs < rhs.first;
+	}
+};
+
+
+bool is_sorted(sample_container::samples_storage const & samples)
+{
+	for (size_t i = 1; i < samples.size(); ++i) {
+		if (samples[i].first < samples[i - 1].first)
+			return false;
+	}
+	return true;
+}
+
 } // namespace anon
 
 
 sample_container::samples_iterator sample_container::begin() const
 {
+	assert(new_samples.empty());
 	return samples.begin();
 }
 
 
 sample_container::samples_iterator sample_container::end() const
 {
+	assert(new_samples.empty());
 	return samples.end();
 }
 
@@ -48,32 +84,26 @@ sample_container::samples_iterator sample_container::end() const
 sample_container::samples_iterator
 sample_container::begin(symbol_entry const * symbol) const
 {
-	samples_storage::key_type key(symbol, 0);
-
-	return samples.lower_bound(key);
+	assert(new_samples.empty());
+	sample_index_t key(symbol, 0);
+	return lower_bound(samples.begin(), samples.end(), key, less_index());
 }
 
 
 sample_container::samples_iterator 
 sample_container::end(symbol_entry const * symbol) const
 {
-	samples_storage::key_type key(symbol, ~bfd_vma(0));
-
-	return samples.upper_bound(key);
+	assert(new_samples.empty());
+	sample_index_t key(symbol, ~bfd_vma(0));
+	return upper_bound(samples.begin(), samples.end(), key, less_index());
 }
 
 
 void sample_container::insert(symbol_entry const * symbol,
                               sample_entry const & sample)
 {
-	samples_storage::key_type key(symbol, sample.vma);
-
-	samples_storage::iterator it = samples.find(key);
-	if (it != samples.end()) {
-		it->second.counts += sample.counts;
-	} else {
-		samples[key] = sample;
-	}
+	sample_index_t key(symbol, sample.vma);
+	new_samples.push_back(make_pair(key, sample));
 }
 
 
@@ -90,8 +120,10 @@ sample_container::accumulate_samples(debug_name_id filename_id) const
 
 	typedef samples_by_loc_t::const_iterator iterator;
 
-	iterator it1 = samples_by_loc.lower_bound(&lower);
-	iterator it2 = samples_by_loc.upper_bound(&upper);
+	iterator it1 = lower_bound(samples_by_loc.begin(), samples_by_loc.end(),
+	                           &lower, less_by_file_loc());
+	iterator it2 = upper_bound(samples_by_loc.begin(), samples_by_loc.end(),
+	                           &upper, less_by_file_loc());
 
 	return accumulate(it1, it2, count_array_t(), add_counts);
 }
@@ -100,9 +132,11 @@ sample_container::accumulate_samples(debug_name_id filename_id) const
 sample_entry const *
 sample_container::find_by_vma(symbol_entry const * symbol, bfd_vma vma) const
 {
+	assert(new_samples.empty());
 	sample_index_t key(symbol, vma);
-	samples_iterator it = samples.find(key);
-	if (it != samples.end())
+	samples_iterator it =
+		lower_bound(samples.begin(), samples.end(), key, less_index());
+	if (it != samples.end() && it->first == key)
 		return &it->second;
 
 	return 0;
@@ -123,19 +157,63 @@ sample_container::accumulate_samples(debug_name_id filename,
 	typedef pair<samples_by_loc_t::const_iterator,
 		samples_by_loc_t::const_iterator> it_pair;
 
-	it_pair itp = samples_by_loc.equal_range(&sample);
+	it_pair itp = equal_range(samples_by_loc.begin(), samples_by_loc.end(),
+	                          &sample, less_by_file_loc());
 
 	return accumulate(itp.first, itp.second, count_array_t(), add_counts);
 }
 
 
+void sample_container::finalize()
+{
+	if (new_samples.empty())
+		return;
+
+	// samples are mostly inserted in order by profile_container::add()
+	// stable as the first inserted of identical keys is kept
+	if (!is_sorted(new_samples))
+		stable_sort(new_samples.begin(), new_samples.end(),
+		            less_entry());
+
+	samples_storage result;
+	result.reserve(samples.size() + new_samples.size());
+
+	samples_iterator it = samples.begin();
+	samples_iterator const end = samples.end();
+	samples_iterator new_it = new_samples.begin();
+	samples_iterator const new_end = new_samples.end();
+
+	while (it != end || new_it != new_end) {
+		bool const take_new = it == end ||
+			(new_it != new_end && new_it->first < it->first);
+		samples_iterator const next = take_new ? new_it++ : it++;
+		if (!result.empty() && result.back().first == next->first)
+			result.back().second.counts += next->second.counts;
+		else
+			result.push_back(*next);
+	}
+
+	samples.swap(result);
+	new_samples.clear();
+	// pointers in samples_by_loc are no longer valid
+	samples_by_loc.clear();
+}
+
+
 void sample_container::build_by_loc() const
 {
+	assert(new_samples.empty());
+
 	if (!samples_by_loc.empty())
 		return;
 
+	samples_by_loc.reserve(samples.size());
+
 	samples_iterator cit = samples.begin();
 	samples_iterator end = samples.end();
 	for (; cit != end; ++cit)
-		samples_by_loc.insert(&cit->second);
+		samples_by_loc.push_back(&cit->second);
+
+	stable_sort(samples_by_loc.begin(), samples_by_loc.end(),
+	            less_by_file_loc());
 }
@@ -12,8 +12,7 @@
 #ifndef SAMPLE_CONTAINER_H
 #define SAMPLE_CONTAINER_H
 
-#include <map>
-#include <set>
+#include <vector>
 #include <string>
 
 #include "symbol.h"
@@ -23,11 +22,16 @@
  * Arbitrary container of sample entries. Can return
  * number of samples for a file or line number and
  * return the particular sample information for a VMA.
+ *
+ * Samples are kept in a vector sorted by symbol then vma, so the
+ * samples of a symbol are contiguous and all lookups are binary
+ * searches.
  */
 class sample_container {
 	typedef std::pair<symbol_entry const *, bfd_vma> sample_index_t;
 public:
-	typedef std::map<sample_index_t, sample_entry> samples_storage;
+	typedef std::vector<std::pair<sample_index_t, sample_entry> >
+		samples_storage;
 	typedef samples_storage::const_iterator samples_iterator;
 
 	/// return iterator to the first samples for this symbol
@@ -44,6 +48,13 @@ public:
 	/// samples into an existing one. Can only be done before any lookups
 	void insert(symbol_entry const * symbol, sample_entry const &);
 
+	/**
+	 * Merge the samples inserted since the last call, must be called
+	 * once they are all inserted and before any lookup. The iterators
+	 * and sample_entry pointers obtained before are invalidated.
+	 */
+	void finalize();
+
 	/// return nr of samples in the given filename
 	count_array_t accumulate_samples(debug_name_id filename_id) const;
 
@@ -58,18 +69,21 @@ private:
 	/// build the symbol by file-location cache
 	void build_by_loc() const;
 
-	/// main sample entry container
+	/// main sample entry container, sorted by sample_index_t with one
+	/// entry per key
 	samples_storage samples;
 
-	typedef std::multiset<sample_entry const *, less_by_file_loc>
-		samples_by_loc_t;
+	/// samples inserted since the last finalize(), in insertion order
+	samples_storage new_samples;
+
+	typedef std::vector<sample_entry const *> samples_by_loc_t;
 
 	// must be declared after the samples_storage to ensure a
 	// correct life-time.
 
 	/**
-	 * Sample entries by file location. Lazily built when necessary,
-	 * so mutable.
+	 * Sample entries sorted by file location. Lazily built when
+	 * necessary, so mutable.
 	 */
 	mutable samples_by_loc_t samples_by_loc;
 };
@@ -14,6 +14,7 @@
 
 #include "name_storage.h"
 #include "op_exception.h"
+#include "timings.h"
 
 #include <algorithm>
 #include <sstream>
@@ -125,12 +126,100 @@ bool symbol_compare::operator()(symbol_entry const & lhs,
 }
 
 
+/**
+ * Order the positions of a collection as a stable sort by compare orders
+ * the elements at these positions.
+ */
+template <typename Collection>
+struct position_compare {
+	position_compare(Collection const & c, symbol_compare const & comp)
+		: syms(c), compare(comp) {}
+
+	bool operator()(size_t lhs, size_t rhs) const {
+		if (compare(syms[lhs], syms[rhs]))
+			return true;
+		if (compare(syms[rhs], syms[lhs]))
+			return false;
+		return lhs < rhs;
+	}
+
+private:
+	Collection const & syms;
+	symbol_compare const & compare;
+};
+
+
+template <typename Collection>
+void do_select_top(Collection & syms, size_t top, bool lf)
+{
+	if (syms.size() <= top)
+		return;
+
+	scoped_timer timer("select top symbols");
+
+	long_filenames = lf;
+
+	vector<sort_options::sort_order> sort_option;
+	sort_option.push_back(sort_options::sample);
+	for (sort_options::sort_order cur = sort_options::first;
+	     cur != sort_options::last;
+	     cur = sort_options::sort_order(cur + 1)) {
+		if (cur != sort_options::sample)
+			sort_option.push_back(cur);
+	}
+
+	symbol_compare const compare(sort_option, false);
+	position_compare<Collection> const less(syms, compare);
+
+	// a max heap of the positions of the best elements seen, its front
+	// is the worst of them
+	vector<size_t> heap;
+	heap.reserve(top + 1);
+	for (size_t i = 0; i < syms.size(); ++i) {
+		if (heap.size() < top) {
+			heap.push_back(i);
+			push_heap(heap.begin(), heap.end(), less);
+		} else if (top && less(i, heap.front())) {
+			pop_heap(heap.begin(), heap.end(), less);
+			heap.back() = i;
+			push_heap(heap.begin(), heap.end(), less);
+		}
+	}
+
+	// keep the original order, so a stable sort of the result gives the
+	// same order as if the collection had been sorted whole
+	sort(heap.begin(), heap.end());
+
+	Collection result;
+	result.reserve(heap.size());
+	for (size_t i = 0; i < heap.size(); ++i)
+		result.push_back(syms[heap[i]]);
+	syms.swap(result);
+}
+
+
 } // anonymous namespace
 
 
+void sort_options::
+select_top(symbol_collection & syms, size_t top, bool lf)
+{
+	do_select_top(syms, top, lf);
+}
+
+
+void sort_options::
+select_top(diff_collection & syms, size_t top, bool lf)
+{
+	do_select_top(syms, top, lf);
+}
+
+
 void sort_options::
 sort(symbol_collection & syms, bool reverse_sort, bool lf) const
 {
+	scoped_timer timer("sort symbols");
+
 	long_filenames = lf;
 
 	vector<sort_order> sort_option(options);
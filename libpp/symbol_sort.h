@@ -47,6 +47,22 @@ struct sort_options {
 	void sort(diff_collection & syms, bool reverse_sort,
 	          bool long_filenames) const;
 
+	/**
+	 * Keep only the top symbols of the given container with the most
+	 * samples, in their original order. Ties are broken as by the
+	 * default sort so the symbols kept are the first top ones output
+	 * without a sort option. This costs O(n log top) against
+	 * O(n log n) for a sort of the whole container.
+	 */
+	static void select_top(symbol_collection & syms, size_t top,
+	                       bool long_filenames);
+
+	/**
+	 * As above for diffed symbols.
+	 */
+	static void select_top(diff_collection & syms, size_t top,
+	                       bool long_filenames);
+
 	std::vector<sort_order> options;
 };
 
@@ -0,0 +1,119 @@
+/**
+ * @file arrange_profiles_tests.cpp
+ * tests the merging of the sample files of time slices
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <string>
+
+#include "arrange_profiles.h"
+#include "locate_images.h"
+#include "profile.h"
+#include "op_config.h"
+#include "op_file.h"
+#include "op_cpu_type.h"
+#include "op_sample_file.h"
+#include "odb.h"
+
+using namespace std;
+
+namespace {
+
+char const * const sample_name =
+	"/{root}/bin/ls/{dep}/{root}/bin/ls/"
+	"CPU_CLK_UNHALTED.100000.0.all.all.all";
+
+void check(bool ok, char const * what)
+{
+	if (!ok) {
+		cerr << "arrange_profiles_tests: " << what << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+
+/// write a sample file holding count samples at offset 0x10 and one at key
+void write_sample_file(string const & filename, odb_key_t key,
+                       unsigned long count)
+{
+	odb_t odb;
+	int rc;
+
+	check(create_path(filename.c_str()) == 0, "create_path() failed");
+
+	rc = odb_open(&odb, filename.c_str(), ODB_RDWR,
+	              sizeof(struct opd_header));
+	check(rc == 0, "odb_open() failed");
+
+	opd_header * header = static_cast<opd_header *>(odb_get_data(&odb));
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, OPD_MAGIC, sizeof(header->magic));
+	header->version = OPD_VERSION;
+	header->cpu_type = CPU_TIMER_INT;
+	header->ctr_count = 100000;
+
+	check(odb_update_node_with_offset(&odb, 0x10, count) == EXIT_SUCCESS &&
+	      odb_update_node(&odb, key) == EXIT_SUCCESS,
+	      "odb_update_node() failed");
+	odb_close(&odb);
+}
+
+
+count_type sum(profile_t const & profile, odb_key_t key)
+{
+	profile_t::iterator_pair const p = profile.samples_range(key, key + 1);
+	count_type count = 0;
+	for (profile_t::const_iterator it = p.first; it != p.second; ++it)
+		count += it.count();
+	return count;
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	char dir[] = "/tmp/arrange_profiles_tests.XXXXXX";
+	check(mkdtemp(dir), "mkdtemp() failed");
+
+	// the same image and event in two slices
+	string const slice0 = string(dir) + "/current/slice-0" + sample_name;
+	string const slice1 = string(dir) + "/current/slice-1" + sample_name;
+	write_sample_file(slice0, 0x20, 3);
+	write_sample_file(slice1, 0x30, 4);
+
+	list<string> files;
+	files.push_back(slice0);
+	files.push_back(slice1);
+
+	merge_option merge_by = { false, false, false, false, false };
+	extra_images extra;
+	profile_classes const classes = arrange_profiles(files, merge_by, extra);
+
+	check(classes.v.size() == 1, "one class expected");
+	list<profile_set> const & profiles = classes.v[0].profiles;
+	check(profiles.size() == 1, "one profile set expected");
+	list<profile_sample_files> const & sfiles = profiles.front().files;
+	check(sfiles.size() == 1, "one profile_sample_files expected");
+	check(sfiles.front().sample_filenames == files,
+	      "the sample files of both slices expected");
+
+	profile_t profile;
+	list<string>::const_iterator it = files.begin();
+	for (; it != files.end(); ++it)
+		profile.add_sample_file(*it);
+
+	check(sum(profile, 0x10) == 7, "samples of both slices not summed");
+	check(sum(profile, 0x20) == 1 && sum(profile, 0x30) == 1,
+	      "samples of one slice lost");
+
+	check(remove_tree(dir) == 0, "remove_tree() failed");
+
+	return EXIT_SUCCESS;
+}
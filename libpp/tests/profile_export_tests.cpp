@@ -0,0 +1,257 @@
+/**
+ * @file profile_export_tests.cpp
+ * tests the export of a profile by reading it back
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+#include "profile_export.h"
+#include "profile_container.h"
+#include "arrange_profiles.h"
+#include "locate_images.h"
+#include "op_report_export.h"
+
+using namespace std;
+
+namespace {
+
+void check(bool ok, char const * what)
+{
+	if (!ok) {
+		cerr << "profile_export_tests: " << what << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+
+/// the string at the given row of a string offset column
+string column_string(op_report_export const & exp,
+                     op_report_export_section section, u64 row)
+{
+	u32 const * column =
+		static_cast<u32 const *>(op_report_export_column(&exp, section));
+	char const * str = op_report_export_string(&exp, column[row]);
+	check(str, "string offset out of the string table");
+	return str;
+}
+
+
+u64 column_u64(op_report_export const & exp,
+               op_report_export_section section, u64 row)
+{
+	return static_cast<u64 const *>(
+		op_report_export_column(&exp, section))[row];
+}
+
+
+u32 column_u32(op_report_export const & exp,
+               op_report_export_section section, u64 row)
+{
+	return static_cast<u32 const *>(
+		op_report_export_column(&exp, section))[row];
+}
+
+
+symbol_entry make_symbol(char const * image, char const * name,
+                         bfd_vma vma, bfd_vma size,
+                         count_type count0, count_type count1)
+{
+	symbol_entry symb;
+	symb.image_name = image_names.create(string(image));
+	symb.app_name = symb.image_name;
+	symb.name = symbol_names.create(string(name));
+	symb.sample.vma = vma;
+	symb.sample.counts[0] = count0;
+	symb.sample.counts[1] = count1;
+	symb.size = size;
+	return symb;
+}
+
+
+profile_classes make_classes()
+{
+	profile_classes classes;
+	classes.cpuinfo = "test cpu";
+
+	profile_class pclass;
+	pclass.name = "event:CPU_CLK_UNHALTED";
+	pclass.longname = "CPU_CLK_UNHALTED events";
+	classes.v.push_back(pclass);
+	pclass.name = "event:INST_RETIRED";
+	pclass.longname = "INST_RETIRED events";
+	classes.v.push_back(pclass);
+
+	return classes;
+}
+
+
+/// check the header and the class table shared by both layouts
+void check_classes(op_report_export const & exp)
+{
+	op_report_export_header const * header = exp.header;
+
+	check(header->nr_classes == 2, "two classes expected");
+	check(!strcmp(op_report_export_string(&exp, header->cpu_info),
+	              "test cpu"), "wrong cpu_info");
+	check(column_string(exp, OP_REPORT_EXPORT_CLASS_NAME, 1)
+	      == "event:INST_RETIRED", "wrong class name");
+	check(column_string(exp, OP_REPORT_EXPORT_CLASS_LONGNAME, 0)
+	      == "CPU_CLK_UNHALTED events", "wrong class longname");
+}
+
+
+void check_profile(string const & filename, profile_classes const & classes,
+                   symbol_entry const & main_symb,
+                   symbol_entry const & helper_symb)
+{
+	extra_images extra;
+	profile_container pc(false, true, extra);
+
+	symbol_collection symbols;
+	symbols.push_back(&main_symb);
+	symbols.push_back(&helper_symb);
+
+	export_profile(filename, classes, pc, symbols, true);
+
+	op_report_export exp;
+	check(op_report_export_open(&exp, filename.c_str()) == 0,
+	      "op_report_export_open() failed on a symbol export");
+	check_classes(exp);
+
+	check(exp.header->nr_symbols == 2, "two symbols expected");
+	check(exp.header->nr_samples == 0, "no samples expected");
+	check(exp.header->nr_arcs == 0, "no arcs expected");
+
+	check(column_string(exp, OP_REPORT_EXPORT_SYM_NAME, 0) == "main",
+	      "wrong symbol name");
+	check(column_string(exp, OP_REPORT_EXPORT_SYM_NAME, 1) == "helper",
+	      "wrong symbol name");
+	check(column_string(exp, OP_REPORT_EXPORT_SYM_IMAGE, 0) == "/bin/ls",
+	      "wrong image name");
+	check(column_string(exp, OP_REPORT_EXPORT_SYM_APP, 1) == "/bin/ls",
+	      "wrong application name");
+	check(column_string(exp, OP_REPORT_EXPORT_SYM_FILE, 0) == "/src/ls.c",
+	      "wrong source file");
+	check(column_string(exp, OP_REPORT_EXPORT_SYM_FILE, 1).empty(),
+	      "empty source file expected without debug info");
+	check(column_u32(exp, OP_REPORT_EXPORT_SYM_LINE, 0) == 12,
+	      "wrong line number");
+	check(column_u64(exp, OP_REPORT_EXPORT_SYM_VMA, 1) == 0x2000,
+	      "wrong symbol vma");
+	check(column_u64(exp, OP_REPORT_EXPORT_SYM_SIZE, 0) == 0x100,
+	      "wrong symbol size");
+
+	check(op_report_export_count(&exp, OP_REPORT_EXPORT_SYM_COUNTS, 0, 0)
+	      == 10, "wrong count of class 0");
+	check(op_report_export_count(&exp, OP_REPORT_EXPORT_SYM_COUNTS, 1, 0)
+	      == 20, "wrong count of class 1");
+	check(op_report_export_count(&exp, OP_REPORT_EXPORT_SYM_COUNTS, 0, 1)
+	      == 30, "wrong count of class 0");
+	check(op_report_export_count(&exp, OP_REPORT_EXPORT_SYM_COUNTS, 1, 1)
+	      == 40, "wrong count of class 1");
+
+	op_report_export_close(&exp);
+}
+
+
+void check_callgraph(string const & filename, profile_classes const & classes,
+                     symbol_entry const & main_symb,
+                     symbol_entry const & helper_symb)
+{
+	// main calls helper
+	cg_symbol caller(main_symb);
+	symbol_entry callee = helper_symb;
+	callee.sample.counts[0] = 5;
+	callee.sample.counts[1] = 6;
+	caller.callees.push_back(callee);
+
+	cg_symbol called(helper_symb);
+	symbol_entry from = main_symb;
+	from.sample.counts[0] = 5;
+	from.sample.counts[1] = 6;
+	called.callers.push_back(from);
+
+	symbol_collection symbols;
+	symbols.push_back(&caller);
+	symbols.push_back(&called);
+
+	export_callgraph(filename, classes, symbols);
+
+	op_report_export exp;
+	check(op_report_export_open(&exp, filename.c_str()) == 0,
+	      "op_report_export_open() failed on a call graph export");
+	check_classes(exp);
+
+	check(exp.header->nr_symbols == 2, "two symbols expected");
+	check(exp.header->nr_samples == 0, "no samples expected");
+	check(exp.header->nr_arcs == 2, "two arcs expected");
+
+	check(column_string(exp, OP_REPORT_EXPORT_SYM_NAME, 0) == "main",
+	      "wrong symbol name");
+	check(op_report_export_count(&exp, OP_REPORT_EXPORT_SYM_COUNTS, 1, 1)
+	      == 40, "wrong symbol count");
+
+	check(column_u32(exp, OP_REPORT_EXPORT_ARC_SYMBOL, 0) == 0,
+	      "arc 0 must belong to main");
+	check(column_u32(exp, OP_REPORT_EXPORT_ARC_KIND, 0)
+	      == OP_REPORT_EXPORT_ARC_CALLEE, "arc 0 must be a callee");
+	check(column_string(exp, OP_REPORT_EXPORT_ARC_NAME, 0) == "helper",
+	      "wrong callee name");
+	check(column_u64(exp, OP_REPORT_EXPORT_ARC_VMA, 0) == 0x2000,
+	      "wrong callee vma");
+
+	check(column_u32(exp, OP_REPORT_EXPORT_ARC_SYMBOL, 1) == 1,
+	      "arc 1 must belong to helper");
+	check(column_u32(exp, OP_REPORT_EXPORT_ARC_KIND, 1)
+	      == OP_REPORT_EXPORT_ARC_CALLER, "arc 1 must be a caller");
+	check(column_string(exp, OP_REPORT_EXPORT_ARC_NAME, 1) == "main",
+	      "wrong caller name");
+	check(column_string(exp, OP_REPORT_EXPORT_ARC_IMAGE, 1) == "/bin/ls",
+	      "wrong caller image");
+
+	for (u64 arc = 0; arc < 2; ++arc) {
+		check(op_report_export_count(&exp, OP_REPORT_EXPORT_ARC_COUNTS,
+		                             0, arc) == 5,
+		      "wrong arc count of class 0");
+		check(op_report_export_count(&exp, OP_REPORT_EXPORT_ARC_COUNTS,
+		                             1, arc) == 6,
+		      "wrong arc count of class 1");
+	}
+
+	op_report_export_close(&exp);
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	char dir[] = "/tmp/profile_export_tests.XXXXXX";
+	check(mkdtemp(dir), "mkdtemp() failed");
+	string const filename = string(dir) + "/export";
+
+	profile_classes const classes = make_classes();
+
+	symbol_entry main_symb =
+		make_symbol("/bin/ls", "main", 0x1000, 0x100, 10, 20);
+	main_symb.sample.file_loc.filename =
+		debug_names.create(string("/src/ls.c"));
+	main_symb.sample.file_loc.linenr = 12;
+	symbol_entry const helper_symb =
+		make_symbol("/bin/ls", "helper", 0x2000, 0x10, 30, 40);
+
+	check_profile(filename, classes, main_symb, helper_symb);
+	check_callgraph(filename, classes, main_symb, helper_symb);
+
+	unlink(filename.c_str());
+	rmdir(dir);
+	return EXIT_SUCCESS;
+}
@@ -451,6 +451,8 @@ public:
 	void summarize();
 	void set_end(sym_iterator end);
 	string const get_tid() { return thread_id; }
+	/// false if the thread has no sample data to output
+	bool has_samples() const;
 	void output(ostream & out);
 	void dump();
 private:
@@ -469,6 +471,8 @@ public:
 		string const & app_name, sym_iterator it);
 	void summarize();
 	void set_end(sym_iterator end);
+	/// false if the process has no sample data to output
+	bool has_samples();
 	void output(ostream & out);
 	void dump();
 private:
@@ -874,24 +878,24 @@ void thread_info::add_module_symbol(string const & n, sym_iterator it)
 	m.add_to_summary((*it)->sample.counts);
 }
 
-void thread_info::output(ostream & out)
+bool thread_info::has_samples() const
 {
-	ostringstream thread_summary;
-	ostringstream modules_output;
+	// a module is only added for a symbol with samples
+	return nr_modules != 0 || has_sample_counts(summary, lo, hi);
+}
 
-	output_summary(thread_summary);
-
-	for (size_t m = 0; m < nr_modules; ++m)
-		my_modules[m].output(modules_output);
 
+void thread_info::output(ostream & out)
+{
 	// ignore threads with no sample data
-	if (modules_output.str().size() == 0 && thread_summary.str().size() == 0)
+	if (!has_samples())
 		return;
 
 	out << open_element(THREAD, true);
 	out << init_attr(THREAD_ID, thread_id) << close_element(NONE, true);
-	out << thread_summary.str();
-	out << modules_output.str();
+	output_summary(out);
+	for (size_t m = 0; m < nr_modules; ++m)
+		my_modules[m].output(out);
 	out << close_element(THREAD);
 }
 
@@ -936,25 +940,31 @@ void process_info::set_end(sym_iterator end)
 }
 
 
-void process_info::output(ostream & out)
+bool process_info::has_samples()
 {
-	ostringstream process_summary;
-	ostringstream thread_output;
+	if (has_sample_counts(summary, lo, hi))
+		return true;
 
-	output_summary(process_summary);
+	for (size_t t = 0; t < nr_threads; ++t) {
+		if (my_threads[t].has_samples())
+			return true;
+	}
+	return false;
+}
 
-	for (size_t t = 0; t < nr_threads; ++t)
-		my_threads[t].output(thread_output);
 
+void process_info::output(ostream & out)
+{
 	// ignore processes with no sample data
-	if (thread_output.str().size() == 0 && process_summary.str().size() == 0)
+	if (!has_samples())
 		return;
 
 	out << open_element(PROCESS, true);
 	out << init_attr(PROC_ID, process_id);
 	out << init_attr(NAME, name) << close_element(NONE, true);
-	out << process_summary.str();
-	out << thread_output.str();
+	output_summary(out);
+	for (size_t t = 0; t < nr_threads; ++t)
+		my_threads[t].output(out);
 	out << close_element(PROCESS);
 }
 
@@ -0,0 +1,362 @@
+/**
+ * @file bfd_disassembler.cpp
+ * In-process disassembly with libopcodes
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#ifdef HAVE_LIBOPCODES
+#include <dis-asm.h>
+#endif
+
+#include "bfd_disassembler.h"
+#include "bfd_support.h"
+#include "cverb.h"
+
+using namespace std;
+
+#ifdef HAVE_LIBOPCODES
+
+extern verbose vbfd;
+
+namespace {
+
+/// a code symbol, branch targets are printed relative to it
+struct address_symbol {
+	bfd_vma vma;
+	char const * name;
+	bool global;
+
+	bool operator<(address_symbol const & rhs) const {
+		return vma < rhs.vma;
+	}
+};
+
+
+/// at the same vma a global symbol is preferred, as objdump does
+bool less_address_symbol(address_symbol const & lhs,
+                         address_symbol const & rhs)
+{
+	if (lhs.vma != rhs.vma)
+		return lhs.vma < rhs.vma;
+	return lhs.global < rhs.global;
+}
+
+
+/// the code symbols of an image sorted by vma
+typedef vector<address_symbol> symbol_table;
+
+}  // anonymous namespace
+
+
+struct bfd_disassembler::info_t {
+	disassemble_info info;
+	disassembler_ftype print_insn;
+	/// the code symbols, used by print_address()
+	symbol_table symbols;
+	/// the text of the instruction being disassembled
+	string text;
+	/// section contents read for the last range
+	vector<bfd_byte> contents;
+};
+
+
+namespace {
+
+/// append the printf() formatted arguments to text
+int append_text(string & text, char const * format, va_list ap)
+{
+	va_list aq;
+	va_copy(aq, ap);
+
+	char buf[256];
+	int len = vsnprintf(buf, sizeof(buf), format, ap);
+	if (len >= 0 && size_t(len) < sizeof(buf)) {
+		text.append(buf, len);
+	} else if (len >= 0) {
+		vector<char> big(len + 1);
+		vsnprintf(&big[0], big.size(), format, aq);
+		text.append(&big[0], len);
+	}
+
+	va_end(aq);
+	return len;
+}
+
+
+int print_text(void * stream, char const * format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	int len = append_text(*static_cast<string *>(stream), format, ap);
+	va_end(ap);
+	return len;
+}
+
+
+#ifdef INIT_DISASSEMBLE_INFO_STYLED
+int print_styled_text(void * stream, enum disassembler_style,
+                      char const * format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	int len = append_text(*static_cast<string *>(stream), format, ap);
+	va_end(ap);
+	return len;
+}
+#endif
+
+
+/// print an address as objdump does: "addr <symbol+offset>"
+void print_address(bfd_vma vma, disassemble_info * info)
+{
+	symbol_table const & symbols =
+		*static_cast<symbol_table const *>(info->application_data);
+
+	(*info->fprintf_func)(info->stream, "%llx", (unsigned long long)vma);
+
+	address_symbol const key = { vma, 0, false };
+	symbol_table::const_iterator it =
+		upper_bound(symbols.begin(), symbols.end(), key);
+	if (it == symbols.begin())
+		return;
+	--it;
+
+	if (vma == it->vma) {
+		(*info->fprintf_func)(info->stream, " <%s>", it->name);
+	} else {
+		(*info->fprintf_func)(info->stream, " <%s+0x%llx>", it->name,
+		                      (unsigned long long)(vma - it->vma));
+	}
+}
+
+
+/// read the code symbols of abfd, the dynamic ones if it is stripped
+void read_symbols(bfd * abfd, symbol_table & symbols)
+{
+	bool dynamic = false;
+	long size = 0;
+
+	if (bfd_get_file_flags(abfd) & HAS_SYMS)
+		size = bfd_get_symtab_upper_bound(abfd);
+	if (size <= long(sizeof(asymbol *))) {
+		size = bfd_get_dynamic_symtab_upper_bound(abfd);
+		dynamic = true;
+	}
+	if (size <= long(sizeof(asymbol *)))
+		return;
+
+	vector<asymbol *> syms(size / sizeof(asymbol *));
+	long const nr_syms = dynamic
+		? bfd_canonicalize_dynamic_symtab(abfd, &syms[0])
+		: bfd_canonicalize_symtab(abfd, &syms[0]);
+
+	for (long i = 0; i < nr_syms; ++i) {
+		asymbol * sym = syms[i];
+		if (!sym->section || !sym->name || sym->name[0] == '\0' ||
+		    (sym->flags & BSF_SECTION_SYM) || !interesting_symbol(sym))
+			continue;
+
+		address_symbol const symbol = {
+			bfd_asymbol_value(sym), sym->name,
+			(sym->flags & BSF_GLOBAL) != 0
+		};
+		symbols.push_back(symbol);
+	}
+
+	sort(symbols.begin(), symbols.end(), less_address_symbol);
+}
+
+
+/// the vma as printed by bfd_sprintf_vma()
+string vma_string(bfd * abfd, bfd_vma vma)
+{
+	ostringstream os;
+	os << hex << setfill('0')
+	   << setw(bfd_arch_bits_per_address(abfd) > 32 ? 16 : 8) << vma;
+	return os.str();
+}
+
+
+/**
+ * The address of an instruction line as objdump prints it: leading
+ * zeros common to the whole section are dropped by groups of four, the
+ * remaining ones are replaced by spaces.
+ */
+string section_address(bfd * abfd, asection const * sect, bfd_vma vma)
+{
+	string const last = vma_string(abfd,
+		sect->vma + bfd_section_size(abfd, sect));
+	size_t skip = 0;
+	while (last.compare(skip, 5, "00000") == 0)
+		skip += 4;
+
+	string str = vma_string(abfd, vma).substr(skip);
+	for (size_t i = 0; i + 1 < str.length() && str[i] == '0'; ++i)
+		str[i] = ' ';
+	return str;
+}
+
+}  // anonymous namespace
+
+
+bfd_disassembler::bfd_disassembler(string const & image)
+	: abfd(open_bfd(image))
+{
+	if (!abfd)
+		return;
+
+	if (bfd_get_file_flags(abfd) & HAS_RELOC) {
+		cverb << vbfd << image << " is relocatable, "
+		      << "not disassembled in process" << endl;
+		bfd_close(abfd);
+		abfd = 0;
+		return;
+	}
+
+	info.reset(new info_t);
+
+#ifdef INIT_DISASSEMBLE_INFO_STYLED
+	init_disassemble_info(&info->info, &info->text, print_text,
+	                      print_styled_text);
+#else
+	init_disassemble_info(&info->info, &info->text, print_text);
+#endif
+	info->info.arch = bfd_get_arch(abfd);
+	info->info.mach = bfd_get_mach(abfd);
+	info->info.endian = bfd_big_endian(abfd)
+		? BFD_ENDIAN_BIG : BFD_ENDIAN_LITTLE;
+	info->info.print_address_func = print_address;
+	info->info.application_data = &info->symbols;
+	disassemble_init_for_target(&info->info);
+
+	read_symbols(abfd, info->symbols);
+
+#ifdef DISASSEMBLER_TAKES_ARCH
+	info->print_insn = disassembler(bfd_get_arch(abfd),
+	                                bfd_big_endian(abfd),
+	                                bfd_get_mach(abfd), abfd);
+#else
+	info->print_insn = disassembler(abfd);
+#endif
+
+	if (!info->print_insn) {
+		cverb << vbfd << "libopcodes can't disassemble "
+		      << image << endl;
+		bfd_close(abfd);
+		abfd = 0;
+	}
+}
+
+
+bfd_disassembler::~bfd_disassembler()
+{
+	if (abfd)
+		bfd_close(abfd);
+}
+
+
+bool bfd_disassembler::disassemble(bfd_vma start, bfd_vma end,
+                                   insn_list & insns)
+{
+	if (!abfd)
+		return false;
+
+	asection * sect;
+	for (sect = abfd->sections; sect; sect = sect->next) {
+		if ((bfd_get_section_flags(abfd, sect) & SEC_CODE) &&
+		    start >= sect->vma &&
+		    start < sect->vma + bfd_section_size(abfd, sect))
+			break;
+	}
+
+	if (!sect)
+		return false;
+
+	bfd_vma const sect_end = sect->vma + bfd_section_size(abfd, sect);
+	if (end > sect_end)
+		end = sect_end;
+
+	vector<bfd_byte> & contents = info->contents;
+	contents.resize(end - start);
+	if (!contents.empty() &&
+	    !bfd_get_section_contents(abfd, sect, &contents[0],
+	                              start - sect->vma, contents.size()))
+		return false;
+
+	disassemble_info & dinfo = info->info;
+	dinfo.section = sect;
+	dinfo.buffer = contents.empty() ? 0 : &contents[0];
+	dinfo.buffer_vma = start;
+	dinfo.buffer_length = contents.size();
+
+	for (bfd_vma pc = start; pc < end; ) {
+		info->text.clear();
+		int const size = (*info->print_insn)(pc, &dinfo);
+		if (size <= 0)
+			break;
+		disassembled_insn const insn = { pc, info->text };
+		insns.push_back(insn);
+		pc += size;
+	}
+
+	return true;
+}
+
+
+string bfd_disassembler::symbol_address(bfd_vma vma) const
+{
+	return vma_string(abfd, vma);
+}
+
+
+string bfd_disassembler::insn_address(bfd_vma vma) const
+{
+	return section_address(abfd, info->info.section, vma);
+}
+
+#else  // !HAVE_LIBOPCODES
+
+struct bfd_disassembler::info_t {
+};
+
+
+bfd_disassembler::bfd_disassembler(string const &)
+	: abfd(0)
+{
+}
+
+
+bfd_disassembler::~bfd_disassembler()
+{
+}
+
+
+bool bfd_disassembler::disassemble(bfd_vma, bfd_vma, insn_list &)
+{
+	return false;
+}
+
+
+string bfd_disassembler::symbol_address(bfd_vma) const
+{
+	return string();
+}
+
+
+string bfd_disassembler::insn_address(bfd_vma) const
+{
+	return string();
+}
+
+#endif  // HAVE_LIBOPCODES
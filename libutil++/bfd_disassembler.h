@@ -0,0 +1,70 @@
+/**
+ * @file bfd_disassembler.h
+ * In-process disassembly with libopcodes
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * opannotate used to fork objdump for every annotated symbol and parse
+ * back its output. bfd_disassembler disassembles a range of an image in
+ * process into one record per instruction, which opannotate matches with
+ * the samples by vma. The text of an instruction and the addresses are
+ * formatted as "objdump -d --no-show-raw-insn" prints them.
+ */
+
+#ifndef BFD_DISASSEMBLER_H
+#define BFD_DISASSEMBLER_H
+
+#include <bfd.h>
+
+#include <string>
+#include <vector>
+
+#include "utility.h"
+
+/// a disassembled instruction
+struct disassembled_insn {
+	/// vma of the first byte of the instruction
+	bfd_vma vma;
+	/// the instruction, branch targets resolved to symbols
+	std::string text;
+};
+
+class bfd_disassembler : noncopyable {
+public:
+	/**
+	 * Open image. valid() is false if oprofile is built without
+	 * libopcodes, if libopcodes doesn't support the architecture of
+	 * image or if image is relocatable.
+	 */
+	explicit bfd_disassembler(std::string const & image);
+	~bfd_disassembler();
+
+	bool valid() const { return abfd; }
+
+	typedef std::vector<disassembled_insn> insn_list;
+
+	/**
+	 * Append to insns the instructions of [start, end) in vma order.
+	 * Return false if the range isn't in a code section, in which case
+	 * insns is unchanged.
+	 */
+	bool disassemble(bfd_vma start, bfd_vma end, insn_list & insns);
+
+	/// vma as objdump prints it in front of a symbol name
+	std::string symbol_address(bfd_vma vma) const;
+
+	/**
+	 * vma as objdump prints it in front of an instruction, vma must be
+	 * in the range last disassembled.
+	 */
+	std::string insn_address(bfd_vma vma) const;
+
+private:
+	struct info_t;
+
+	bfd * abfd;
+	scoped_ptr<info_t> info;
+};
+
+#endif /* !BFD_DISASSEMBLER_H */
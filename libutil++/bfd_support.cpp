@@ -11,6 +11,7 @@
 #include "bfd_support.h"
 
 #include "op_bfd.h"
+#include "line_index.h"
 #include "op_fileio.h"
 #include "op_config.h"
 #include "string_manip.h"
@@ -24,7 +25,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <string>
+#include <vector>
 #include <cstring>
 #include <cstdlib>
 
@@ -293,41 +296,144 @@ bfd * fdopen_bfd(string const & file, int fd)
 }
 
 
+namespace {
+
+/// the paths of the debug file named basename, in search order
+vector<string> const
+debug_file_candidates(string const & filepath, string const & basename)
+{
+	// Work out the image file's directory prefix
+	string filedir = op_dirname(filepath);
+	// Make sure it starts with /
+	if (filedir.size() > 0 && filedir.at(filedir.size() - 1) != '/')
+		filedir += '/';
+
+	vector<string> candidates;
+	candidates.push_back(filedir + ".debug/" + basename);
+	candidates.push_back(DEBUGDIR + filedir + basename);
+	candidates.push_back(filedir + basename);
+	return candidates;
+}
+
+}  // anonymous namespace
+
+
 bool find_separate_debug_file(bfd * ibfd, string const & filepath_in, 
                               string & debug_filename, extra_images const & extra)
 {
-	string filepath(filepath_in);
 	string basename;
 	unsigned long crc32;
 	
 	if (!get_debug_link_info(ibfd, basename, crc32))
 		return false;
 
-	// Work out the image file's directory prefix
-	string filedir = op_dirname(filepath);
-	// Make sure it starts with /
-	if (filedir.size() > 0 && filedir.at(filedir.size() - 1) != '/')
-		filedir += '/';
-
-	string first_try(filedir + ".debug/" + basename);
-	string second_try(DEBUGDIR + filedir + basename);
-	string third_try(filedir + basename);
-
 	cverb << vbfd << "looking for debugging file " << basename 
 	      << " with crc32 = " << hex << crc32 << endl;
 
-	if (separate_debug_file_exists(first_try, crc32, extra)) 
-		debug_filename = first_try; 
-	else if (separate_debug_file_exists(second_try, crc32, extra))
-		debug_filename = second_try;
-	else if (separate_debug_file_exists(third_try, crc32, extra))
-		debug_filename = third_try;
-	else
+	vector<string> candidates = debug_file_candidates(filepath_in, basename);
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		if (separate_debug_file_exists(candidates[i], crc32, extra)) {
+			debug_filename = candidates[i];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+vector<string> const
+separate_debug_file_candidates(bfd * ibfd, string const & filepath,
+                               extra_images const & extra)
+{
+	string basename;
+	unsigned long crc32;
+
+	if (!get_debug_link_info(ibfd, basename, crc32))
+		return vector<string>();
+
+	vector<string> candidates = debug_file_candidates(filepath, basename);
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		image_error img_ok;
+		candidates[i] = extra.find_image_path(candidates[i],
+		                                      img_ok, true);
+	}
+	return candidates;
+}
+
+
+string get_build_id(bfd * abfd)
+{
+	asection * sect = bfd_get_section_by_name(abfd, ".note.gnu.build-id");
+	if (!sect)
+		return string();
+
+	bfd_size_type size = bfd_section_size(abfd, sect);
+	if (size < 12)
+		return string();
+
+	vector<bfd_byte> contents(size);
+	if (!bfd_get_section_contents(abfd, sect, &contents[0], 0, size))
+		return string();
+
+	// Elf_Nhdr followed by the "GNU" name and the build-id, the name
+	// is padded to 4 bytes
+	bfd_size_type namesz = bfd_get_32(abfd, &contents[0]);
+	bfd_size_type descsz = bfd_get_32(abfd, &contents[4]);
+	bfd_size_type desc = 12 + ((namesz + 3) & ~3);
+	if (desc > size || descsz > size - desc)
+		return string();
+
+	ostringstream os;
+	os << hex << setfill('0');
+	for (bfd_size_type i = 0; i < descsz; ++i)
+		os << setw(2) << (unsigned int)contents[desc + i];
+	return os.str();
+}
+
+
+namespace {
+
+/// read a section if it exists, return false on read error
+bool read_section(bfd * abfd, char const * name,
+                  vector<unsigned char> & contents)
+{
+	asection * sect = bfd_get_section_by_name(abfd, name);
+	if (!sect)
+		return true;
+
+	bfd_size_type size = bfd_section_size(abfd, sect);
+	contents.resize(size);
+	if (size && !bfd_get_section_contents(abfd, sect, &contents[0], 0, size)) {
+		contents.clear();
 		return false;
-	
+	}
 	return true;
 }
 
+}  // anonymous namespace
+
+
+bool read_dwarf_sections(bfd * abfd, dwarf_sections & sections)
+{
+	if (bfd_get_file_flags(abfd) & HAS_RELOC)
+		return false;
+
+	if (!bfd_get_section_by_name(abfd, ".debug_line") ||
+	    !bfd_get_section_by_name(abfd, ".debug_info"))
+		return false;
+
+	// compressed sections are read as is and rejected by line_index
+	// as their compression header isn't a valid unit header
+	sections.big_endian = bfd_big_endian(abfd);
+	return read_section(abfd, ".debug_info", sections.info) &&
+	       read_section(abfd, ".debug_abbrev", sections.abbrev) &&
+	       read_section(abfd, ".debug_line", sections.line) &&
+	       read_section(abfd, ".debug_str", sections.str) &&
+	       read_section(abfd, ".debug_line_str", sections.line_str) &&
+	       read_section(abfd, ".debug_str_offsets", sections.str_offsets);
+}
+
 
 bool interesting_symbol(asymbol * sym)
 {
@@ -592,16 +698,16 @@ find_nearest_line(bfd_info const & b, op_bfd_symbol const & sym,
 		goto fail;
 
 	// take care about artificial symbol
-	if (!sym.symbol())
+	if (!sym.section())
 		goto fail;
 
 	abfd = b.abfd;
 	syms = b.syms.get();
 	if (!syms)
 		goto fail;
-	section = sym.symbol()->section;
+	section = const_cast<asection *>(sym.section());
 	if (anon_obj)
-		pc = offset - sym.symbol()->section->vma;
+		pc = offset - section->vma;
 	else
 		pc = (sym.value() + offset) - sym.filepos();
 
@@ -19,8 +19,10 @@
 #include <stdint.h>
 
 #include <string>
+#include <vector>
 
 class op_bfd_symbol;
+struct dwarf_sections;
 
 /// holder for BFD state we must keep
 struct bfd_info {
@@ -107,6 +109,29 @@ find_separate_debug_file(bfd * ibfd,
                          std::string & debug_filename,
                          extra_images const & extra);
 
+/**
+ * separate_debug_file_candidates - the paths of the debug file of ibfd
+ * @param ibfd binary file
+ * @param filepath path of the binary file
+ * @param extra where to look for the candidates
+ *
+ * Return all the paths where find_separate_debug_file() looks for the
+ * debug file, whether they exist or not, empty if ibfd has no debug link.
+ */
+std::vector<std::string> const
+separate_debug_file_candidates(bfd * ibfd, std::string const & filepath,
+                               extra_images const & extra);
+
+/// return the build-id of abfd in hexadecimal, empty if it has none
+std::string get_build_id(bfd * abfd);
+
+/**
+ * Read the DWARF sections a line_index is built from. Return false if
+ * abfd has no line table or is relocatable, the sections of a relocatable
+ * file needing relocations applied before use.
+ */
+bool read_dwarf_sections(bfd * abfd, dwarf_sections & sections);
+
 /// open the given BFD
 bfd * open_bfd(std::string const & file);
 
@@ -24,6 +24,14 @@
 
 using namespace std;
 
+namespace {
+
+/// objdump output is read by chunks of this size, a pipe holds 64 KiB
+/// on Linux so a read() can get all the pending output
+ssize_t const stdout_buf_size = 64 * 1024;
+
+}
+
 child_reader::child_reader(string const & cmd, vector<string> const & args)
 	:
 	fd1(-1), fd2(-1),
@@ -32,7 +40,7 @@ child_reader::child_reader(string const & cmd, vector<string> const & args)
 	pid(0),
 	first_error(0),
 	buf2(0), sz_buf2(0),
-	buf1(new char[PIPE_BUF]),
+	buf1(new char[stdout_buf_size]),
 	process_name(cmd),
 	is_terminated(true),
 	terminate_on_exception(false),
@@ -129,7 +137,7 @@ bool child_reader::block_read()
 
 	if (select(max(fd1, fd2) + 1, &read_fs, 0, 0, 0) >= 0) {
 		if (FD_ISSET(fd1, &read_fs)) {
-			ssize_t temp = read(fd1, buf1, PIPE_BUF);
+			ssize_t temp = read(fd1, buf1, stdout_buf_size);
 			if (temp >= 0)
 				end1 = temp;
 			else
@@ -175,11 +183,13 @@ bool child_reader::getline(string & result)
 		}
 
 		// for efficiency try to copy as much as we can of data
-		ssize_t temp_pos = pos1;
-		while (temp_pos < end1 && ok) {
-			char ch = buf1[temp_pos++];
-			if (ch == '\n')
+		ssize_t temp_pos = end1;
+		if (pos1 < end1) {
+			void const * eol = memchr(buf1 + pos1, '\n', end1 - pos1);
+			if (eol) {
+				temp_pos = static_cast<char const *>(eol) - buf1 + 1;
 				ok = false;
+			}
 		}
 
 		// !ok ==> endl has been read so do not copy it.
@@ -0,0 +1,1068 @@
+/**
+ * @file line_index.cpp
+ * Address to source line index built from the DWARF line tables
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <map>
+
+#include "line_index.h"
+
+using namespace std;
+
+namespace {
+
+// the DWARF constants we need
+
+enum {
+	DW_TAG_compile_unit = 0x11,
+	DW_TAG_partial_unit = 0x3c,
+	DW_TAG_skeleton_unit = 0x4a
+};
+
+enum {
+	DW_AT_stmt_list = 0x10,
+	DW_AT_comp_dir = 0x1b,
+	DW_AT_str_offsets_base = 0x72
+};
+
+enum {
+	DW_FORM_addr = 0x01,
+	DW_FORM_block2 = 0x03,
+	DW_FORM_block4 = 0x04,
+	DW_FORM_data2 = 0x05,
+	DW_FORM_data4 = 0x06,
+	DW_FORM_data8 = 0x07,
+	DW_FORM_string = 0x08,
+	DW_FORM_block = 0x09,
+	DW_FORM_block1 = 0x0a,
+	DW_FORM_data1 = 0x0b,
+	DW_FORM_flag = 0x0c,
+	DW_FORM_sdata = 0x0d,
+	DW_FORM_strp = 0x0e,
+	DW_FORM_udata = 0x0f,
+	DW_FORM_ref_addr = 0x10,
+	DW_FORM_ref1 = 0x11,
+	DW_FORM_ref2 = 0x12,
+	DW_FORM_ref4 = 0x13,
+	DW_FORM_ref8 = 0x14,
+	DW_FORM_ref_udata = 0x15,
+	DW_FORM_indirect = 0x16,
+	DW_FORM_sec_offset = 0x17,
+	DW_FORM_exprloc = 0x18,
+	DW_FORM_flag_present = 0x19,
+	DW_FORM_strx = 0x1a,
+	DW_FORM_addrx = 0x1b,
+	DW_FORM_ref_sup4 = 0x1c,
+	DW_FORM_strp_sup = 0x1d,
+	DW_FORM_data16 = 0x1e,
+	DW_FORM_line_strp = 0x1f,
+	DW_FORM_ref_sig8 = 0x20,
+	DW_FORM_implicit_const = 0x21,
+	DW_FORM_loclistx = 0x22,
+	DW_FORM_rnglistx = 0x23,
+	DW_FORM_ref_sup8 = 0x24,
+	DW_FORM_strx1 = 0x25,
+	DW_FORM_strx2 = 0x26,
+	DW_FORM_strx3 = 0x27,
+	DW_FORM_strx4 = 0x28,
+	DW_FORM_addrx1 = 0x29,
+	DW_FORM_addrx2 = 0x2a,
+	DW_FORM_addrx3 = 0x2b,
+	DW_FORM_addrx4 = 0x2c
+};
+
+enum {
+	DW_UT_type = 0x02,
+	DW_UT_skeleton = 0x04,
+	DW_UT_split_compile = 0x05,
+	DW_UT_split_type = 0x06
+};
+
+enum {
+	DW_LNS_copy = 1,
+	DW_LNS_advance_pc,
+	DW_LNS_advance_line,
+	DW_LNS_set_file,
+	DW_LNS_set_column,
+	DW_LNS_negate_stmt,
+	DW_LNS_set_basic_block,
+	DW_LNS_const_add_pc,
+	DW_LNS_fixed_advance_pc,
+	DW_LNS_set_prologue_end,
+	DW_LNS_set_epilogue_begin,
+	DW_LNS_set_isa
+};
+
+enum {
+	DW_LNE_end_sequence = 1,
+	DW_LNE_set_address,
+	DW_LNE_define_file
+};
+
+enum {
+	DW_LNCT_path = 1,
+	DW_LNCT_directory_index
+};
+
+
+/// bounds checked reader of a DWARF section, reads past the end fail
+class dwarf_reader {
+public:
+	dwarf_reader(unsigned char const * b, unsigned char const * e,
+	             bool big)
+		: pos(b), end(e), big_endian(big), failed(false) {}
+
+	bool ok() const { return !failed; }
+	bool at_end() const { return pos >= end; }
+
+	/// read an unsigned value of size bytes
+	u64 read(size_t size) {
+		if (size > size_t(end - pos) || size > 8)
+			return fail();
+		u64 value = 0;
+		for (size_t i = 0; i < size; ++i) {
+			size_t shift = big_endian ? size - 1 - i : i;
+			value |= u64(pos[i]) << (shift * 8);
+		}
+		pos += size;
+		return value;
+	}
+
+	u64 uleb() {
+		u64 value = 0;
+		unsigned int shift = 0;
+		unsigned char byte;
+		do {
+			if (pos >= end)
+				return fail();
+			byte = *pos++;
+			if (shift < 64)
+				value |= u64(byte & 0x7f) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+		return value;
+	}
+
+	long long sleb() {
+		u64 value = 0;
+		unsigned int shift = 0;
+		unsigned char byte;
+		do {
+			if (pos >= end)
+				return fail();
+			byte = *pos++;
+			if (shift < 64)
+				value |= u64(byte & 0x7f) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+		if (shift < 64 && (byte & 0x40))
+			value |= ~u64(0) << shift;
+		return value;
+	}
+
+	/// read a NUL terminated string
+	char const * str() {
+		void const * nul = memchr(pos, 0, end - pos);
+		if (!nul) {
+			fail();
+			return "";
+		}
+		char const * s = reinterpret_cast<char const *>(pos);
+		pos = static_cast<unsigned char const *>(nul) + 1;
+		return s;
+	}
+
+	void skip(u64 size) {
+		if (size > u64(end - pos))
+			fail();
+		else
+			pos += size;
+	}
+
+	/// return a reader of the next size bytes, skipped here
+	dwarf_reader sub(u64 size) {
+		unsigned char const * start = pos;
+		skip(size);
+		return dwarf_reader(start, failed ? start : pos, big_endian);
+	}
+
+	/**
+	 * read an initial length field, setting offset_size to 4 or 8
+	 * for the 32 and 64 bits DWARF formats
+	 */
+	u64 unit_length(size_t & offset_size) {
+		offset_size = 4;
+		u64 length = read(4);
+		if (length == 0xffffffff) {
+			offset_size = 8;
+			length = read(8);
+		} else if (length >= 0xfffffff0) {
+			return fail();
+		}
+		return length;
+	}
+
+private:
+	u64 fail() {
+		failed = true;
+		pos = end;
+		return 0;
+	}
+
+	unsigned char const * pos;
+	unsigned char const * end;
+	bool big_endian;
+	bool failed;
+};
+
+
+dwarf_reader section_reader(vector<unsigned char> const & section,
+                            bool big_endian, u64 offset = 0)
+{
+	unsigned char const * begin = section.empty() ? 0 : &section[0];
+	unsigned char const * end = begin + section.size();
+	if (offset > section.size())
+		offset = section.size();
+	return dwarf_reader(begin + offset, end, big_endian);
+}
+
+
+/// the header fields needed to read attribute values
+struct unit_format {
+	unsigned int version;
+	size_t offset_size;
+	size_t address_size;
+};
+
+
+struct form_value {
+	form_value() : form(0), value(0), str(0) {}
+
+	/// the actual form, DW_FORM_indirect resolved
+	u64 form;
+	u64 value;
+	/// the DW_FORM_string value
+	char const * str;
+};
+
+
+/**
+ * read an attribute value. Return false for unsupported forms which
+ * can't be skipped.
+ */
+bool read_form(dwarf_reader & r, u64 form, unit_format const & unit,
+               long long implicit_const, form_value & v)
+{
+	v.form = form;
+
+	switch (form) {
+	case DW_FORM_addr:
+		v.value = r.read(unit.address_size);
+		break;
+	case DW_FORM_block1:
+		r.skip(r.read(1));
+		break;
+	case DW_FORM_block2:
+		r.skip(r.read(2));
+		break;
+	case DW_FORM_block4:
+		r.skip(r.read(4));
+		break;
+	case DW_FORM_block:
+	case DW_FORM_exprloc:
+		r.skip(r.uleb());
+		break;
+	case DW_FORM_data1:
+	case DW_FORM_ref1:
+	case DW_FORM_flag:
+	case DW_FORM_strx1:
+	case DW_FORM_addrx1:
+		v.value = r.read(1);
+		break;
+	case DW_FORM_data2:
+	case DW_FORM_ref2:
+	case DW_FORM_strx2:
+	case DW_FORM_addrx2:
+		v.value = r.read(2);
+		break;
+	case DW_FORM_strx3:
+	case DW_FORM_addrx3:
+		v.value = r.read(3);
+		break;
+	case DW_FORM_data4:
+	case DW_FORM_ref4:
+	case DW_FORM_ref_sup4:
+	case DW_FORM_strx4:
+	case DW_FORM_addrx4:
+		v.value = r.read(4);
+		break;
+	case DW_FORM_data8:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_sig8:
+	case DW_FORM_ref_sup8:
+		v.value = r.read(8);
+		break;
+	case DW_FORM_data16:
+		r.skip(16);
+		break;
+	case DW_FORM_string:
+		v.str = r.str();
+		break;
+	case DW_FORM_sdata:
+		v.value = r.sleb();
+		break;
+	case DW_FORM_udata:
+	case DW_FORM_ref_udata:
+	case DW_FORM_strx:
+	case DW_FORM_addrx:
+	case DW_FORM_loclistx:
+	case DW_FORM_rnglistx:
+		v.value = r.uleb();
+		break;
+	case DW_FORM_strp:
+	case DW_FORM_line_strp:
+	case DW_FORM_sec_offset:
+	case DW_FORM_strp_sup:
+		v.value = r.read(unit.offset_size);
+		break;
+	case DW_FORM_ref_addr:
+		v.value = r.read(unit.version == 2
+			? unit.address_size : unit.offset_size);
+		break;
+	case DW_FORM_flag_present:
+		v.value = 1;
+		break;
+	case DW_FORM_implicit_const:
+		v.value = implicit_const;
+		break;
+	case DW_FORM_indirect:
+		form = r.uleb();
+		if (form == DW_FORM_indirect || form == DW_FORM_implicit_const)
+			return false;
+		return read_form(r, form, unit, 0, v);
+	default:
+		return false;
+	}
+
+	return r.ok();
+}
+
+
+/// return the string at offset in a string section, NULL if invalid
+char const * section_string(vector<unsigned char> const & section,
+                            u64 offset)
+{
+	if (offset >= section.size())
+		return 0;
+	char const * str = reinterpret_cast<char const *>(&section[offset]);
+	if (!memchr(str, 0, section.size() - offset))
+		return 0;
+	return str;
+}
+
+
+/**
+ * return the string value of an attribute, NULL if the form is not a
+ * string form or the string can't be read. has_base is false if the
+ * unit has no DW_AT_str_offsets_base
+ */
+char const * form_string(form_value const & v, dwarf_sections const & s,
+                         unit_format const & unit, bool has_base,
+                         u64 str_offsets_base)
+{
+	switch (v.form) {
+	case DW_FORM_string:
+		return v.str;
+	case DW_FORM_strp:
+		return section_string(s.str, v.value);
+	case DW_FORM_line_strp:
+		return section_string(s.line_str, v.value);
+	case DW_FORM_strx:
+	case DW_FORM_strx1:
+	case DW_FORM_strx2:
+	case DW_FORM_strx3:
+	case DW_FORM_strx4: {
+		if (!has_base)
+			return 0;
+		dwarf_reader r = section_reader(s.str_offsets, s.big_endian,
+			str_offsets_base + v.value * unit.offset_size);
+		u64 offset = r.read(unit.offset_size);
+		return r.ok() ? section_string(s.str, offset) : 0;
+	}
+	}
+
+	return 0;
+}
+
+
+struct abbrev_attr {
+	u64 name;
+	u64 form;
+	long long implicit_const;
+};
+
+
+/// find the abbreviation code in the table at offset, return its tag
+bool find_abbrev(dwarf_sections const & s, u64 offset, u64 code,
+                 u64 & tag, vector<abbrev_attr> & attrs)
+{
+	if (offset >= s.abbrev.size())
+		return false;
+
+	dwarf_reader r = section_reader(s.abbrev, s.big_endian, offset);
+
+	while (r.ok()) {
+		u64 entry_code = r.uleb();
+		if (!entry_code)
+			return false;
+
+		tag = r.uleb();
+		r.read(1);
+		attrs.clear();
+		while (r.ok()) {
+			abbrev_attr attr;
+			attr.name = r.uleb();
+			attr.form = r.uleb();
+			attr.implicit_const = 0;
+			if (!attr.name && !attr.form)
+				break;
+			if (attr.form == DW_FORM_implicit_const)
+				attr.implicit_const = r.sleb();
+			attrs.push_back(attr);
+		}
+
+		if (entry_code == code)
+			return r.ok();
+	}
+
+	return false;
+}
+
+
+/// what a line table needs from the unit using it
+struct line_unit {
+	line_unit() : has_base(false), str_offsets_base(0) {}
+
+	string comp_dir;
+	/// the DW_AT_str_offsets_base of the unit, for DW_FORM_strx names
+	bool has_base;
+	u64 str_offsets_base;
+};
+
+/// the units of the line tables, by line table offset
+typedef map<u64, line_unit> line_units_t;
+
+
+/**
+ * Read the compilation unit DIEs to find the line tables used and their
+ * compilation directory.
+ */
+bool read_units(dwarf_sections const & s, line_units_t & line_units)
+{
+	dwarf_reader r = section_reader(s.info, s.big_endian);
+
+	while (!r.at_end()) {
+		unit_format format;
+		u64 length = r.unit_length(format.offset_size);
+		dwarf_reader unit = r.sub(length);
+		if (!r.ok())
+			return false;
+
+		format.version = unit.read(2);
+		u64 abbrev_offset;
+		if (format.version >= 2 && format.version <= 4) {
+			abbrev_offset = unit.read(format.offset_size);
+			format.address_size = unit.read(1);
+		} else if (format.version == 5) {
+			u64 unit_type = unit.read(1);
+			format.address_size = unit.read(1);
+			abbrev_offset = unit.read(format.offset_size);
+			if (unit_type == DW_UT_skeleton ||
+			    unit_type == DW_UT_split_compile)
+				unit.skip(8);
+			else if (unit_type == DW_UT_type ||
+			         unit_type == DW_UT_split_type)
+				unit.skip(8 + format.offset_size);
+		} else {
+			return false;
+		}
+
+		u64 code = unit.uleb();
+		if (!unit.ok())
+			return false;
+		if (!code)
+			continue;
+
+		u64 tag;
+		vector<abbrev_attr> attrs;
+		if (!find_abbrev(s, abbrev_offset, code, tag, attrs))
+			return false;
+
+		if (tag != DW_TAG_compile_unit && tag != DW_TAG_partial_unit &&
+		    tag != DW_TAG_skeleton_unit)
+			continue;
+
+		bool has_stmt_list = false;
+		u64 stmt_list = 0;
+		line_unit lunit;
+		form_value comp_dir;
+
+		for (size_t i = 0; i < attrs.size(); ++i) {
+			form_value v;
+			if (!read_form(unit, attrs[i].form, format,
+			               attrs[i].implicit_const, v))
+				return false;
+
+			switch (attrs[i].name) {
+			case DW_AT_stmt_list:
+				has_stmt_list = true;
+				stmt_list = v.value;
+				break;
+			case DW_AT_comp_dir:
+				comp_dir = v;
+				break;
+			case DW_AT_str_offsets_base:
+				lunit.has_base = true;
+				lunit.str_offsets_base = v.value;
+				break;
+			}
+		}
+
+		if (!has_stmt_list)
+			continue;
+
+		if (comp_dir.form) {
+			char const * str = form_string(comp_dir, s, format,
+				lunit.has_base, lunit.str_offsets_base);
+			if (!str)
+				return false;
+			lunit.comp_dir = str;
+		}
+
+		line_units.insert(make_pair(stmt_list, lunit));
+	}
+
+	return true;
+}
+
+
+/// an entry of the directory or file name table of a line table
+struct file_entry {
+	file_entry() : dir(0) {}
+
+	string name;
+	u64 dir;
+};
+
+
+/// a sequence of line_index entries, the last one ends the sequence
+struct sequence {
+	u64 start;
+	u64 end;
+	size_t first;
+	size_t last;
+};
+
+
+/// decoder of the line tables into line_index entries
+class line_decoder {
+public:
+	line_decoder(dwarf_sections const & s)
+		: sections(s), zero_based(false) {}
+
+	/// decode the line table at offset
+	bool decode(u64 offset, line_unit const & unit);
+
+	/// move the decoded line information to entries and files
+	void finish(vector<line_index::entry> & entries,
+	            vector<string> & files);
+
+private:
+	/// read a DWARF 5 directory or file name table
+	bool read_entries(dwarf_reader & header, unit_format const & format,
+	                  line_unit const & unit, vector<file_entry> & table);
+
+	/// read the directory and file name tables of DWARF 2 to 4
+	bool read_old_entries(dwarf_reader & header);
+
+	/// the source file name of a file number, as bfd builds it
+	string const file_name(u64 file) const;
+
+	/// return the id of a file number of the current table
+	u32 file_id(u64 file);
+
+	/// append a row to the current sequence
+	void add_row(u64 address, u64 file, u64 line, bool end_sequence);
+
+	dwarf_sections const & sections;
+
+	// the line table being decoded
+	string comp_dir;
+	/// DWARF 5 numbers files and directories from 0, file 0 being the
+	/// primary source file, earlier versions from 1
+	bool zero_based;
+	vector<file_entry> dirs;
+	vector<file_entry> table_files;
+	map<u64, u32> file_ids;
+	size_t sequence_start;
+	bool bad_sequence;
+
+	/// the rows of all the sequences
+	vector<line_index::entry> rows;
+	vector<sequence> sequences;
+	/// all the file names by id
+	vector<string> names;
+	map<string, u32> name_ids;
+};
+
+
+bool line_decoder::decode(u64 offset, line_unit const & unit)
+{
+	dwarf_reader r = section_reader(sections.line, sections.big_endian,
+	                                offset);
+	unit_format format;
+	u64 length = r.unit_length(format.offset_size);
+	dwarf_reader table = r.sub(length);
+	if (!r.ok())
+		return false;
+
+	format.version = table.read(2);
+	if (format.version < 2 || format.version > 5)
+		return false;
+	format.address_size = 0;
+	if (format.version >= 5) {
+		format.address_size = table.read(1);
+		// segment_selector_size
+		table.read(1);
+	}
+
+	dwarf_reader header = table.sub(table.read(format.offset_size));
+	unsigned int const min_inst_length = header.read(1);
+	unsigned int const max_ops = format.version >= 4 ? header.read(1) : 1;
+	header.read(1);
+	int const line_base = static_cast<signed char>(header.read(1));
+	unsigned int const line_range = header.read(1);
+	unsigned int const opcode_base = header.read(1);
+	vector<unsigned int> opcode_lengths(opcode_base);
+	for (unsigned int i = 1; i < opcode_base; ++i)
+		opcode_lengths[i] = header.read(1);
+
+	if (!header.ok() || !line_range || !max_ops)
+		return false;
+
+	comp_dir = unit.comp_dir;
+	zero_based = format.version >= 5;
+	dirs.clear();
+	table_files.clear();
+	file_ids.clear();
+
+	if (format.version >= 5) {
+		if (!read_entries(header, format, unit, dirs) ||
+		    !read_entries(header, format, unit, table_files))
+			return false;
+	} else if (!read_old_entries(header)) {
+		return false;
+	}
+
+	// the state machine
+	u64 address = 0;
+	unsigned int op_index = 0;
+	u64 file = 1;
+	u64 line = 1;
+	sequence_start = rows.size();
+	bad_sequence = false;
+
+	while (!table.at_end()) {
+		unsigned int opcode = table.read(1);
+		u64 advance = 0;
+
+		if (opcode >= opcode_base) {
+			unsigned int adjusted = opcode - opcode_base;
+			advance = adjusted / line_range;
+			line += line_base + int(adjusted % line_range);
+		} else if (opcode == 0) {
+			u64 size = table.uleb();
+			dwarf_reader ext = table.sub(size);
+			switch (ext.read(1)) {
+			case DW_LNE_end_sequence:
+				add_row(address, file, line, true);
+				address = 0;
+				op_index = 0;
+				file = 1;
+				line = 1;
+				break;
+			case DW_LNE_set_address:
+				address = ext.read(size - 1);
+				op_index = 0;
+				break;
+			case DW_LNE_define_file: {
+				file_entry entry;
+				entry.name = ext.str();
+				entry.dir = ext.uleb();
+				table_files.push_back(entry);
+				break;
+			}
+			}
+			if (!ext.ok())
+				return false;
+		} else {
+			switch (opcode) {
+			case DW_LNS_copy:
+				break;
+			case DW_LNS_advance_pc:
+				advance = table.uleb();
+				break;
+			case DW_LNS_advance_line:
+				line += table.sleb();
+				break;
+			case DW_LNS_set_file:
+				file = table.uleb();
+				break;
+			case DW_LNS_const_add_pc:
+				advance = (255 - opcode_base) / line_range;
+				break;
+			case DW_LNS_fixed_advance_pc:
+				address += table.read(2);
+				op_index = 0;
+				break;
+			case DW_LNS_negate_stmt:
+			case DW_LNS_set_basic_block:
+			case DW_LNS_set_prologue_end:
+			case DW_LNS_set_epilogue_begin:
+				break;
+			case DW_LNS_set_column:
+			case DW_LNS_set_isa:
+			default:
+				for (unsigned int i = 0;
+				     i < opcode_lengths[opcode]; ++i)
+					table.uleb();
+				break;
+			}
+		}
+
+		if (!table.ok())
+			return false;
+
+		if (advance) {
+			address += min_inst_length *
+				((op_index + advance) / max_ops);
+			op_index = (op_index + advance) % max_ops;
+		}
+
+		if (opcode >= opcode_base || opcode == DW_LNS_copy)
+			add_row(address, file, line, false);
+	}
+
+	// rows after the last end_sequence cover an unknown range
+	rows.resize(sequence_start);
+
+	return true;
+}
+
+
+bool line_decoder::read_entries(dwarf_reader & header,
+                                unit_format const & format,
+                                line_unit const & unit,
+                                vector<file_entry> & table)
+{
+	// pairs of content type and form describing an entry
+	vector<pair<u64, u64> > entry_format(header.read(1));
+	for (size_t i = 0; i < entry_format.size(); ++i) {
+		entry_format[i].first = header.uleb();
+		entry_format[i].second = header.uleb();
+	}
+
+	u64 const count = header.uleb();
+	if (!header.ok() || (count && entry_format.empty()))
+		return false;
+
+	for (u64 i = 0; i < count; ++i) {
+		file_entry entry;
+		for (size_t j = 0; j < entry_format.size(); ++j) {
+			form_value v;
+			if (!read_form(header, entry_format[j].second,
+			               format, 0, v))
+				return false;
+
+			switch (entry_format[j].first) {
+			case DW_LNCT_path: {
+				char const * str = form_string(v, sections,
+					format, unit.has_base,
+					unit.str_offsets_base);
+				if (!str)
+					return false;
+				entry.name = str;
+				break;
+			}
+			case DW_LNCT_directory_index:
+				entry.dir = v.value;
+				break;
+			}
+		}
+		table.push_back(entry);
+	}
+
+	return header.ok();
+}
+
+
+bool line_decoder::read_old_entries(dwarf_reader & header)
+{
+	while (true) {
+		file_entry entry;
+		entry.name = header.str();
+		if (!header.ok())
+			return false;
+		if (entry.name.empty())
+			break;
+		dirs.push_back(entry);
+	}
+
+	while (true) {
+		file_entry entry;
+		entry.name = header.str();
+		if (!header.ok())
+			return false;
+		if (entry.name.empty())
+			break;
+		entry.dir = header.uleb();
+		header.uleb();
+		header.uleb();
+		table_files.push_back(entry);
+	}
+
+	return header.ok();
+}
+
+
+string const line_decoder::file_name(u64 file) const
+{
+	if (!zero_based) {
+		if (file == 0)
+			return "<unknown>";
+		--file;
+	}
+
+	if (file >= table_files.size())
+		return "<unknown>";
+
+	string const & name = table_files[file].name;
+	if (name.empty() || name[0] == '/')
+		return name;
+
+	// wraps for the directory 0 of earlier versions, which is no
+	// directory
+	u64 const dir = zero_based
+		? table_files[file].dir : table_files[file].dir - 1;
+
+	string const * subdir = 0;
+	if (dir < dirs.size())
+		subdir = &dirs[dir].name;
+
+	string const * dir_name = 0;
+	if ((!subdir || (*subdir)[0] != '/') && !comp_dir.empty())
+		dir_name = &comp_dir;
+
+	if (!dir_name) {
+		dir_name = subdir;
+		subdir = 0;
+	}
+
+	if (!dir_name)
+		return name;
+
+	if (subdir)
+		return *dir_name + '/' + *subdir + '/' + name;
+	return *dir_name + '/' + name;
+}
+
+
+u32 line_decoder::file_id(u64 file)
+{
+	map<u64, u32>::const_iterator it = file_ids.find(file);
+	if (it != file_ids.end())
+		return it->second;
+
+	string const name = file_name(file);
+	map<string, u32>::const_iterator nit = name_ids.find(name);
+	u32 id;
+	if (nit != name_ids.end()) {
+		id = nit->second;
+	} else {
+		id = names.size();
+		names.push_back(name);
+		name_ids[name] = id;
+	}
+
+	file_ids[file] = id;
+	return id;
+}
+
+
+void line_decoder::add_row(u64 address, u64 file, u64 line,
+                           bool end_sequence)
+{
+	line_index::entry row;
+	row.address = address;
+	row.file = end_sequence ? line_index::no_file : file_id(file);
+	row.line = end_sequence ? 0 : line;
+
+	if (rows.size() > sequence_start) {
+		line_index::entry const & prev = rows.back();
+		// addresses must not decrease inside a sequence
+		if (address < prev.address)
+			bad_sequence = true;
+		// a row at the same address replaces the previous one
+		else if (address == prev.address)
+			rows.pop_back();
+	}
+
+	rows.push_back(row);
+	if (!end_sequence)
+		return;
+
+	if (bad_sequence || rows.size() == sequence_start + 1) {
+		rows.resize(sequence_start);
+	} else {
+		sequence seq;
+		seq.start = rows[sequence_start].address;
+		seq.end = address;
+		seq.first = sequence_start;
+		seq.last = rows.size() - 1;
+		sequences.push_back(seq);
+	}
+	sequence_start = rows.size();
+	bad_sequence = false;
+}
+
+
+struct less_start {
+	bool operator()(sequence const & lhs, sequence const & rhs) const {
+		return lhs.start < rhs.start;
+	}
+};
+
+
+void line_decoder::finish(vector<line_index::entry> & entries,
+                          vector<string> & files)
+{
+	sort(sequences.begin(), sequences.end(), less_start());
+
+	// the line of an address covered by overlapping sequences, e.g.
+	// code discarded by the linker, depends on the sequence bfd finds
+	// first: drop them all and leave these addresses to bfd
+	vector<sequence> kept;
+	u64 cluster_end = 0;
+	bool alone = false;
+	for (size_t i = 0; i < sequences.size(); ++i) {
+		sequence const & seq = sequences[i];
+		if (seq.start == seq.end)
+			continue;
+		if (seq.start < cluster_end) {
+			// the first sequence of the cluster was kept
+			if (alone)
+				kept.pop_back();
+			alone = false;
+			cluster_end = max(cluster_end, seq.end);
+			continue;
+		}
+		cluster_end = seq.end;
+		alone = true;
+		kept.push_back(seq);
+	}
+
+	entries.clear();
+	for (size_t i = 0; i < kept.size(); ++i) {
+		for (size_t j = kept[i].first; j <= kept[i].last; ++j) {
+			line_index::entry const & row = rows[j];
+			// the end of a sequence followed by another one
+			if (!entries.empty() &&
+			    entries.back().address == row.address)
+				entries.pop_back();
+			entries.push_back(row);
+		}
+	}
+
+	files.swap(names);
+}
+
+}  // anonymous namespace
+
+
+line_index::line_index()
+	: hint(0)
+{
+}
+
+
+bool line_index::build(dwarf_sections const & sections)
+{
+	entries.clear();
+	files.clear();
+	hint = 0;
+
+	line_units_t line_units;
+	if (!read_units(sections, line_units))
+		return false;
+
+	line_decoder decoder(sections);
+
+	line_units_t::const_iterator it;
+	for (it = line_units.begin(); it != line_units.end(); ++it) {
+		if (!decoder.decode(it->first, it->second))
+			return false;
+	}
+
+	decoder.finish(entries, files);
+	return true;
+}
+
+
+void line_index::assign(vector<entry> & new_entries,
+                        vector<string> & new_files)
+{
+	entries.swap(new_entries);
+	files.swap(new_files);
+	hint = 0;
+}
+
+
+bool line_index::find(u64 vma, string & filename, unsigned int & line) const
+{
+	entry key;
+	key.address = vma;
+
+	vector<entry>::const_iterator first = entries.begin();
+	vector<entry>::const_iterator last = entries.end();
+
+	// gallop forward from the previous match
+	if (hint < entries.size() && entries[hint].address <= vma) {
+		size_t step = 1;
+		size_t pos = hint;
+		while (pos + step < entries.size() &&
+		       entries[pos + step].address <= vma) {
+			pos += step;
+			step *= 2;
+		}
+		first += pos;
+		last = entries.begin() + min(pos + step, entries.size());
+	}
+
+	vector<entry>::const_iterator it = upper_bound(first, last, key);
+	if (it == entries.begin())
+		return false;
+	--it;
+
+	hint = it - entries.begin();
+	if (it->file == no_file)
+		return false;
+
+	filename = files[it->file];
+	line = it->line;
+	return true;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file line_index.h
+ * Address to source line index built from the DWARF line tables
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * bfd_find_nearest_line() is slow and op_bfd::get_linenr() is called for
+ * every sample with --details. A line_index decodes all the line tables
+ * of an image once into an array sorted by address, lookups of increasing
+ * addresses then walk forward from the previous match.
+ *
+ * Source file names are built as bfd does, prefixing relative names with
+ * their include directory and the compilation directory. DWARF 5 line
+ * tables number their files and directories from 0, file 0 being the
+ * primary source file, and may keep their names in .debug_line_str.
+ *
+ * Where bfd's answer is not well defined the caller must use bfd: an
+ * address covered by several sequences is not found.
+ */
+
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <string>
+#include <vector>
+
+#include "op_types.h"
+
+/// the contents of the DWARF sections a line_index is built from
+struct dwarf_sections {
+	dwarf_sections() : big_endian(false) {}
+
+	std::vector<unsigned char> info;
+	std::vector<unsigned char> abbrev;
+	std::vector<unsigned char> line;
+	std::vector<unsigned char> str;
+	std::vector<unsigned char> line_str;
+	std::vector<unsigned char> str_offsets;
+	bool big_endian;
+};
+
+
+class line_index {
+public:
+	/// file index of the entry ending a sequence
+	static u32 const no_file = ~0U;
+
+	/// the line of the addresses from address to the next entry
+	struct entry {
+		u64 address;
+		u32 file;
+		u32 line;
+
+		bool operator<(entry const & rhs) const {
+			return address < rhs.address;
+		}
+	};
+
+	line_index();
+
+	/**
+	 * Decode all the line tables. Return false, leaving the index
+	 * empty, if they use something not supported.
+	 */
+	bool build(dwarf_sections const & sections);
+
+	/**
+	 * Set the index content, entries must be sorted by address and
+	 * have at most one entry per address. The arguments are swapped
+	 * with the index content.
+	 */
+	void assign(std::vector<entry> & entries,
+	            std::vector<std::string> & files);
+
+	/**
+	 * Find the source line of vma. Return false if vma isn't covered
+	 * by exactly one line table sequence.
+	 */
+	bool find(u64 vma, std::string & filename, unsigned int & line) const;
+
+	std::vector<entry> const & get_entries() const { return entries; }
+	std::vector<std::string> const & get_files() const { return files; }
+
+private:
+	/// entries sorted by address, end of sequence entries included
+	std::vector<entry> entries;
+	/// source file names indexed by entry::file
+	std::vector<std::string> files;
+	/// position of the last match, lookups are mostly increasing
+	mutable size_t hint;
+};
+
+#endif /* !LINE_INDEX_H */
@@ -29,7 +29,9 @@
 #include "locate_images.h"
 #include "string_filter.h"
 #include "stream_util.h"
+#include "symbol_cache.h"
 #include "cverb.h"
+#include "timings.h"
 
 using namespace std;
 
@@ -56,7 +58,7 @@ struct remove_filter {
 
 
 op_bfd_symbol::op_bfd_symbol(asymbol const * a)
-	: bfd_symbol(a), symb_value(a->value),
+	: bfd_section(a->section), symb_value(a->value),
 	  section_filepos(a->section->filepos),
 	  section_vma(a->section->vma),
 	  symb_size(0), symb_hidden(false), symb_weak(false),
@@ -78,7 +80,7 @@ op_bfd_symbol::op_bfd_symbol(asymbol const * a)
 
 
 op_bfd_symbol::op_bfd_symbol(bfd_vma vma, size_t size, string const & name)
-	: bfd_symbol(0), symb_value(vma),
+	: bfd_section(0), symb_value(vma),
 	  section_filepos(0), section_vma(0),
 	  symb_size(size), symb_name(name),
 	  symb_artificial(true)
@@ -86,6 +88,20 @@ op_bfd_symbol::op_bfd_symbol(bfd_vma vma, size_t size, string const & name)
 }
 
 
+op_bfd_symbol::op_bfd_symbol(asection const * section,
+                             symbol_cache_record const & record,
+                             char const * name)
+	: bfd_section(section), symb_value(record.value),
+	  section_filepos(record.section_filepos),
+	  section_vma(record.section_vma),
+	  symb_size(record.size), symb_name(name),
+	  symb_hidden(record.flags & SYMBOL_CACHE_HIDDEN),
+	  symb_weak(record.flags & SYMBOL_CACHE_WEAK),
+	  symb_artificial(false)
+{
+}
+
+
 bool op_bfd_symbol::operator<(op_bfd_symbol const & rhs) const
 {
 	return filepos() < rhs.filepos();
@@ -93,7 +109,7 @@ bool op_bfd_symbol::operator<(op_bfd_symbol const & rhs) const
 
 unsigned long op_bfd_symbol::symbol_endpos(void) const
 {
-	return bfd_symbol->section->filepos + bfd_symbol->section->size;
+	return bfd_section->filepos + bfd_section->size;
 }
 
 
@@ -104,6 +120,7 @@ op_bfd::op_bfd(string const & fname, string_filter const & symbol_filter,
 	archive_path(extra_images.get_archive_path()),
 	extra_found_images(extra_images),
 	file_size(-1),
+	symbol_tables_read(false),
 	anon_obj(false)
 {
 	int fd;
@@ -115,11 +132,14 @@ op_bfd::op_bfd(string const & fname, string_filter const & symbol_filter,
 	asection const * sect;
 	string suf = ".jo";
 
+	scoped_timer timer("load symbols");
+
 	image_error img_ok;
 	string const image_path =
 		extra_images.find_image_path(filename, img_ok, true);
 
 	cverb << vbfd << "op_bfd ctor for " << image_path << endl;
+	timings::count("images opened");
 
 	// if there's a problem already, don't try to open it
 	if (!ok || img_ok != image_ok) {
@@ -173,7 +193,23 @@ op_bfd::op_bfd(string const & fname, string_filter const & symbol_filter,
 		}
 	}
 
-	get_symbols(symbols);
+	// JIT images are short-lived, don't fill the cache with them
+	if (anon_obj) {
+		get_symbols(symbols);
+	} else {
+		cache_key.path = image_path;
+		cache_key.size = st.st_size;
+		cache_key.mtime = st.st_mtime;
+		cache_key.build_id = get_build_id(ibfd.abfd);
+		cache_key.debug_stamp = symbol_cache_stamp(
+			separate_debug_file_candidates(ibfd.abfd, filename,
+			                               extra_found_images));
+
+		if (!get_cached_symbols(cache_key, symbols)) {
+			get_symbols(symbols);
+			cache_symbols(cache_key, symbols);
+		}
+	}
 
 out:
 	add_symbols(symbols, symbol_filter);
@@ -217,6 +253,7 @@ void op_bfd::get_symbols(op_bfd::symbols_found_t & symbols)
 
 	dbfd.set_image_bfd_info(&ibfd);
 	dbfd.get_symbols();
+	symbol_tables_read = true;
 
 	size_t i;
 	for (i = 0; i < ibfd.nr_syms; ++i) {
@@ -277,6 +314,220 @@ void op_bfd::get_symbols(op_bfd::symbols_found_t & symbols)
 }
 
 
+namespace {
+
+/// return the sections of abfd indexed by their section index
+vector<asection *> const section_table(bfd * abfd)
+{
+	vector<asection *> sections;
+	if (!abfd)
+		return sections;
+
+	for (asection * sect = abfd->sections; sect; sect = sect->next) {
+		if (size_t(sect->index) >= sections.size())
+			sections.resize(sect->index + 1);
+		sections[sect->index] = sect;
+	}
+	return sections;
+}
+
+}  // anonymous namespace
+
+
+bool op_bfd::get_cached_symbols(symbol_cache_key const & key,
+                                op_bfd::symbols_found_t & symbols)
+{
+	symbol_cache_file cache(key);
+	if (!cache.valid())
+		return false;
+
+	// the entry is up to date so its debug file is the one
+	// find_separate_debug_file() would find, skip the lookup
+	string const debug_file = cache.debug_filename();
+	if (!debug_file.empty()) {
+		debug_filename = debug_file;
+		cverb << vbfd << "now loading: " << debug_filename << endl;
+		dbfd.abfd = open_bfd(debug_filename);
+		if (!dbfd.valid())
+			return false;
+		debug_info.reset(dbfd.has_debug_info());
+	}
+
+	vector<asection *> const isections = section_table(ibfd.abfd);
+	vector<asection *> const dsections = section_table(dbfd.abfd);
+
+	for (size_t i = 0; i < cache.size(); ++i) {
+		symbol_cache_record const & record = cache[i];
+		vector<asection *> const & sections =
+			record.flags & SYMBOL_CACHE_DEBUG
+				? dsections : isections;
+		if (record.section_index >= sections.size() ||
+		    !sections[record.section_index]) {
+			symbols.clear();
+			return false;
+		}
+
+		asection * sect = sections[record.section_index];
+		// see get_symbols()
+		if (record.flags & SYMBOL_CACHE_DEBUG) {
+			u32 filepos = filepos_map[sect->name];
+			if (filepos != 0)
+				sect->filepos = filepos;
+		}
+		symbols.push_back(op_bfd_symbol(sect, record,
+		                                cache.name(record)));
+	}
+
+	cverb << vbfd << "symbol cache hit for " << key.path << endl;
+	timings::count("symbol cache hits");
+	return true;
+}
+
+
+void op_bfd::cache_symbols(symbol_cache_key const & key,
+                           op_bfd::symbols_found_t const & symbols) const
+{
+	if (get_symbol_cache_dir().empty())
+		return;
+
+	symbol_cache_writer writer(key);
+	if (dbfd.valid())
+		writer.set_debug_filename(debug_filename);
+
+	symbols_found_t::const_iterator it;
+	for (it = symbols.begin(); it != symbols.end(); ++it) {
+		symbol_cache_record record;
+		memset(&record, 0, sizeof(record));
+
+		// get_cached_symbols() only finds the sections of these two
+		asection const * sect = it->section();
+		if (sect->owner == dbfd.abfd && dbfd.valid()) {
+			record.flags |= SYMBOL_CACHE_DEBUG;
+		} else if (sect->owner != ibfd.abfd) {
+			cerr << "warning: symbol " << it->name() << " of "
+			     << key.path << " is not in a section of the image "
+			     << "nor of its debug file, symbols not cached"
+			     << endl;
+			return;
+		}
+
+		if (it->hidden())
+			record.flags |= SYMBOL_CACHE_HIDDEN;
+		if (it->weak())
+			record.flags |= SYMBOL_CACHE_WEAK;
+		record.value = it->value();
+		record.section_filepos = it->filepos() - it->value();
+		record.section_vma = it->vma() - it->value();
+		record.size = it->size();
+		record.section_index = sect->index;
+		writer.add(record, it->name());
+	}
+
+	if (!writer.commit())
+		cverb << vbfd << "can't write symbol cache for "
+		      << key.path << endl;
+}
+
+
+void op_bfd::read_symbol_tables() const
+{
+	if (symbol_tables_read)
+		return;
+
+	ibfd.get_symbols();
+	dbfd.set_image_bfd_info(&ibfd);
+	dbfd.get_symbols();
+	symbol_tables_read = true;
+}
+
+
+bool op_bfd::has_line_index() const
+{
+	if (line_index_ok.cached())
+		return line_index_ok.get();
+
+	if (get_cached_line_index())
+		return line_index_ok.reset(true);
+
+	bfd_info const & b = dbfd.valid() ? dbfd : ibfd;
+	dwarf_sections sections;
+	if (!read_dwarf_sections(b.abfd, sections) || !lines.build(sections)) {
+		cverb << vbfd << "no line index for " << filename
+		      << ", using bfd_find_nearest_line()" << endl;
+		return line_index_ok.reset(false);
+	}
+
+	cache_line_index();
+	return line_index_ok.reset(true);
+}
+
+
+bool op_bfd::get_cached_line_index() const
+{
+	if (cache_key.path.empty())
+		return false;
+
+	symbol_cache_file cache(cache_key, cache_lines);
+	if (!cache.valid())
+		return false;
+
+	// the entry must come from the debug file we use
+	if (cache.debug_filename() != (dbfd.valid() ? debug_filename : ""))
+		return false;
+
+	vector<line_index::entry> entries(cache.size());
+	vector<string> files;
+	map<u32, u32> file_ids;
+	for (size_t i = 0; i < cache.size(); ++i) {
+		line_cache_record const & record = cache.line(i);
+		entries[i].address = record.address;
+		entries[i].line = record.line;
+		entries[i].file = line_index::no_file;
+		if (!record.file)
+			continue;
+
+		map<u32, u32>::const_iterator it = file_ids.find(record.file);
+		if (it == file_ids.end()) {
+			it = file_ids.insert(make_pair(record.file,
+			                               u32(files.size()))).first;
+			files.push_back(cache.name(record));
+		}
+		entries[i].file = it->second;
+	}
+
+	lines.assign(entries, files);
+	cverb << vbfd << "line cache hit for " << cache_key.path << endl;
+	timings::count("line cache hits");
+	return true;
+}
+
+
+void op_bfd::cache_line_index() const
+{
+	if (cache_key.path.empty() || get_symbol_cache_dir().empty())
+		return;
+
+	symbol_cache_writer writer(cache_key, cache_lines);
+	if (dbfd.valid())
+		writer.set_debug_filename(debug_filename);
+
+	vector<line_index::entry> const & entries = lines.get_entries();
+	vector<string> const & files = lines.get_files();
+	for (size_t i = 0; i < entries.size(); ++i) {
+		line_cache_record record;
+		memset(&record, 0, sizeof(record));
+		record.address = entries[i].address;
+		record.line = entries[i].line;
+		writer.add(record, entries[i].file == line_index::no_file
+		                   ? string() : files[entries[i].file]);
+	}
+
+	if (!writer.commit())
+		cverb << vbfd << "can't write line cache for "
+		      << cache_key.path << endl;
+}
+
+
 void op_bfd::add_symbols(op_bfd::symbols_found_t & symbols,
                          string_filter const & symbol_filter)
 {
@@ -295,6 +546,7 @@ void op_bfd::add_symbols(op_bfd::symbols_found_t & symbols,
 
 	cverb << vbfd << "number of symbols now "
 	      << dec << syms.size() << hex << endl;
+	timings::count("symbols read", syms.size());
 }
 
 
@@ -329,7 +581,8 @@ get_symbol_contents(symbol_index_t sym_index, unsigned char * contents) const
 	op_bfd_symbol const & bfd_sym = syms[sym_index];
 	size_t size = bfd_sym.size();
 
-	if (!bfd_get_section_contents(ibfd.abfd, bfd_sym.symbol()->section, 
+	asection * section = const_cast<asection *>(bfd_sym.section());
+	if (!bfd_get_section_contents(ibfd.abfd, section, 
 				 contents, 
 				 static_cast<file_ptr>(bfd_sym.value()), size)) {
 		return false;
@@ -371,8 +624,29 @@ bool op_bfd::get_linenr(symbol_index_t sym_idx, bfd_vma offset,
 	if (!has_debug_info())
 		return false;
 
+	// entered per sample, no memory snapshot
+	scoped_timer timer("debug line lookup", false);
+	timings::count("line lookups");
+
 	bfd_info const & b = dbfd.valid() ? dbfd : ibfd;
 	op_bfd_symbol const & sym = syms[sym_idx];
+	asection const * section = sym.section();
+
+	// same pc as find_nearest_line(), entries with line 0 or outside
+	// the line tables are left to bfd which may know better
+	if (section && has_line_index()) {
+		bfd_vma const pc = anon_obj ? offset - section->vma
+			: (sym.value() + offset) - sym.filepos();
+		if ((bfd_get_section_flags(b.abfd, section) & SEC_ALLOC) &&
+		    pc < bfd_section_size(b.abfd, section) &&
+		    lines.find(section->vma + pc, source_filename, linenr) &&
+		    linenr) {
+			timings::count("line index hits");
+			return true;
+		}
+	}
+
+	read_symbol_tables();
 
 	linenr_info const info = find_nearest_line(b, sym, offset, anon_obj);
 
@@ -423,10 +697,10 @@ void op_bfd::get_symbol_range(symbol_index_t sym_idx,
 	cverb << (vbfd & vlevel1)
 	      << "start " << hex << start << ", end " << end << endl;
 
-	if (sym.symbol()) {
+	if (sym.section()) {
 		cverb << (vbfd & vlevel1) << "in section "
-		      << sym.symbol()->section->name << ", filepos "
-		      << hex << sym.symbol()->section->filepos << endl;
+		      << sym.section()->name << ", filepos "
+		      << hex << sym.section()->filepos << endl;
 	}
 }
 
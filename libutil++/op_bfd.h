@@ -25,6 +25,8 @@
 #include "utility.h"
 #include "cached_value.h"
 #include "op_types.h"
+#include "symbol_cache.h"
+#include "line_index.h"
 
 class op_bfd;
 class string_filter;
@@ -47,13 +49,16 @@ public:
 	/// ctor for artificial symbols
 	op_bfd_symbol(bfd_vma vma, size_t size, std::string const & name);
 
+	/// ctor for symbols read from the symbol cache
+	op_bfd_symbol(asection const * section,
+	              symbol_cache_record const & record, char const * name);
+
 	bfd_vma vma() const { return symb_value + section_vma; }
 	unsigned long value() const { return symb_value; }
 	unsigned long filepos() const { return symb_value + section_filepos; }
 	unsigned long symbol_endpos(void) const;
-	asection const * section(void) const { return bfd_symbol->section; }
+	asection const * section(void) const { return bfd_section; }
 	std::string const & name() const { return symb_name; }
-	asymbol const * symbol() const { return bfd_symbol; }
 	size_t size() const { return symb_size; }
 	void size(size_t s) { symb_size = s; }
 	bool hidden() const { return symb_hidden; }
@@ -64,9 +69,8 @@ public:
 	bool operator<(op_bfd_symbol const & lhs) const;
 
 private:
-	/// the original bfd symbol, this can be null if the symbol is an
-	/// artificial symbol
-	asymbol const * bfd_symbol;
+	/// the section of the symbol, null for an artificial symbol
+	asection const * bfd_section;
 	/// the offset of this symbol relative to the begin of the section's
 	/// symbol
 	unsigned long symb_value;
@@ -227,6 +231,32 @@ private:
 	 */
 	void get_symbols(symbols_found_t & symbols);
 
+	/**
+	 * Get the symbols from the symbol cache entry for key. Return
+	 * false if there is no usable entry.
+	 */
+	bool get_cached_symbols(symbol_cache_key const & key,
+	                        symbols_found_t & symbols);
+
+	/// save the symbols found by get_symbols() in the symbol cache
+	void cache_symbols(symbol_cache_key const & key,
+	                   symbols_found_t const & symbols) const;
+
+	/// read the bfd symbol tables if get_symbols() didn't
+	void read_symbol_tables() const;
+
+	/**
+	 * Load the line index from the symbol cache or build it on first
+	 * use. Return false if get_linenr() must use bfd instead.
+	 */
+	bool has_line_index() const;
+
+	/// get the line index from the symbol cache
+	bool get_cached_line_index() const;
+
+	/// save the line index in the symbol cache
+	void cache_line_index() const;
+
 	/**
 	 * Helper function for get_symbols.
 	 * Populates bfd_syms and extracts the "interesting_symbol"s.
@@ -276,12 +306,25 @@ private:
 	/// true if at least one section has (flags & SEC_DEBUGGING) != 0
 	mutable cached_value<bool> debug_info;
 
-	/// our main bfd object: .bfd may be NULL
-	bfd_info ibfd;
+	/// our main bfd object: .bfd may be NULL, mutable as the symbol
+	/// table is read on demand when the symbols come from the cache
+	mutable bfd_info ibfd;
 
 	// corresponding debug bfd object, if one is found
 	mutable bfd_info dbfd;
 
+	/// true once the symbol tables of ibfd and dbfd are read
+	mutable bool symbol_tables_read;
+
+	/// symbol cache key of the image, empty path if it isn't cached
+	symbol_cache_key cache_key;
+
+	/// source lines of the image or of its debug file
+	mutable line_index lines;
+
+	/// true if lines can be used, set by has_line_index()
+	mutable cached_value<bool> line_index_ok;
+
 	/// sections we will avoid to use symbol from, this is needed
 	/// because elf file allows sections with identical vma and we can't
 	/// allow overlapping symbols. Such elf layout is used actually by
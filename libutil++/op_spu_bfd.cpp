@@ -45,6 +45,7 @@ op_bfd::op_bfd(uint64_t spu_offset, string const & fname,
 	archive_path(extra_images.get_archive_path()),
 	extra_found_images(extra_images),
 	file_size(-1),
+	symbol_tables_read(false),
 	embedding_filename(fname),
 	anon_obj(false)
 {
@@ -0,0 +1,127 @@
+/**
+ * @file small_array.h
+ * Auto-expanding array type with inline storage
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * The first N elements live in the object itself and the arithmetic on
+ * them has a constant trip count the compiler can vectorize, elements
+ * past N spill to a heap allocated vector.
+ */
+
+#ifndef SMALL_ARRAY_H
+#define SMALL_ARRAY_H
+
+#include <cstddef>
+#include <vector>
+
+template <typename T, std::size_t N = 8> class small_array {
+public:
+	typedef std::vector<T> container_type;
+	typedef typename container_type::size_type size_type;
+
+	small_array() : nr_elements(0) {
+		for (size_type i = 0; i < N; ++i)
+			inline_elements[i] = T();
+	}
+
+
+	/**
+	 * Index into the array for a value. An out of bounds index will
+	 * return a default-constructed value.
+	 */
+	T operator[](size_type index) const {
+		if (index >= nr_elements)
+			return T();
+		return index < N ? inline_elements[index] : spill[index - N];
+	}
+
+
+	/**
+	 * Index into the array for a value. If the index is larger than
+	 * the current max index, the array is expanded, default-filling
+	 * any intermediary gaps.
+	 */
+	T & operator[](size_type index) {
+		if (index >= nr_elements)
+			grow(index + 1);
+		return index < N ? inline_elements[index] : spill[index - N];
+	}
+
+
+	/**
+	 * vectorized += operator
+	 */
+	small_array & operator+=(small_array const & rhs) {
+		if (rhs.nr_elements > nr_elements)
+			grow(rhs.nr_elements);
+
+		// elements past nr_elements are zero so the whole inline
+		// part can be added
+		for (size_type i = 0; i < N; ++i)
+			inline_elements[i] += rhs.inline_elements[i];
+
+		for (size_type i = 0; i < rhs.spill.size(); ++i)
+			spill[i] += rhs.spill[i];
+
+		return *this;
+	}
+
+
+	/**
+	 * vectorized -= operator, overflow shouldn't occur during substraction
+	 * (iow: for each components lhs[i] >= rhs[i]
+	 */
+	small_array & operator-=(small_array const & rhs) {
+		if (rhs.nr_elements > nr_elements)
+			grow(rhs.nr_elements);
+
+		for (size_type i = 0; i < N; ++i)
+			inline_elements[i] -= rhs.inline_elements[i];
+
+		for (size_type i = 0; i < rhs.spill.size(); ++i)
+			spill[i] -= rhs.spill[i];
+
+		return *this;
+	}
+
+
+	/**
+	 * return the maximum index of the array + 1 or 0 if the array
+	 * is empty.
+	 */
+	size_type size() const {
+		return nr_elements;
+	}
+
+
+	/// return true if all elements have the default constructed value
+	bool zero() const {
+		for (size_type i = 0; i < N; ++i) {
+			if (inline_elements[i] != T())
+				return false;
+		}
+		for (size_type i = 0; i < spill.size(); ++i) {
+			if (spill[i] != T())
+				return false;
+		}
+		return true;
+	}
+
+private:
+	void grow(size_type size) {
+		nr_elements = size;
+		if (size > N)
+			spill.resize(size - N);
+	}
+
+	/// max index + 1
+	size_type nr_elements;
+	/// elements [0, N), zero past nr_elements
+	T inline_elements[N];
+	/// elements [N, nr_elements)
+	container_type spill;
+};
+
+#endif // SMALL_ARRAY_H
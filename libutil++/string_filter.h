@@ -45,6 +45,9 @@ public:
 	/// Returns true if the given string matches
 	virtual bool match(std::string const & str) const;
 
+	/// Returns true if the filter has no include nor exclude pattern
+	bool match_all() const { return include.empty() && exclude.empty(); }
+
 protected:
 	/// include patterns
 	std::vector<std::string> include;
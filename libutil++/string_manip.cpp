@@ -12,7 +12,9 @@
 #include <sstream>
 #include <iomanip>
 
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
 
 #include "string_manip.h"
@@ -103,34 +105,57 @@ string trim(string const & str, string const & totrim)
 }
 
 
+size_t hash_string(string const & str)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < str.length(); ++i) {
+		hash ^= (unsigned char)str[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash ^ (hash >> 32);
+}
+
+
 string const
 format_percent(double value, size_t int_width, size_t fract_width, bool showpos)
 {
-	ostringstream os;
+	string formatted;
+	append_percent(formatted, value, int_width, fract_width, showpos);
+	return formatted;
+}
 
-	if (value == 0.0)
-		return string(int_width + fract_width, ' ') + "0";
 
-	if (showpos)
-		os.setf(ios::showpos);
+void append_percent(string & out, double value, size_t int_width,
+                    size_t fract_width, bool showpos)
+{
+	if (value == 0.0) {
+		out.append(int_width + fract_width, ' ');
+		out += '0';
+		return;
+	}
 
+	// the conversions iostream does for fixed and scientific formats,
+	// without building a stream for each value. The largest double
+	// is 309 digits long in fixed format.
+	char buf[512];
+	int const width = int_width + fract_width + 1;
+	int len;
 	if (fabs(value) > .001) {
-		// os << fixed << value unsupported by gcc 2.95
-		os.setf(ios::fixed, ios::floatfield);
-		os << setw(int_width + fract_width + 1)
-		   << setprecision(fract_width) << value;
+		len = snprintf(buf, sizeof(buf), showpos ? "%+*.*f" : "%*.*f",
+		               width, int(fract_width), value);
 	} else {
-		// os << scientific << value unsupported by gcc 2.95
-		os.setf(ios::scientific, ios::floatfield);
-		os << setw(int_width + fract_width + 1)
-		   // - 3 to count exponent part
-		   << setprecision(fract_width - 3) << value;
+		// - 3 to count exponent part
+		len = snprintf(buf, sizeof(buf), showpos ? "%+*.*e" : "%*.*e",
+		               width, int(fract_width - 3), value);
 	}
 
-	string formatted = os.str();
-	if (is_prefix(formatted, "100."))
-		formatted.erase(formatted.size() - 1);
-	return formatted;
+	if (len < 0)
+		return;
+	if (size_t(len) >= sizeof(buf))
+		len = sizeof(buf) - 1;
+	if (len >= 4 && !strncmp(buf, "100.", 4))
+		--len;
+	out.append(buf, len);
 }
 
 
@@ -52,6 +52,9 @@ std::string rtrim(std::string const & str, std::string const & totrim = "\t ");
 /// ltrim(rtrim(str))
 std::string trim(std::string const & str, std::string const & totrim = "\t ");
 
+/// FNV-1a hash of str
+std::size_t hash_string(std::string const & str);
+
 /**
  * format_percent - smart format of double percentage value
  * @param value - the value
@@ -69,6 +72,10 @@ std::string const
 format_percent(double value, size_t int_width,
                size_t frac_width, bool showpos = false);
 
+/// as format_percent() but append the result to out
+void append_percent(std::string & out, double value, size_t int_width,
+                    size_t frac_width, bool showpos = false);
+
 /// prefered width to format percentage
 static unsigned int const percent_int_width = 2;
 static unsigned int const percent_fract_width = 4;
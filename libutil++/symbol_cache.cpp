@@ -0,0 +1,472 @@
+/**
+ * @file symbol_cache.cpp
+ * On-disk cache of the symbol tables and line indexes built by op_bfd
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <sstream>
+#include <iomanip>
+
+#include "op_file.h"
+
+#include "symbol_cache.h"
+#include "file_manip.h"
+
+using namespace std;
+
+namespace {
+
+u32 const cache_version = 2;
+
+/// layout of the start of a cache entry
+struct cache_header {
+	char magic[4];
+	u32 version;
+	u64 image_size;
+	u64 image_mtime;
+	u64 debug_size;
+	u64 debug_mtime;
+	u64 debug_stamp;
+	u32 nr_records;
+	u32 strings_size;
+	/// offsets in the string table
+	u32 path;
+	u32 build_id;
+	u32 debug_filename;
+	/// a symbol_cache_kind
+	u32 kind;
+};
+
+string cache_dir;
+bool cache_dir_set;
+
+
+size_t record_size(u32 kind)
+{
+	return kind == cache_lines ? sizeof(line_cache_record)
+		: sizeof(symbol_cache_record);
+}
+
+
+/// the string offset of a record
+u32 record_string(char const * record, u32 kind)
+{
+	if (kind == cache_lines)
+		return reinterpret_cast<line_cache_record const *>(record)->file;
+	return reinterpret_cast<symbol_cache_record const *>(record)->name;
+}
+
+
+u64 const fnv_basis = 14695981039346656037ULL;
+
+/// FNV-1a hash of size bytes at data
+u64 fnv_hash(u64 hash, void const * data, size_t size)
+{
+	unsigned char const * p = static_cast<unsigned char const *>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+/// the entry file name for an image, a hash of its path
+string entry_filename(string const & dir, string const & path,
+                      symbol_cache_kind kind)
+{
+	u64 const hash = fnv_hash(fnv_basis, path.data(), path.length());
+
+	ostringstream os;
+	os << dir << '/' << hex << setfill('0') << setw(16) << hash;
+	if (kind == cache_lines)
+		os << ".lines";
+	return os.str();
+}
+
+
+bool get_file_stat(char const * file, u64 & size, u64 & mtime)
+{
+	struct stat st;
+	if (stat(file, &st))
+		return false;
+	size = st.st_size;
+	mtime = st.st_mtime;
+	return true;
+}
+
+
+void * map_entry(string const & file, size_t & length)
+{
+	int fd = open(file.c_str(), O_RDONLY);
+	if (fd == -1)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) || size_t(st.st_size) < sizeof(cache_header)) {
+		close(fd);
+		return 0;
+	}
+
+	void * base = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return 0;
+
+	length = st.st_size;
+	return base;
+}
+
+
+/**
+ * Return true if the mapped entry is well formed and up to date. If key
+ * is NULL the image is only checked against the recorded size and mtime
+ * and the entry can be of any kind.
+ */
+bool check_entry(void const * base, size_t length,
+                 symbol_cache_key const * key, symbol_cache_kind kind)
+{
+	cache_header const * header = static_cast<cache_header const *>(base);
+	if (memcmp(header->magic, "OPSC", 4) ||
+	    header->version != cache_version ||
+	    header->kind > cache_lines || (key && header->kind != u32(kind)))
+		return false;
+
+	u64 const records_size =
+		u64(header->nr_records) * record_size(header->kind);
+	if (sizeof(cache_header) + records_size + header->strings_size
+	    != length)
+		return false;
+
+	char const * strings = static_cast<char const *>(base) + length
+		- header->strings_size;
+	if (!header->strings_size || strings[header->strings_size - 1])
+		return false;
+
+	if (header->path >= header->strings_size ||
+	    header->build_id >= header->strings_size ||
+	    header->debug_filename >= header->strings_size)
+		return false;
+
+	char const * record = reinterpret_cast<char const *>(header + 1);
+	for (u32 i = 0; i < header->nr_records; ++i) {
+		if (record_string(record, header->kind) >= header->strings_size)
+			return false;
+		record += record_size(header->kind);
+	}
+
+	u64 size, mtime;
+	if (key) {
+		if (key->path != strings + header->path ||
+		    key->build_id != strings + header->build_id ||
+		    key->debug_stamp != header->debug_stamp)
+			return false;
+		size = key->size;
+		mtime = key->mtime;
+	} else if (!get_file_stat(strings + header->path, size, mtime)) {
+		return false;
+	}
+
+	if (size != header->image_size || mtime != header->image_mtime)
+		return false;
+
+	if (!header->debug_filename)
+		return true;
+
+	if (!get_file_stat(strings + header->debug_filename, size, mtime))
+		return false;
+
+	return size == header->debug_size && mtime == header->debug_mtime;
+}
+
+
+list<string> entry_list()
+{
+	list<string> files;
+	string const & dir = get_symbol_cache_dir();
+	if (!dir.empty())
+		create_file_list(files, dir);
+
+	for (list<string>::iterator it = files.begin(); it != files.end(); ++it)
+		*it = dir + '/' + *it;
+
+	return files;
+}
+
+}  // anonymous namespace
+
+
+symbol_cache_file::symbol_cache_file(symbol_cache_key const & key,
+                                     symbol_cache_kind kind)
+	: base(0), length(0)
+{
+	string const & dir = get_symbol_cache_dir();
+	if (dir.empty())
+		return;
+
+	base = map_entry(entry_filename(dir, key.path, kind), length);
+	if (base && !check_entry(base, length, &key, kind))
+		unmap();
+}
+
+
+symbol_cache_file::~symbol_cache_file()
+{
+	unmap();
+}
+
+
+void symbol_cache_file::unmap()
+{
+	if (base)
+		munmap(base, length);
+	base = 0;
+	length = 0;
+}
+
+
+size_t symbol_cache_file::size() const
+{
+	return static_cast<cache_header const *>(base)->nr_records;
+}
+
+
+void const * symbol_cache_file::records() const
+{
+	return static_cast<cache_header const *>(base) + 1;
+}
+
+
+symbol_cache_record const & symbol_cache_file::operator[](size_t i) const
+{
+	return static_cast<symbol_cache_record const *>(records())[i];
+}
+
+
+line_cache_record const & symbol_cache_file::line(size_t i) const
+{
+	return static_cast<line_cache_record const *>(records())[i];
+}
+
+
+char const * symbol_cache_file::get_string(u32 offset) const
+{
+	cache_header const * header = static_cast<cache_header const *>(base);
+	if (offset >= header->strings_size)
+		return 0;
+	return static_cast<char const *>(base) + length
+		- header->strings_size + offset;
+}
+
+
+char const * symbol_cache_file::name(symbol_cache_record const & record) const
+{
+	return get_string(record.name);
+}
+
+
+char const * symbol_cache_file::name(line_cache_record const & record) const
+{
+	return get_string(record.file);
+}
+
+
+string symbol_cache_file::debug_filename() const
+{
+	cache_header const * header = static_cast<cache_header const *>(base);
+	return get_string(header->debug_filename);
+}
+
+
+symbol_cache_writer::symbol_cache_writer(symbol_cache_key const & k,
+                                         symbol_cache_kind t)
+	: key(k), kind(t), nr_records(0), strings(1, '\0')
+{
+}
+
+
+void symbol_cache_writer::set_debug_filename(string const & name)
+{
+	debug_filename = name;
+}
+
+
+u32 symbol_cache_writer::add_string(string const & str)
+{
+	if (str.empty())
+		return 0;
+
+	// line entries repeat a few file names many times
+	map<string, u32>::const_iterator it = string_offsets.find(str);
+	if (it != string_offsets.end())
+		return it->second;
+
+	u32 offset = strings.length();
+	strings.append(str.c_str(), str.length() + 1);
+	string_offsets[str] = offset;
+	return offset;
+}
+
+
+void symbol_cache_writer::add_record(void const * record, size_t size)
+{
+	char const * p = static_cast<char const *>(record);
+	records.insert(records.end(), p, p + size);
+	++nr_records;
+}
+
+
+void symbol_cache_writer::add(symbol_cache_record const & record,
+                              string const & name)
+{
+	symbol_cache_record r = record;
+	r.name = add_string(name);
+	add_record(&r, sizeof(r));
+}
+
+
+void symbol_cache_writer::add(line_cache_record const & record,
+                              string const & file)
+{
+	line_cache_record r = record;
+	r.file = add_string(file);
+	add_record(&r, sizeof(r));
+}
+
+
+bool symbol_cache_writer::commit()
+{
+	string const & dir = get_symbol_cache_dir();
+	if (dir.empty())
+		return false;
+
+	cache_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "OPSC", 4);
+	header.version = cache_version;
+	header.image_size = key.size;
+	header.image_mtime = key.mtime;
+	header.debug_stamp = key.debug_stamp;
+	header.kind = kind;
+	header.nr_records = nr_records;
+	header.path = add_string(key.path);
+	header.build_id = add_string(key.build_id);
+	if (!debug_filename.empty()) {
+		if (!get_file_stat(debug_filename.c_str(), header.debug_size,
+		                   header.debug_mtime))
+			return false;
+		header.debug_filename = add_string(debug_filename);
+	}
+	header.strings_size = strings.length();
+
+	string const file = entry_filename(dir, key.path, kind);
+	if (create_path(file.c_str()))
+		return false;
+
+	vector<char> tmp(file.begin(), file.end());
+	char const suffix[] = ".XXXXXX";
+	tmp.insert(tmp.end(), suffix, suffix + sizeof(suffix));
+	int fd = mkstemp(&tmp[0]);
+	if (fd == -1)
+		return false;
+
+	FILE * out = fdopen(fd, "w");
+	if (!out) {
+		close(fd);
+		unlink(&tmp[0]);
+		return false;
+	}
+
+	bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+	if (ok && !records.empty())
+		ok = fwrite(&records[0], records.size(), 1, out) == 1;
+	ok = ok && fwrite(strings.data(), strings.length(), 1, out) == 1;
+	ok = !fclose(out) && ok;
+
+	if (!ok || rename(&tmp[0], file.c_str())) {
+		unlink(&tmp[0]);
+		return false;
+	}
+
+	return true;
+}
+
+
+u64 symbol_cache_stamp(vector<string> const & files)
+{
+	u64 hash = fnv_basis;
+	for (size_t i = 0; i < files.size(); ++i) {
+		u64 st[2] = { u64(-1), u64(-1) };
+		get_file_stat(files[i].c_str(), st[0], st[1]);
+		hash = fnv_hash(hash, files[i].c_str(), files[i].length() + 1);
+		hash = fnv_hash(hash, st, sizeof(st));
+	}
+	return hash;
+}
+
+
+void set_symbol_cache_dir(string const & dir)
+{
+	cache_dir = dir;
+	cache_dir_set = true;
+}
+
+
+string const & get_symbol_cache_dir()
+{
+	if (!cache_dir_set) {
+		char const * home = getenv("HOME");
+		if (home)
+			cache_dir = string(home) + "/.oprofile/symbol_cache";
+		cache_dir_set = true;
+	}
+	return cache_dir;
+}
+
+
+size_t clear_symbol_cache()
+{
+	list<string> const files = entry_list();
+	size_t nr_removed = 0;
+
+	list<string>::const_iterator it;
+	for (it = files.begin(); it != files.end(); ++it) {
+		if (!unlink(it->c_str()))
+			++nr_removed;
+	}
+
+	return nr_removed;
+}
+
+
+size_t gc_symbol_cache()
+{
+	list<string> const files = entry_list();
+	size_t nr_removed = 0;
+
+	list<string>::const_iterator it;
+	for (it = files.begin(); it != files.end(); ++it) {
+		size_t length;
+		void * base = map_entry(*it, length);
+		bool const usable = base && check_entry(base, length, 0,
+		                                          cache_symbols);
+		if (base)
+			munmap(base, length);
+		if (!usable && !unlink(it->c_str()))
+			++nr_removed;
+	}
+
+	return nr_removed;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file symbol_cache.h
+ * On-disk cache of the symbol tables built by op_bfd
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * Reading the symbols of a big binary with BFD is slow, so op_bfd saves
+ * its final symbol list in a cache entry per image, and its line number
+ * index in a second one. An entry is a single file mapped read-only by
+ * the next tool run: a header, fixed size records and the string table.
+ *
+ * An entry is used only if the size, mtime and build-id of the image,
+ * the size and mtime of the separate debug file the symbols were read
+ * from and the state of all the places a debug file is looked for still
+ * match, so installing or removing a debug file invalidates the entry.
+ */
+
+#ifndef SYMBOL_CACHE_H
+#define SYMBOL_CACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "op_types.h"
+
+/// identity of the image a cache entry describes
+struct symbol_cache_key {
+	/// full path of the image
+	std::string path;
+	/// image size
+	u64 size;
+	/// image mtime
+	u64 mtime;
+	/// hexadecimal build-id, empty if the image has none
+	std::string build_id;
+	/// symbol_cache_stamp() of the candidate separate debug files
+	u64 debug_stamp;
+};
+
+/// what a cache entry holds
+enum symbol_cache_kind {
+	/// symbol_cache_record in op_bfd order
+	cache_symbols,
+	/// line_cache_record of a line_index
+	cache_lines
+};
+
+/// the symbol was read from the separate debug file
+#define SYMBOL_CACHE_DEBUG	0x1
+#define SYMBOL_CACHE_HIDDEN	0x2
+#define SYMBOL_CACHE_WEAK	0x4
+
+/// one op_bfd_symbol as stored in a cache entry
+struct symbol_cache_record {
+	u64 value;
+	u64 section_filepos;
+	u64 section_vma;
+	u64 size;
+	/// offset of the name in the string table
+	u32 name;
+	/// index of the symbol section in its bfd
+	u32 section_index;
+	/// SYMBOL_CACHE_* flags
+	u32 flags;
+	u32 reserved;
+};
+
+/// one line_index entry as stored in a cache entry
+struct line_cache_record {
+	u64 address;
+	/// offset of the file name in the string table, 0 at the end of
+	/// a sequence
+	u32 file;
+	u32 line;
+};
+
+
+/**
+ * A cache entry mapped in memory. valid() is false if there is no up to
+ * date entry for the key.
+ */
+class symbol_cache_file {
+public:
+	explicit symbol_cache_file(symbol_cache_key const & key,
+	                           symbol_cache_kind kind = cache_symbols);
+	~symbol_cache_file();
+
+	bool valid() const { return base; }
+
+	/// number of records
+	size_t size() const;
+
+	/// the records of a cache_symbols entry
+	symbol_cache_record const & operator[](size_t i) const;
+
+	/// the records of a cache_lines entry
+	line_cache_record const & line(size_t i) const;
+
+	/// the name of a symbol
+	char const * name(symbol_cache_record const & record) const;
+
+	/// the file name of a line, empty at the end of a sequence
+	char const * name(line_cache_record const & record) const;
+
+	/// the debug file the symbols were read from or an empty string
+	std::string debug_filename() const;
+
+private:
+	/// get a string from the string table, NULL if out of bounds
+	char const * get_string(u32 offset) const;
+
+	void unmap();
+
+	/// the first record
+	void const * records() const;
+
+	void * base;
+	size_t length;
+
+	symbol_cache_file(symbol_cache_file const &);
+	symbol_cache_file & operator=(symbol_cache_file const &);
+};
+
+
+/**
+ * Build a cache entry. Nothing touches the disk before commit().
+ */
+class symbol_cache_writer {
+public:
+	explicit symbol_cache_writer(symbol_cache_key const & key,
+	                             symbol_cache_kind kind = cache_symbols);
+
+	/// the debug file the entry is built from, default none
+	void set_debug_filename(std::string const & name);
+
+	/// add a symbol, the name field of record is ignored
+	void add(symbol_cache_record const & record, std::string const & name);
+
+	/// add a line, the file field of record is ignored
+	void add(line_cache_record const & record, std::string const & file);
+
+	/**
+	 * Write the entry, replacing atomically any entry for the same
+	 * image. Return false on failure, which is harmless as the entry
+	 * is rebuilt on the next run.
+	 */
+	bool commit();
+
+private:
+	/// add a string to the string table and return its offset
+	u32 add_string(std::string const & str);
+
+	/// append a record
+	void add_record(void const * record, size_t size);
+
+	symbol_cache_key key;
+	symbol_cache_kind kind;
+	std::string debug_filename;
+	std::vector<char> records;
+	u32 nr_records;
+	std::string strings;
+	std::map<std::string, u32> string_offsets;
+};
+
+
+/**
+ * Return a hash of the path and of the size and mtime of each file, or
+ * of its absence, to detect a file appearing, changing or disappearing.
+ */
+u64 symbol_cache_stamp(std::vector<std::string> const & files);
+
+/**
+ * Set the directory holding the cache entries, an empty name disables
+ * the cache. The default is $HOME/.oprofile/symbol_cache, or no cache if
+ * HOME is not set.
+ */
+void set_symbol_cache_dir(std::string const & dir);
+
+/// return the cache directory, empty if disabled
+std::string const & get_symbol_cache_dir();
+
+/// remove all the cache entries, return the number of entries removed
+size_t clear_symbol_cache();
+
+/**
+ * Remove the unusable cache entries: entries for images or debug files
+ * which changed or disappeared and corrupted entries. Return the number
+ * of entries removed.
+ */
+size_t gc_symbol_cache();
+
+#endif /* !SYMBOL_CACHE_H */
@@ -0,0 +1,545 @@
+/**
+ * @file line_index_tests.cpp
+ * tests line_index.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <elf.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "line_index.h"
+#include "op_file.h"
+
+using namespace std;
+
+namespace {
+
+typedef vector<unsigned char> section_t;
+
+void put(section_t & s, u64 value, size_t size)
+{
+	for (size_t i = 0; i < size; ++i)
+		s.push_back(value >> (i * 8));
+}
+
+
+void uleb(section_t & s, u64 value)
+{
+	do {
+		unsigned char byte = value & 0x7f;
+		value >>= 7;
+		s.push_back(value ? byte | 0x80 : byte);
+	} while (value);
+}
+
+
+void sleb(section_t & s, long long value)
+{
+	bool more = true;
+	while (more) {
+		unsigned char byte = value & 0x7f;
+		value >>= 7;
+		more = !((value == 0 && !(byte & 0x40)) ||
+		         (value == -1 && (byte & 0x40)));
+		s.push_back(more ? byte | 0x80 : byte);
+	}
+}
+
+
+void str(section_t & s, string const & value)
+{
+	s.insert(s.end(), value.begin(), value.end());
+	s.push_back(0);
+}
+
+
+/// patch the 4 bytes length at pos to cover the end of s
+void end_unit(section_t & s, size_t pos)
+{
+	u64 length = s.size() - pos - 4;
+	for (size_t i = 0; i < 4; ++i)
+		s[pos + i] = length >> (i * 8);
+}
+
+
+void set_address(section_t & s, u64 address)
+{
+	s.push_back(0);
+	uleb(s, 9);
+	s.push_back(2);
+	put(s, address, 8);
+}
+
+
+void end_sequence(section_t & s)
+{
+	s.push_back(0);
+	uleb(s, 1);
+	s.push_back(1);
+}
+
+
+void line_header_fields(section_t & s)
+{
+	s.push_back(1);		// minimum_instruction_length
+	s.push_back(1);		// maximum_operations_per_instruction
+	s.push_back(1);		// default_is_stmt
+	s.push_back(0xfb);	// line_base -5
+	s.push_back(14);	// line_range
+	s.push_back(13);	// opcode_base
+	unsigned char const lengths[] = { 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1 };
+	s.insert(s.end(), lengths, lengths + sizeof(lengths));
+}
+
+
+/// a DWARF 4 line table
+void line_table_v4(section_t & s)
+{
+	size_t const start = s.size();
+	put(s, 0, 4);
+	put(s, 4, 2);
+	size_t const header = s.size();
+	put(s, 0, 4);
+	line_header_fields(s);
+	str(s, "src");
+	str(s, "/usr/include");
+	str(s, "");
+	str(s, "a.c");
+	uleb(s, 1); uleb(s, 0); uleb(s, 0);
+	str(s, "stdio.h");
+	uleb(s, 2); uleb(s, 0); uleb(s, 0);
+	str(s, "/abs/b.c");
+	uleb(s, 0); uleb(s, 0); uleb(s, 0);
+	str(s, "c.c");
+	uleb(s, 0); uleb(s, 0); uleb(s, 0);
+	str(s, "");
+	end_unit(s, header);
+
+	set_address(s, 0x1000);
+	s.push_back(3); sleb(s, 9);		// line 10
+	s.push_back(1);				// 0x1000 a.c:10
+	s.push_back(13 + (1 + 5) + 14 * 4);	// 0x1004 a.c:11
+	s.push_back(4); uleb(s, 2);
+	s.push_back(2); uleb(s, 8);
+	s.push_back(1);				// 0x100c stdio.h:11
+	s.push_back(4); uleb(s, 3);
+	s.push_back(9); put(s, 4, 2);
+	s.push_back(1);				// 0x1010 b.c:11
+	s.push_back(4); uleb(s, 4);
+	s.push_back(3); sleb(s, -11);
+	s.push_back(1);				// 0x1010 c.c:0 replaces it
+	s.push_back(2); uleb(s, 0x10);
+	end_sequence(s);			// 0x1020
+
+	set_address(s, 0x2000);
+	s.push_back(3); sleb(s, 19);
+	s.push_back(1);				// 0x2000 a.c:20
+	s.push_back(2); uleb(s, 8);
+	end_sequence(s);
+
+	// overlaps the second sequence, both are left to bfd
+	set_address(s, 0x2006);
+	s.push_back(1);
+	s.push_back(2); uleb(s, 4);
+	end_sequence(s);
+
+	end_unit(s, start);
+}
+
+
+/// a DWARF 5 line table with its strings in line_str
+void line_table_v5(section_t & s, section_t & line_str)
+{
+	size_t const start = s.size();
+	put(s, 0, 4);
+	put(s, 5, 2);
+	s.push_back(8);		// address_size
+	s.push_back(0);		// segment_selector_size
+	size_t const header = s.size();
+	put(s, 0, 4);
+	line_header_fields(s);
+
+	s.push_back(1);
+	uleb(s, 1); uleb(s, 0x1f);	// DW_LNCT_path, DW_FORM_line_strp
+	uleb(s, 2);
+	put(s, line_str.size(), 4);
+	str(line_str, "/build5");
+	put(s, line_str.size(), 4);
+	str(line_str, "inc");
+
+	s.push_back(2);
+	uleb(s, 1); uleb(s, 0x1f);
+	uleb(s, 2); uleb(s, 0x0f);	// DW_LNCT_directory_index, udata
+	uleb(s, 2);
+	put(s, line_str.size(), 4);
+	str(line_str, "x.c");
+	uleb(s, 0);
+	put(s, line_str.size(), 4);
+	str(line_str, "y.h");
+	uleb(s, 1);
+	end_unit(s, header);
+
+	set_address(s, 0x3000);
+	s.push_back(4); uleb(s, 0);
+	s.push_back(1);			// 0x3000 x.c:1
+	s.push_back(2); uleb(s, 2);
+	s.push_back(4); uleb(s, 1);
+	s.push_back(3); sleb(s, 4);
+	s.push_back(1);			// 0x3002 y.h:5
+	s.push_back(2); uleb(s, 2);
+	end_sequence(s);
+
+	end_unit(s, start);
+}
+
+
+/// a compilation unit using the line table at stmt_list
+void unit(section_t & info, unsigned int version, u64 stmt_list)
+{
+	size_t const start = info.size();
+	put(info, 0, 4);
+	put(info, version, 2);
+	if (version == 5) {
+		info.push_back(1);	// DW_UT_compile
+		info.push_back(8);
+		put(info, 0, 4);
+	} else {
+		put(info, 0, 4);
+		info.push_back(8);
+	}
+	uleb(info, 1);
+	put(info, stmt_list, 4);
+	str(info, "/build");
+	end_unit(info, start);
+}
+
+
+/// the sections of a DWARF 4 unit, followed by a DWARF 5 one if v5
+dwarf_sections make_sections(bool v5)
+{
+	dwarf_sections s;
+
+	// DW_TAG_compile_unit with DW_AT_stmt_list and DW_AT_comp_dir
+	uleb(s.abbrev, 1);
+	uleb(s.abbrev, 0x11);
+	s.abbrev.push_back(0);
+	uleb(s.abbrev, 0x10); uleb(s.abbrev, 0x17);
+	uleb(s.abbrev, 0x1b); uleb(s.abbrev, 0x08);
+	uleb(s.abbrev, 0); uleb(s.abbrev, 0);
+	uleb(s.abbrev, 0);
+
+	unit(s.info, 4, 0);
+	line_table_v4(s.line);
+	if (v5) {
+		unit(s.info, 5, s.line.size());
+		line_table_v5(s.line, s.line_str);
+	}
+
+	return s;
+}
+
+
+struct lookup_test {
+	u64 vma;
+	bool found;
+	char const * filename;
+	unsigned int line;
+};
+
+lookup_test const lookup_tests[] = {
+	{ 0xfff, false, "", 0 },
+	{ 0x1000, true, "/build/src/a.c", 10 },
+	{ 0x1005, true, "/build/src/a.c", 11 },
+	{ 0x1009, true, "/build/src/a.c", 11 },
+	{ 0x100c, true, "/usr/include/stdio.h", 11 },
+	{ 0x1010, true, "/build/c.c", 0 },
+	{ 0x101f, true, "/build/c.c", 0 },
+	{ 0x1020, false, "", 0 },
+	{ 0x2004, false, "", 0 },
+	{ 0x2008, false, "", 0 },
+	{ 0x1004, true, "/build/src/a.c", 11 },
+	{ 0x200a, false, "", 0 },
+	{ 0, false, "", 0 },
+};
+
+
+/// DWARF 5 numbers files and directories from 0
+lookup_test const lookup_tests_v5[] = {
+	{ 0x1000, true, "/build/src/a.c", 10 },
+	{ 0x3000, true, "/build5/x.c", 1 },
+	{ 0x3003, true, "/build/inc/y.h", 5 },
+	{ 0x3004, false, "", 0 },
+};
+
+
+int check_lookups(line_index const & index, lookup_test const * tests,
+                  size_t nr_tests)
+{
+	for (size_t i = 0; i < nr_tests; ++i) {
+		lookup_test const & t = tests[i];
+		string filename;
+		unsigned int line = 0;
+		bool found = index.find(t.vma, filename, line);
+		if (found != t.found ||
+		    (found && (filename != t.filename || line != t.line))) {
+			cerr << "find(" << hex << t.vma << ") returned "
+			     << found << " " << filename << ":" << dec
+			     << line << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+char const test_source[] =
+	"static int f(int i)\n"
+	"{\n"
+	"	return i * 3;\n"
+	"}\n"
+	"\n"
+	"int main(int argc, char ** argv)\n"
+	"{\n"
+	"	int i, sum = 0;\n"
+	"	for (i = 0; i < argc; ++i)\n"
+	"		sum += f(argv[i][0]);\n"
+	"	return sum;\n"
+	"}\n";
+
+
+/// read the DWARF sections of a little endian ELF64 file
+bool read_elf_sections(string const & file, dwarf_sections & s)
+{
+	ifstream in(file.c_str(), ios::binary);
+	vector<char> const image((istreambuf_iterator<char>(in)),
+	                         istreambuf_iterator<char>());
+	if (image.size() < sizeof(Elf64_Ehdr))
+		return false;
+
+	Elf64_Ehdr const * ehdr =
+		reinterpret_cast<Elf64_Ehdr const *>(&image[0]);
+	if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) ||
+	    ehdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+	    ehdr->e_ident[EI_DATA] != ELFDATA2LSB ||
+	    ehdr->e_shoff + ehdr->e_shnum * sizeof(Elf64_Shdr) > image.size() ||
+	    ehdr->e_shstrndx >= ehdr->e_shnum)
+		return false;
+
+	Elf64_Shdr const * shdr =
+		reinterpret_cast<Elf64_Shdr const *>(&image[ehdr->e_shoff]);
+	Elf64_Shdr const & names = shdr[ehdr->e_shstrndx];
+
+	for (size_t i = 0; i < ehdr->e_shnum; ++i) {
+		if (shdr[i].sh_type == SHT_NOBITS ||
+		    shdr[i].sh_offset + shdr[i].sh_size > image.size() ||
+		    names.sh_offset + shdr[i].sh_name >= image.size())
+			continue;
+		string const name = &image[names.sh_offset + shdr[i].sh_name];
+		char const * begin = &image[shdr[i].sh_offset];
+		section_t const contents(begin, begin + shdr[i].sh_size);
+		if (name.compare(0, 7, ".debug_") == 0 &&
+		    (shdr[i].sh_flags & SHF_COMPRESSED))
+			return false;
+		if (name == ".debug_info")
+			s.info = contents;
+		else if (name == ".debug_abbrev")
+			s.abbrev = contents;
+		else if (name == ".debug_line")
+			s.line = contents;
+		else if (name == ".debug_str")
+			s.str = contents;
+		else if (name == ".debug_line_str")
+			s.line_str = contents;
+		else if (name == ".debug_str_offsets")
+			s.str_offsets = contents;
+	}
+
+	return !s.line.empty();
+}
+
+
+/**
+ * Compile test_source with the given DWARF version, return false if it
+ * can't be done here.
+ */
+bool compile(string const & dir, int dwarf_version, string & exe)
+{
+	ostringstream name;
+	name << dir << "/dwarf" << dwarf_version;
+	exe = name.str();
+
+	string const source = dir + "/test.c";
+	ofstream out(source.c_str());
+	out << test_source;
+	out.close();
+
+	ostringstream cmd;
+	cmd << "cc -g -gdwarf-" << dwarf_version << " -o " << exe
+	    << ' ' << source << " 2>/dev/null";
+	return system(cmd.str().c_str()) == 0;
+}
+
+
+/**
+ * Compare the lookups of the line index of exe with addr2line, which
+ * uses bfd_find_nearest_line(), at the start of each entry. Return
+ * false if addr2line can't be run.
+ */
+bool compare_with_bfd(string const & exe, line_index const & index,
+                      bool & same)
+{
+	vector<line_index::entry> const & entries = index.get_entries();
+	string const addresses = exe + ".addr";
+	ofstream out(addresses.c_str());
+	vector<line_index::entry> checked;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		// entries without a line are left to bfd
+		if (entries[i].file == line_index::no_file || !entries[i].line)
+			continue;
+		checked.push_back(entries[i]);
+		out << hex << "0x" << entries[i].address << '\n';
+	}
+	out.close();
+
+	string const cmd = "addr2line -e " + exe + " < " + addresses;
+	FILE * in = popen(cmd.c_str(), "r");
+	if (!in)
+		return false;
+
+	same = true;
+	char buf[4096];
+	size_t i = 0;
+	for (; fgets(buf, sizeof(buf), in); ++i) {
+		// file:line, optionally followed by " (discriminator n)"
+		string line(buf, strcspn(buf, " \n"));
+		string::size_type const pos = line.rfind(':');
+		if (i >= checked.size() || pos == string::npos) {
+			same = false;
+			break;
+		}
+
+		string filename;
+		unsigned int linenr;
+		index.find(checked[i].address, filename, linenr);
+		ostringstream expected;
+		expected << filename << ':' << linenr;
+		if (expected.str() != line) {
+			cerr << "find(" << hex << checked[i].address
+			     << ") returned " << expected.str()
+			     << ", addr2line " << line << endl;
+			same = false;
+		}
+	}
+
+	if (pclose(in) != 0)
+		return false;
+
+	return !same || i == checked.size();
+}
+
+
+/// check the index of a binary of the given DWARF version against bfd
+int check_version_against_bfd(string const & dir, int dwarf_version)
+{
+	string exe;
+	dwarf_sections sections;
+	line_index index;
+	bool same = false;
+
+	if (!compile(dir, dwarf_version, exe) ||
+	    !read_elf_sections(exe, sections)) {
+		cerr << "no DWARF " << dwarf_version
+		     << " binary, comparison with bfd skipped\n";
+	} else if (!index.build(sections) || index.get_entries().empty()) {
+		cerr << "DWARF " << dwarf_version
+		     << " line tables not indexed\n";
+		return EXIT_FAILURE;
+	} else if (!compare_with_bfd(exe, index, same)) {
+		cerr << "addr2line failed, comparison with bfd skipped\n";
+	} else if (!same) {
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+/// check the index against bfd on a real DWARF 4 and a DWARF 5 binary
+int check_against_bfd()
+{
+	char dir[] = "/tmp/line_index_tests.XXXXXX";
+	if (!mkdtemp(dir)) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+
+	int ret = EXIT_SUCCESS;
+	if (check_version_against_bfd(dir, 4) != EXIT_SUCCESS)
+		ret = EXIT_FAILURE;
+	if (check_version_against_bfd(dir, 5) != EXIT_SUCCESS)
+		ret = EXIT_FAILURE;
+
+	if (remove_tree(dir))
+		ret = EXIT_FAILURE;
+
+	return ret;
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	dwarf_sections sections = make_sections(false);
+	line_index index;
+
+	if (!index.build(sections)) {
+		cerr << "build() failed\n";
+		return EXIT_FAILURE;
+	}
+
+	size_t const nr_tests = sizeof(lookup_tests) / sizeof(lookup_tests[0]);
+	if (check_lookups(index, lookup_tests, nr_tests) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	// assign() must give the same index
+	vector<line_index::entry> entries = index.get_entries();
+	vector<string> files = index.get_files();
+	line_index copy;
+	copy.assign(entries, files);
+	if (check_lookups(copy, lookup_tests, nr_tests) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	// truncated sections are rejected
+	sections.line.resize(sections.line.size() - 10);
+	if (index.build(sections) || !index.get_entries().empty()) {
+		cerr << "truncated line table accepted\n";
+		return EXIT_FAILURE;
+	}
+
+	// a DWARF 4 and a DWARF 5 unit in the same image
+	sections = make_sections(true);
+	if (!index.build(sections)) {
+		cerr << "build() failed on a DWARF 5 line table\n";
+		return EXIT_FAILURE;
+	}
+
+	size_t const nr_tests_v5 =
+		sizeof(lookup_tests_v5) / sizeof(lookup_tests_v5[0]);
+	if (check_lookups(index, lookup_tests_v5, nr_tests_v5) != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	return check_against_bfd();
+}
@@ -0,0 +1,96 @@
+/**
+ * @file small_array_tests.cpp
+ * tests small_array.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include "small_array.h"
+
+using namespace std;
+
+namespace {
+
+typedef small_array<unsigned int, 4> array_t;
+
+
+int check_access()
+{
+	array_t a;
+	array_t const & ca = a;
+
+	if (a.size() != 0 || !a.zero() || ca[10] != 0) {
+		cerr << "bad empty array\n";
+		return EXIT_FAILURE;
+	}
+
+	a[2] = 3;
+	if (a.size() != 3 || ca[2] != 3 || ca[1] != 0 || a.zero()) {
+		cerr << "bad inline element\n";
+		return EXIT_FAILURE;
+	}
+
+	a[6] = 7;
+	if (a.size() != 7 || ca[6] != 7 || ca[5] != 0 || ca[2] != 3) {
+		cerr << "bad spilled element\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+
+int check_arithmetic()
+{
+	array_t a, b;
+
+	a[1] = 5;
+	b[1] = 2;
+	b[5] = 4;
+
+	a += b;
+	if (a.size() != 6 || a[1] != 7 || a[5] != 4) {
+		cerr << "bad += result\n";
+		return EXIT_FAILURE;
+	}
+
+	// the smaller array must not lose its spilled elements
+	array_t c(a);
+	c += array_t();
+	if (c.size() != 6 || c[5] != 4) {
+		cerr << "bad += of a smaller array\n";
+		return EXIT_FAILURE;
+	}
+
+	a -= b;
+	if (a.size() != 6 || a[1] != 5 || a[5] != 0) {
+		cerr << "bad -= result\n";
+		return EXIT_FAILURE;
+	}
+
+	a[1] = 0;
+	if (!a.zero()) {
+		cerr << "zero() failed\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	if (check_access() != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	if (check_arithmetic() != EXIT_SUCCESS)
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
@@ -258,6 +258,27 @@ static void format_percent_tests()
 }
 
 
+static input_output<double, char const *> expect_append_percent[] =
+{
+	{ 2.2,        "x+2.2000" },
+	{ -12.5,      "x-12.5000" },
+	{ 0,          "x      0" },
+	{ -1.0, 0 }
+};
+
+static void append_percent_tests()
+{
+	input_output<double, char const*> const * cur;
+	for (cur = expect_append_percent; cur->input != -1.0; ++cur) {
+		string result("x");
+		append_percent(result, cur->input, percent_int_width,
+		               percent_fract_width, true);
+		check_result("append_percent()", cur->input, cur->output,
+			     result);
+	}
+}
+
+
 static input_output<unsigned int, char const *> expect_from_str_to_uint[] =
 {
 	{ 123, "123" },
@@ -321,5 +342,6 @@ int main()
 	ltrim_tests();
 	trim_tests();
 	format_percent_tests();
+	append_percent_tests();
 	return EXIT_SUCCESS;
 }
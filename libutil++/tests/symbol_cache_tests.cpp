@@ -0,0 +1,219 @@
+/**
+ * @file symbol_cache_tests.cpp
+ * tests symbol_cache.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "symbol_cache.h"
+
+using namespace std;
+
+namespace {
+
+string image;
+/// the only candidate debug file of image
+string debug;
+
+
+symbol_cache_key image_key(string const & build_id)
+{
+	struct stat st;
+	stat(image.c_str(), &st);
+
+	symbol_cache_key key;
+	key.path = image;
+	key.size = st.st_size;
+	key.mtime = st.st_mtime;
+	key.build_id = build_id;
+	key.debug_stamp = symbol_cache_stamp(vector<string>(1, debug));
+	return key;
+}
+
+
+void write_image(char const * contents)
+{
+	ofstream out(image.c_str());
+	out << contents;
+}
+
+
+void check_write()
+{
+	symbol_cache_writer writer(image_key("abcd"));
+	symbol_cache_record record;
+
+	memset(&record, 0, sizeof(record));
+	record.value = 0x10;
+	record.section_vma = 0x8000;
+	record.size = 0x20;
+	record.flags = SYMBOL_CACHE_WEAK;
+	writer.add(record, "main");
+	record.value = 0x30;
+	record.section_index = 3;
+	record.flags = SYMBOL_CACHE_HIDDEN;
+	writer.add(record, "");
+
+	if (!writer.commit()) {
+		cerr << "symbol_cache_writer::commit() failed\n";
+		exit(EXIT_FAILURE);
+	}
+}
+
+
+void check_read()
+{
+	symbol_cache_file file(image_key("abcd"));
+
+	if (!file.valid() || file.size() != 2) {
+		cerr << "cache entry not found\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (strcmp(file.name(file[0]), "main") || file[0].value != 0x10 ||
+	    file[0].section_vma != 0x8000 || file[0].size != 0x20 ||
+	    file[0].flags != SYMBOL_CACHE_WEAK) {
+		cerr << "bad first symbol\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (strcmp(file.name(file[1]), "") || file[1].value != 0x30 ||
+	    file[1].section_index != 3 ||
+	    file[1].flags != SYMBOL_CACHE_HIDDEN) {
+		cerr << "bad second symbol\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (!file.debug_filename().empty()) {
+		cerr << "unexpected debug file\n";
+		exit(EXIT_FAILURE);
+	}
+}
+
+
+void check_lines()
+{
+	symbol_cache_writer writer(image_key("abcd"), cache_lines);
+	line_cache_record record;
+
+	memset(&record, 0, sizeof(record));
+	record.address = 0x1000;
+	record.line = 10;
+	writer.add(record, "/src/a.c");
+	record.address = 0x1008;
+	record.line = 12;
+	writer.add(record, "/src/a.c");
+	record.address = 0x1010;
+	record.line = 0;
+	writer.add(record, "");
+
+	if (!writer.commit()) {
+		cerr << "commit() of a line entry failed\n";
+		exit(EXIT_FAILURE);
+	}
+
+	symbol_cache_file file(image_key("abcd"), cache_lines);
+	if (!file.valid() || file.size() != 3 ||
+	    file.line(1).address != 0x1008 || file.line(1).line != 12 ||
+	    strcmp(file.name(file.line(1)), "/src/a.c") ||
+	    file.line(0).file != file.line(1).file ||
+	    strcmp(file.name(file.line(2)), "")) {
+		cerr << "bad line entry\n";
+		exit(EXIT_FAILURE);
+	}
+
+	// the symbol entry is a different file
+	if (symbol_cache_file(image_key("abcd")).size() != 2) {
+		cerr << "line entry replaced the symbol entry\n";
+		exit(EXIT_FAILURE);
+	}
+}
+
+
+void check_stale()
+{
+	if (symbol_cache_file(image_key("abce")).valid()) {
+		cerr << "entry with a different build-id used\n";
+		exit(EXIT_FAILURE);
+	}
+
+	// a debug file installed after the entry was written
+	{
+		ofstream out(debug.c_str());
+		out << "debug";
+	}
+	if (symbol_cache_file(image_key("abcd")).valid()) {
+		cerr << "entry used after a debug file appeared\n";
+		exit(EXIT_FAILURE);
+	}
+	unlink(debug.c_str());
+
+	if (!symbol_cache_file(image_key("abcd")).valid()) {
+		cerr << "entry unusable after the debug file went away\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (gc_symbol_cache() != 0) {
+		cerr << "up to date entry collected\n";
+		exit(EXIT_FAILURE);
+	}
+
+	write_image("a longer image");
+
+	if (symbol_cache_file(image_key("abcd")).valid()) {
+		cerr << "entry of a modified image used\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (gc_symbol_cache() != 2) {
+		cerr << "stale entry not collected\n";
+		exit(EXIT_FAILURE);
+	}
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	char dir[] = "/tmp/symbol_cache_testsXXXXXX";
+	if (!mkdtemp(dir)) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+
+	set_symbol_cache_dir(string(dir) + "/cache");
+	image = string(dir) + "/image";
+	debug = string(dir) + "/image.debug";
+	write_image("image");
+
+	check_write();
+	check_read();
+	check_lines();
+	check_stale();
+
+	check_write();
+	if (clear_symbol_cache() != 1 ||
+	    symbol_cache_file(image_key("abcd")).valid()) {
+		cerr << "clear_symbol_cache() failed\n";
+		return EXIT_FAILURE;
+	}
+
+	unlink(image.c_str());
+	rmdir((string(dir) + "/cache").c_str());
+	rmdir(dir);
+
+	return EXIT_SUCCESS;
+}
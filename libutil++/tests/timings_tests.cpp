@@ -0,0 +1,81 @@
+/**
+ * @file timings_tests.cpp
+ * tests timings.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "timings.h"
+
+using namespace std;
+
+namespace {
+
+bool contains(string const & str, string const & pattern)
+{
+	if (str.find(pattern) != string::npos)
+		return true;
+	cerr << "no \"" << pattern << "\" in:\n" << str;
+	return false;
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	// nothing is recorded before enable()
+	timings::count("ignored");
+	if (timings::enabled()) {
+		cerr << "timings enabled by default\n";
+		return EXIT_FAILURE;
+	}
+
+	timings::enable();
+	{
+		scoped_timer timer("first");
+	}
+	timings::add("first", 0.25, false);
+	timings::add("quote\"d", 1.5, false);
+	timings::count("files");
+	timings::count("files", 41);
+
+	ostringstream json;
+	json << 1.0 << " ";
+	timings::report_json(json);
+	if (!contains(json.str(), "1 {\n") ||
+	    !contains(json.str(), "\"name\": \"first\"") ||
+	    !contains(json.str(), "\"calls\": 2, \"peak_rss_kb\": ") ||
+	    !contains(json.str(), "{ \"name\": \"quote\\\"d\", "
+	                          "\"seconds\": 1.500000, \"calls\": 1 }") ||
+	    !contains(json.str(), "\"files\": 42\n"))
+		return EXIT_FAILURE;
+
+	if (json.str().find("ignored") != string::npos) {
+		cerr << "counter recorded before enable()\n";
+		return EXIT_FAILURE;
+	}
+
+	// the stream format is restored
+	json.str("");
+	json << 1.0;
+	if (json.str() != "1") {
+		cerr << "report_json() changed the stream format\n";
+		return EXIT_FAILURE;
+	}
+
+	ostringstream table;
+	timings::report(table);
+	if (!contains(table.str(), "\nfirst ") ||
+	    !contains(table.str(), "\nfiles ") ||
+	    !contains(table.str(), " 42\n"))
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file tree_walker_tests.cpp
+ * tests tree_walker.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <set>
+#include <string>
+
+#include "tree_walker.h"
+#include "file_manip.h"
+#include "op_file.h"
+
+using namespace std;
+
+namespace {
+
+class collect_visitor : public tree_visitor {
+public:
+	collect_visitor(string const & pruned) : prune(pruned) {
+		pthread_mutex_init(&mutex, 0);
+	}
+	~collect_visitor() { pthread_mutex_destroy(&mutex); }
+
+	bool enter_dir(string const & path) {
+		return op_basename(path) != prune;
+	}
+
+	void file(string const & path) {
+		pthread_mutex_lock(&mutex);
+		files.insert(path);
+		pthread_mutex_unlock(&mutex);
+	}
+
+	set<string> files;
+
+private:
+	string prune;
+	pthread_mutex_t mutex;
+};
+
+
+string make_tree()
+{
+	char dir[] = "/tmp/tree_walker_tests.XXXXXX";
+	if (!mkdtemp(dir)) {
+		cerr << "mkdtemp() failed\n";
+		exit(EXIT_FAILURE);
+	}
+
+	char const * const files[] = {
+		"a/1", "a/b/2", "a/b/c/3", "a/d/4", "e/f/5",
+		"pruned/6", "pruned/g/7", "8",
+	};
+	string const base = dir;
+	bool ok = true;
+	for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+		string const file = base + "/" + files[i];
+		ok = ok && !create_path(file.c_str());
+		ofstream out(file.c_str());
+		ok = ok && out;
+	}
+	ok = ok && !symlink("a", (base + "/link").c_str());
+	ok = ok && !symlink("missing", (base + "/dangling").c_str());
+
+	if (!ok) {
+		cerr << "couldn't create the test tree\n";
+		exit(EXIT_FAILURE);
+	}
+
+	return base;
+}
+
+
+int check_walk(string const & base, size_t nr_threads)
+{
+	collect_visitor visitor("pruned");
+	if (!walk_tree(base, visitor, nr_threads)) {
+		cerr << "walk_tree(" << base << ") failed\n";
+		return EXIT_FAILURE;
+	}
+
+	char const * const expected[] = {
+		"a/1", "a/b/2", "a/b/c/3", "a/d/4", "e/f/5", "8",
+		"link/1", "link/b/2", "link/b/c/3", "link/d/4",
+	};
+	size_t const nr_expected = sizeof(expected) / sizeof(expected[0]);
+
+	set<string> expected_files;
+	for (size_t i = 0; i < nr_expected; ++i)
+		expected_files.insert(base + "/" + expected[i]);
+
+	if (visitor.files != expected_files) {
+		cerr << "walk with " << nr_threads << " threads found:\n";
+		set<string>::const_iterator it = visitor.files.begin();
+		for (; it != visitor.files.end(); ++it)
+			cerr << *it << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	string const base = make_tree();
+	int ret = EXIT_SUCCESS;
+
+	size_t const nr_threads[] = { 1, 2, 8 };
+	for (size_t i = 0; i < 3 && ret == EXIT_SUCCESS; ++i)
+		ret = check_walk(base, nr_threads[i]);
+
+	collect_visitor visitor("");
+	if (ret == EXIT_SUCCESS &&
+	    walk_tree(base + "/nonexistent", visitor, 2)) {
+		cerr << "walk of a missing directory succeeded\n";
+		ret = EXIT_FAILURE;
+	}
+
+	if (remove_tree(base.c_str()))
+		cerr << "couldn't remove " << base << endl;
+
+	return ret;
+}
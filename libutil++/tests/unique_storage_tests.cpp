@@ -0,0 +1,78 @@
+/**
+ * @file unique_storage_tests.cpp
+ * tests unique_storage.h
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "unique_storage.h"
+#include "string_manip.h"
+
+using namespace std;
+
+namespace {
+
+struct value {
+	value(string const & s = string()) : str(s) {}
+
+	bool operator==(value const & rhs) const { return str == rhs.str; }
+
+	size_t hash() const { return hash_string(str); }
+
+	string str;
+};
+
+class test_tag;
+typedef unique_storage<test_tag, value> storage_t;
+
+
+string make_name(size_t i)
+{
+	ostringstream os;
+	os << "_ZN4name" << i << "Ev";
+	return os.str();
+}
+
+}  // anonymous namespace
+
+
+int main()
+{
+	storage_t storage;
+
+	storage_t::id_value const none;
+	if (none.set() || storage.get(none).str != "") {
+		cerr << "bad default id\n";
+		return EXIT_FAILURE;
+	}
+
+	// enough values to rehash several times
+	size_t const nr_values = 5000;
+	vector<storage_t::id_value> ids;
+	for (size_t i = 0; i < nr_values; ++i)
+		ids.push_back(storage.create(make_name(i)));
+
+	for (size_t i = 0; i < nr_values; ++i) {
+		storage_t::id_value id = storage.create(make_name(i));
+		if (id != ids[i] || !id.set() ||
+		    storage.get(id).str != make_name(i)) {
+			cerr << "value " << make_name(i) << " not unique\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	storage_t::id_value empty = storage.create(string());
+	if (!empty.set() || storage.create(string()) != empty) {
+		cerr << "bad id for the empty value\n";
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file timings.cpp
+ * Instrumentation of the phases of a pp tool
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "timings.h"
+
+using namespace std;
+
+verbose vtimings("timings");
+
+namespace {
+
+struct phase_time {
+	char const * name;
+	double seconds;
+	unsigned long long calls;
+	/// in kilobytes, 0 if never sampled
+	long peak_rss;
+};
+
+struct counter {
+	char const * name;
+	unsigned long long value;
+};
+
+bool recording;
+vector<phase_time> phases;
+vector<counter> counters;
+pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/// peak resident set size of the process in kilobytes
+long peak_rss()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage))
+		return 0;
+	return usage.ru_maxrss;
+}
+
+
+template <typename T> T & find_entry(vector<T> & entries, char const * name)
+{
+	for (size_t i = 0; i < entries.size(); ++i) {
+		if (!strcmp(entries[i].name, name))
+			return entries[i];
+	}
+
+	T entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.name = name;
+	entries.push_back(entry);
+	return entries.back();
+}
+
+
+void json_string(ostream & out, char const * str)
+{
+	out << '"';
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\')
+			out << '\\';
+		out << *str;
+	}
+	out << '"';
+}
+
+}  // anonymous namespace
+
+
+namespace timings {
+
+void enable()
+{
+	recording = true;
+}
+
+
+bool enabled()
+{
+	return recording;
+}
+
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+void add(char const * phase, double seconds, bool snapshot_memory)
+{
+	long const rss = snapshot_memory ? peak_rss() : 0;
+
+	pthread_mutex_lock(&mutex);
+	phase_time & t = find_entry(phases, phase);
+	t.seconds += seconds;
+	++t.calls;
+	if (rss > t.peak_rss)
+		t.peak_rss = rss;
+	pthread_mutex_unlock(&mutex);
+}
+
+
+void count(char const * name, unsigned long long n)
+{
+	if (!recording)
+		return;
+
+	pthread_mutex_lock(&mutex);
+	find_entry(counters, name).value += n;
+	pthread_mutex_unlock(&mutex);
+}
+
+
+void report(ostream & out)
+{
+	pthread_mutex_lock(&mutex);
+
+	ios::fmtflags const flags = out.flags();
+	streamsize const precision = out.precision();
+
+	out << left << setw(32) << "phase" << right << setw(14) << "seconds"
+	    << setw(12) << "calls" << setw(16) << "peak RSS (kB)" << '\n';
+	for (size_t i = 0; i < phases.size(); ++i) {
+		phase_time const & t = phases[i];
+		out << left << setw(32) << t.name << right
+		    << fixed << setprecision(6) << setw(14) << t.seconds
+		    << setw(12) << t.calls << setw(16);
+		if (t.peak_rss)
+			out << t.peak_rss;
+		else
+			out << "-";
+		out << '\n';
+	}
+
+	if (!counters.empty()) {
+		out << '\n' << left << setw(32) << "counter" << right
+		    << setw(14) << "value" << '\n';
+	}
+	for (size_t i = 0; i < counters.size(); ++i) {
+		out << left << setw(32) << counters[i].name << right
+		    << setw(14) << counters[i].value << '\n';
+	}
+
+	out << "\npeak RSS: " << peak_rss() << " kB\n";
+
+	out.flags(flags);
+	out.precision(precision);
+
+	pthread_mutex_unlock(&mutex);
+}
+
+
+void report_json(ostream & out)
+{
+	pthread_mutex_lock(&mutex);
+
+	ios::fmtflags const flags = out.flags();
+	streamsize const precision = out.precision();
+
+	out << "{\n  \"phases\": [";
+	for (size_t i = 0; i < phases.size(); ++i) {
+		phase_time const & t = phases[i];
+		out << (i ? ",\n    " : "\n    ") << "{ \"name\": ";
+		json_string(out, t.name);
+		out << ", \"seconds\": " << fixed << setprecision(6)
+		    << t.seconds << ", \"calls\": " << t.calls;
+		if (t.peak_rss)
+			out << ", \"peak_rss_kb\": " << t.peak_rss;
+		out << " }";
+	}
+	out << (phases.empty() ? "],\n" : "\n  ],\n");
+
+	out << "  \"counters\": {";
+	for (size_t i = 0; i < counters.size(); ++i) {
+		out << (i ? ",\n    " : "\n    ");
+		json_string(out, counters[i].name);
+		out << ": " << counters[i].value;
+	}
+	out << (counters.empty() ? "},\n" : "\n  },\n");
+
+	out << "  \"peak_rss_kb\": " << peak_rss() << "\n}\n";
+
+	out.flags(flags);
+	out.precision(precision);
+
+	pthread_mutex_unlock(&mutex);
+}
+
+}
@@ -0,0 +1,74 @@
+/**
+ * @file timings.h
+ * Instrumentation of the phases of a pp tool
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * Phases and counters are named by static strings. Phase times
+ * accumulate, a phase entered by several threads at once counts the
+ * time of each, and the peak resident set size of the process is
+ * snapshotted when a phase ends. Nothing is recorded until enable() is
+ * called, by --timings, --timings-json or --verbose=timings.
+ */
+
+#ifndef TIMINGS_H
+#define TIMINGS_H
+
+#include <iosfwd>
+
+#include "cverb.h"
+#include "utility.h"
+
+/// named "timings", enable recording from --verbose
+extern verbose vtimings;
+
+namespace timings {
+
+/// start recording
+void enable();
+
+/// return true if recording
+bool enabled();
+
+/// return a monotonic time in seconds
+double now();
+
+/**
+ * Add seconds to phase, phases are reported in the order first added.
+ * If snapshot_memory is true the peak resident set size is sampled, it's
+ * a system call not worth doing for phases entered per symbol.
+ */
+void add(char const * phase, double seconds, bool snapshot_memory = true);
+
+/// add n to counter, a no-op if not recording
+void count(char const * counter, unsigned long long n = 1);
+
+/// output a table of the phases and counters
+void report(std::ostream & out);
+
+/// output the phases and counters as a JSON object
+void report_json(std::ostream & out);
+
+}
+
+
+/// add the time from its construction to its destruction to a phase
+class scoped_timer : noncopyable {
+public:
+	explicit scoped_timer(char const * phase_, bool snapshot_memory_ = true)
+		: phase(phase_), snapshot_memory(snapshot_memory_),
+		  start(timings::enabled() ? timings::now() : 0) {}
+	~scoped_timer() {
+		if (timings::enabled())
+			timings::add(phase, timings::now() - start,
+			             snapshot_memory);
+	}
+
+private:
+	char const * phase;
+	bool snapshot_memory;
+	double start;
+};
+
+#endif /* !TIMINGS_H */
@@ -0,0 +1,216 @@
+/**
+ * @file tree_walker.cpp
+ * Parallel walk of a directory tree
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <pthread.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "tree_walker.h"
+#include "op_exception.h"
+#include "utility.h"
+
+using namespace std;
+
+namespace {
+
+/**
+ * The walking threads share a stack of directories to read. A thread
+ * pushes the sub-directories it finds and pops the last one pushed, so
+ * each thread goes depth first while idle threads take whatever is
+ * pending, including the siblings pushed by the others.
+ */
+class tree_walk : noncopyable {
+public:
+	explicit tree_walk(tree_visitor & visitor);
+	~tree_walk();
+
+	/**
+	 * read dir, calling the visitor for its entries, and push its
+	 * sub-directories. Return false if dir can't be read.
+	 */
+	bool read_dir(string const & dir);
+
+	/// walk the pending directories with nr_threads threads
+	void run(size_t nr_threads);
+
+private:
+	static void * worker_main(void * walk);
+	void work();
+
+	tree_visitor & visitor;
+	/// directories not yet read
+	vector<string> pending;
+	/// nr. of threads reading a directory
+	size_t busy;
+	/// the first error met, the walk stops on error
+	string error;
+	pthread_mutex_t mutex;
+	pthread_cond_t work_changed;
+};
+
+
+tree_walk::tree_walk(tree_visitor & v)
+	: visitor(v), busy(0)
+{
+	pthread_mutex_init(&mutex, 0);
+	pthread_cond_init(&work_changed, 0);
+}
+
+
+tree_walk::~tree_walk()
+{
+	pthread_cond_destroy(&work_changed);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+bool tree_walk::read_dir(string const & dir)
+{
+	DIR * d = opendir(dir.c_str());
+	if (!d)
+		return false;
+
+	vector<string> subdirs;
+	struct dirent * ent;
+	while ((ent = readdir(d)) != 0) {
+		char const * name = ent->d_name;
+		if (name[0] == '.' && (name[1] == '\0' ||
+		    (name[1] == '.' && name[2] == '\0')))
+			continue;
+
+		string const path = dir + '/' + name;
+
+		bool is_dir = false;
+#ifdef _DIRENT_HAVE_D_TYPE
+		if (ent->d_type == DT_DIR) {
+			is_dir = true;
+		} else if (ent->d_type != DT_UNKNOWN &&
+		           ent->d_type != DT_LNK) {
+			is_dir = false;
+		} else
+#endif
+		{
+			struct stat st;
+			if (stat(path.c_str(), &st)) {
+				struct stat lst;
+				int const err = errno;
+				// dangling symlink -- silently ignore
+				if (lstat(path.c_str(), &lst) ||
+				    !S_ISLNK(lst.st_mode)) {
+					cerr << "stat failed for " << path
+					     << " (" << strerror(err) << ")\n";
+				}
+				continue;
+			}
+			is_dir = S_ISDIR(st.st_mode);
+		}
+
+		if (!is_dir)
+			visitor.file(path);
+		else if (visitor.enter_dir(path))
+			subdirs.push_back(path);
+	}
+	closedir(d);
+
+	if (!subdirs.empty()) {
+		pthread_mutex_lock(&mutex);
+		pending.insert(pending.end(), subdirs.begin(), subdirs.end());
+		pthread_cond_broadcast(&work_changed);
+		pthread_mutex_unlock(&mutex);
+	}
+
+	return true;
+}
+
+
+void tree_walk::run(size_t nr_threads)
+{
+	vector<pthread_t> threads;
+	for (size_t i = 1; i < nr_threads && !pending.empty(); ++i) {
+		pthread_t thread;
+		if (pthread_create(&thread, 0, worker_main, this))
+			break;
+		threads.push_back(thread);
+	}
+
+	// the caller is one of the walking threads
+	work();
+
+	for (size_t i = 0; i < threads.size(); ++i)
+		pthread_join(threads[i], 0);
+
+	if (!error.empty())
+		throw op_runtime_error(error);
+}
+
+
+void * tree_walk::worker_main(void * walk)
+{
+	static_cast<tree_walk *>(walk)->work();
+	return 0;
+}
+
+
+void tree_walk::work()
+{
+	pthread_mutex_lock(&mutex);
+
+	for (;;) {
+		while (pending.empty() && busy)
+			pthread_cond_wait(&work_changed, &mutex);
+		if (pending.empty())
+			break;
+
+		string const dir = pending.back();
+		pending.pop_back();
+		++busy;
+		pthread_mutex_unlock(&mutex);
+
+		string dir_error;
+		try {
+			read_dir(dir);
+		} catch (exception const & e) {
+			dir_error = e.what();
+		} catch (...) {
+			dir_error = "unknown exception walking " + dir;
+		}
+
+		pthread_mutex_lock(&mutex);
+		if (!dir_error.empty()) {
+			if (error.empty())
+				error = dir_error;
+			pending.clear();
+		}
+		--busy;
+		pthread_cond_broadcast(&work_changed);
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+}  // anonymous namespace
+
+
+bool walk_tree(string const & base_dir, tree_visitor & visitor,
+               size_t nr_threads)
+{
+	tree_walk walk(visitor);
+
+	if (!walk.read_dir(base_dir))
+		return false;
+
+	walk.run(nr_threads);
+	return true;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file tree_walker.h
+ * Parallel walk of a directory tree
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ *
+ * Listing a session stored on NFS costs a round trip per directory read
+ * and per stat(), walk_tree() hides the latency by reading several
+ * directories at once. The file type given by readdir() is used when
+ * the filesystem provides it so most entries need no stat().
+ */
+
+#ifndef TREE_WALKER_H
+#define TREE_WALKER_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * Receive the entries found by walk_tree(). The member functions are
+ * called concurrently from all the walking threads.
+ */
+class tree_visitor {
+public:
+	virtual ~tree_visitor() {}
+
+	/// return false to not walk the directory path
+	virtual bool enter_dir(std::string const & path) = 0;
+
+	/// called for each entry which is not a directory
+	virtual void file(std::string const & path) = 0;
+};
+
+/**
+ * @param base_dir  the directory to walk, not given to the visitor
+ * @param visitor  receive the entries
+ * @param nr_threads  nr. of threads reading directories
+ *
+ * Walk the tree under base_dir, symbolic links are followed as by
+ * create_file_list(). Entry paths are base_dir + "/" + the relative
+ * path. Unreadable directories are ignored. Return false if base_dir
+ * can't be read.
+ */
+bool walk_tree(std::string const & base_dir, tree_visitor & visitor,
+               size_t nr_threads);
+
+#endif /* !TREE_WALKER_H */
@@ -13,7 +13,6 @@
 #define UNIQUE_STORAGE_H
 
 #include <vector>
-#include <map>
 #include <stdexcept>
 
 /**
@@ -28,14 +27,20 @@
  *
  * The value type "V" must be default-constructible,
  * and this is the value returned by a stored id_value
- * where .set() is false
+ * where .set() is false. It must also provide operator==
+ * and a hash() member returning a std::size_t.
+ *
+ * Values are stored once and indexed by an open addressing
+ * hash table of ids, their hashes are kept to rehash and to
+ * skip most comparisons.
  */
 template <typename I, typename V> class unique_storage {
 
 public:
-	unique_storage() {
+	unique_storage() : buckets(16) {
 		// id 0
 		values.push_back(V());
+		hashes.push_back(0);
 	}
 
 	virtual ~unique_storage() {}
@@ -78,13 +83,26 @@ public:
 
 	/// ensure this value is available
 	id_value const create(V const & value) {
-		typename id_map::value_type val(value, id_value(values.size()));
-		std::pair<typename id_map::iterator, bool>
-			inserted = ids.insert(val);
-		if (inserted.second)
-			values.push_back(value);
+		std::size_t const hash = value.hash();
+		size_type const mask = buckets.size() - 1;
+
+		size_type pos = hash & mask;
+		for (; buckets[pos]; pos = (pos + 1) & mask) {
+			size_type const id = buckets[pos];
+			if (hashes[id] == hash && values[id] == value)
+				return id_value(id);
+		}
+
+		size_type const id = values.size();
+		values.push_back(value);
+		hashes.push_back(hash);
+		buckets[pos] = id;
+
+		// keep the load factor under 3/4
+		if (values.size() * 4 > buckets.size() * 3)
+			rehash(buckets.size() * 2);
 
-		return inserted.first->second;
+		return id_value(id);
 	}
 
 
@@ -98,13 +116,29 @@ public:
 	}
 
 private:
-	typedef std::map<V, id_value> id_map;
+	typedef typename stored_values::size_type size_type;
+
+	/// rebuild the hash table with size buckets, a power of two
+	void rehash(size_type size) {
+		std::vector<size_type> new_buckets(size);
+		size_type const mask = size - 1;
+		for (size_type id = 1; id < values.size(); ++id) {
+			size_type pos = hashes[id] & mask;
+			while (new_buckets[pos])
+				pos = (pos + 1) & mask;
+			new_buckets[pos] = id;
+		}
+		buckets.swap(new_buckets);
+	}
 
 	/// the contained values
 	stored_values values;
 
-	/// map from ID to value
-	id_map ids;
+	/// hash of each value, indexed by ID
+	std::vector<std::size_t> hashes;
+
+	/// hash table of IDs, 0 for an empty bucket
+	std::vector<size_type> buckets;
 };
 
 #endif /* !UNIQUE_STORAGE_H */
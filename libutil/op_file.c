@@ -9,11 +9,15 @@
  * @author Philippe Elie
  */
 
+/* nftw() FTW_DEPTH and FTW_PHYS */
+#define _GNU_SOURCE
+
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <dirent.h>
 #include <fnmatch.h>
+#include <ftw.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
@@ -75,6 +79,22 @@ int create_path(char const * path)
 }
 
 
+static int remove_entry(char const * path,
+                        struct stat const * sb __attribute__((unused)),
+                        int type __attribute__((unused)),
+                        struct FTW * ftw __attribute__((unused)))
+{
+	return remove(path);
+}
+
+
+int remove_tree(char const * path)
+{
+	/* children first, don't follow the symbolic links */
+	return nftw(path, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+
 inline static int is_dot_or_dotdot(char const * name)
 {
 	return name[0] == '.' &&
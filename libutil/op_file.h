@@ -57,6 +57,16 @@ int create_dir(char const * dir);
  */
 int create_path(char const * path);
 
+/**
+ * remove_tree - remove a file or a directory and all its content
+ * @param path  the path to remove
+ *
+ * Symbolic links are removed, not followed.
+ *
+ * Returns 0 on success.
+ */
+int remove_tree(char const * path);
+
 /**
  * Clients of get_matching_pathnames must provide their own implementation
  * of get_pathname_callback.
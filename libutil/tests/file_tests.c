@@ -41,11 +41,46 @@ static char * tests[][2] = {
 	{ NULL, NULL },
 };
 
+
+static void check_remove_tree(void)
+{
+	char dir[] = "/tmp/file_tests.XXXXXX";
+	char path[PATH_MAX];
+	FILE * fp;
+
+	if (!mkdtemp(dir)) {
+		perror(dir);
+		exit(EXIT_FAILURE);
+	}
+
+	snprintf(path, sizeof(path), "%s/a/b/file", dir);
+	if (create_path(path) || !(fp = fopen(path, "w"))) {
+		fprintf(stderr, "couldn't create %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	fclose(fp);
+
+	/* the target of a link must survive */
+	snprintf(path, sizeof(path), "%s/a/link", dir);
+	if (symlink("/usr", path)) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	if (remove_tree(dir) || !access(dir, F_OK) || access("/usr", F_OK)) {
+		fprintf(stderr, "remove_tree(%s) failed\n", dir);
+		exit(EXIT_FAILURE);
+	}
+}
+
+
 int main(void)
 {
 	char tmp[PATH_MAX];
 	size_t i = 0;
 
+	check_remove_tree();
+
 	if (chdir("/usr")) {
 		fprintf(stderr, "chdir(\"/usr\") failed for %s\n", tests[i][0]);
 		exit(EXIT_FAILURE);
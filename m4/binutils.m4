@@ -20,6 +20,33 @@ dnl Use a different bfd function here so as not to use cached result from above
 	]
 )
 
+dnl libopcodes is optional, opannotate runs objdump without it
+OPCODES_LIBS=""
+AC_CHECK_HEADERS(dis-asm.h)
+if test "$ac_cv_header_dis_asm_h" = "yes"; then
+	AC_CHECK_LIB(opcodes, disassemble_init_for_target,
+		[OPCODES_LIBS="-lopcodes"
+		AC_DEFINE(HAVE_LIBOPCODES, 1, [libopcodes can be used to disassemble])])
+fi
+
+if test -n "$OPCODES_LIBS"; then
+	AC_MSG_CHECKING([whether disassembler() takes the architecture])
+	AC_TRY_COMPILE([#include <dis-asm.h>],
+		[disassembler_ftype f = disassembler(bfd_arch_unknown, 0, 0, 0);],
+		[AC_MSG_RESULT([yes])
+		AC_DEFINE(DISASSEMBLER_TAKES_ARCH, 1, [disassembler() has four parameters])],
+		[AC_MSG_RESULT([no])])
+
+	AC_MSG_CHECKING([whether init_disassemble_info() takes a styled printer])
+	AC_TRY_COMPILE([#include <dis-asm.h>
+		int f(void *, enum disassembler_style, const char *, ...);],
+		[struct disassemble_info i; init_disassemble_info(&i, 0, 0, f);],
+		[AC_MSG_RESULT([yes])
+		AC_DEFINE(INIT_DISASSEMBLE_INFO_STYLED, 1, [init_disassemble_info() has four parameters])],
+		[AC_MSG_RESULT([no])])
+fi
+AC_SUBST(OPCODES_LIBS)
+
 AC_LANG_PUSH(C)
 # Determine if bfd_get_synthetic_symtab macro is available
 OS="`uname`"
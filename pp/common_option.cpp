@@ -23,6 +23,8 @@
 #include "cverb.h"
 #include "common_option.h"
 #include "file_manip.h"
+#include "symbol_cache.h"
+#include "timings.h"
 
 using namespace std;
 
@@ -38,20 +40,52 @@ namespace options {
 namespace {
 
 vector<string> verbose_strings;
+bool no_symbol_cache;
+bool clear_symbol_cache_opt;
+bool gc_symbol_cache_opt;
+bool timings_opt;
+bool timings_json_opt;
 
 popt::option common_options_array[] = {
 	popt::option(verbose_strings, "verbose", 'V',
 		     // FIXME help string for verbose level
-		     "verbose output", "all,debug,bfd,level1,sfile,stats,xml"),
+		     "verbose output", "all,debug,bfd,level1,sfile,stats,timings,xml"),
 	popt::option(options::session_dir, "session-dir", '\0',
 		     "specify session path to hold samples database and session data (" OP_SESSION_DIR_DEFAULT ")", "path"),
 	popt::option(options::image_path, "image-path", 'p',
 		     "comma-separated path to search missing binaries", "path"),
 	popt::option(options::root_path, "root", 'R',
 		     "path to filesystem to search for missing binaries", "path"),
+	popt::option(no_symbol_cache, "no-symbol-cache", '\0',
+		     "don't use the on-disk symbol cache"),
+	popt::option(clear_symbol_cache_opt, "clear-symbol-cache", '\0',
+		     "remove all the symbol cache entries and exit"),
+	popt::option(gc_symbol_cache_opt, "gc-symbol-cache", '\0',
+		     "remove the out of date symbol cache entries and exit"),
+	popt::option(timings_opt, "timings", '\0',
+		     "output the time spent in each phase to stderr"),
+	popt::option(timings_json_opt, "timings-json", '\0',
+		     "as --timings but in JSON format"),
 };
 
 
+/// handle the symbol cache options, exit if asked to
+void handle_symbol_cache_options()
+{
+	if (clear_symbol_cache_opt || gc_symbol_cache_opt) {
+		size_t nr_removed = clear_symbol_cache_opt
+			? clear_symbol_cache() : gc_symbol_cache();
+		cverb << vdebug << nr_removed
+		      << " symbol cache entries removed from "
+		      << get_symbol_cache_dir() << endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	if (no_symbol_cache)
+		set_symbol_cache_dir(string());
+}
+
+
 double handle_threshold(string threshold)
 {
 	double value = 0.0;
@@ -180,6 +214,11 @@ options::spec get_options(int argc, char const * argv[])
 		exit(EXIT_FAILURE);
 	}
 
+	handle_symbol_cache_options();
+
+	if (timings_opt || timings_json_opt || (cverb << vtimings))
+		timings::enable();
+
 	// XML generator needs command line options for its header
 	ostringstream str;
 	for (int i = 1; i < argc; ++i)
@@ -195,7 +234,12 @@ options::spec get_options(int argc, char const * argv[])
 int run_pp_tool(int argc, char const * argv[], pp_fct_run_t fct)
 {
 	try {
-		return fct(get_options(argc, argv));
+		int const ret = fct(get_options(argc, argv));
+		if (timings_json_opt)
+			timings::report_json(cerr);
+		else if (timings::enabled())
+			timings::report(cerr);
+		return ret;
 	}
 	catch (op_runtime_error const & e) {
 		cerr << argv[0] << " error: " << e.what() << endl;
@@ -25,6 +25,7 @@
 #include "string_manip.h"
 #include "demangle_symbol.h"
 #include "child_reader.h"
+#include "bfd_disassembler.h"
 #include "op_file.h"
 #include "file_manip.h"
 #include "arrange_profiles.h"
@@ -32,6 +33,7 @@
 #include "profile_container.h"
 #include "symbol_sort.h"
 #include "image_errors.h"
+#include "timings.h"
 
 using namespace std;
 using namespace options;
@@ -287,106 +289,144 @@ bool is_symbol_line(string const & str, string::size_type pos)
 }
 
 
-void annotate_objdump_str_list(string const & app_name,
-			       symbol_collection const & symbols,
-			       list<string> & asm_lines)
+/// state of the annotation of objdump output, fed one line at a time
+struct objdump_annotation {
+	objdump_annotation(string const & app, symbol_collection const & syms)
+		: app_name(app), symbols(syms), last_symbol(0),
+		  last_symbol_vma(0), do_output(true),
+		  samp_it(samples->begin()) {}
+
+	string const & app_name;
+	symbol_collection const & symbols;
+	symbol_entry const * last_symbol;
+	bfd_vma last_symbol_vma;
+	// to filter output of symbols (filter based on command line options)
+	bool do_output;
+	sample_container::samples_iterator samp_it;
+	/// annotated lines not yet output, asm_list_annotation() can
+	/// change the first one
+	list<string> lines;
+};
+
+
+/// annotate the line sit, see asm_list_annotation() for the return value
+int annotate_objdump_line(objdump_annotation & state,
+			  list<string>::iterator sit)
 {
-	symbol_entry const * last_symbol = 0;
-	bfd_vma last_symbol_vma = 0;
 	int ret = 0;
 
-	// to filter output of symbols (filter based on command line options)
-	bool do_output = true;
-
-	// We simultaneously walk the two structures (list and sample_container)
-	// which are sorted by address. and do address comparision.
-	list<string>::iterator sit  = asm_lines.begin();
-	list<string>::iterator send = asm_lines.end();
-	sample_container::samples_iterator samp_it = samples->begin();
-
-	for (; sit != send; (!ret? sit++: sit)) {
-		// output of objdump is a human readable form and can contain some
-		// ambiguity so this code is dirty. It is also optimized a little bit
-		// so it is difficult to simplify it without breaking something ...
-
-		// line of interest are: "[:space:]*[:xdigit:]?[ :]", the last char of
-		// this regexp dis-ambiguate between a symbol line and an asm line. If
-		// source contain line of this form an ambiguity occur and we rely on
-		// the robustness of this code.
-		string str = *sit;
-		size_t pos = 0;
-		while (pos < str.length() && isspace(str[pos]))
-			++pos;
-
-		if (pos == str.length() || !isxdigit(str[pos])) {
-			if (do_output) {
-				*sit = annotation_fill + str;
-				continue;
-			}
+	// output of objdump is a human readable form and can contain some
+	// ambiguity so this code is dirty. It is also optimized a little bit
+	// so it is difficult to simplify it without breaking something ...
+
+	// line of interest are: "[:space:]*[:xdigit:]?[ :]", the last char of
+	// this regexp dis-ambiguate between a symbol line and an asm line. If
+	// source contain line of this form an ambiguity occur and we rely on
+	// the robustness of this code.
+	string str = *sit;
+	size_t pos = 0;
+	while (pos < str.length() && isspace(str[pos]))
+		++pos;
+
+	if (pos == str.length() || !isxdigit(str[pos])) {
+		if (state.do_output) {
+			*sit = annotation_fill + str;
+			return 0;
 		}
+	}
 
-		while (pos < str.length() && isxdigit(str[pos]))
-			++pos;
+	while (pos < str.length() && isxdigit(str[pos]))
+		++pos;
 
-		if (pos == str.length() || (!isspace(str[pos]) && str[pos] != ':')) {
-			if (do_output) {
-				*sit = annotation_fill + str;
-				continue;
-			}
+	if (pos == str.length() || (!isspace(str[pos]) && str[pos] != ':')) {
+		if (state.do_output) {
+			*sit = annotation_fill + str;
+			return 0;
 		}
+	}
 
-		if (is_symbol_line(str, pos)) {
+	if (is_symbol_line(str, pos)) {
 
-			last_symbol = find_symbol(app_name, str);
-			last_symbol_vma = strtoull(str.c_str(), NULL, 16);
+		state.last_symbol = find_symbol(state.app_name, str);
+		state.last_symbol_vma = strtoull(str.c_str(), NULL, 16);
 
-			// ! complexity: linear in number of symbol must use sorted
-			// by address vector and lower_bound ?
-			// Note this use a pointer comparison. It work because symbols
-			// pointer are unique
-			if (find(symbols.begin(), symbols.end(), last_symbol)
-			    != symbols.end())
-				do_output = true;
-			else
-				do_output = false;
+		// ! complexity: linear in number of symbol must use sorted
+		// by address vector and lower_bound ?
+		// Note this use a pointer comparison. It work because symbols
+		// pointer are unique
+		if (find(state.symbols.begin(), state.symbols.end(),
+			 state.last_symbol) != state.symbols.end())
+			state.do_output = true;
+		else
+			state.do_output = false;
 
-			if (do_output) {
-				*sit += symbol_annotation(last_symbol);
+		if (state.do_output) {
+			*sit += symbol_annotation(state.last_symbol);
 
-				// Realign the sample iterator to
-				// the beginning of this symbols
-				samp_it = samples->begin(last_symbol);
-			}
-		} else {
-			// not a symbol, probably an asm line.
-			if (do_output)
-				ret = asm_list_annotation(last_symbol,
-							  last_symbol_vma,
-							  sit, samp_it,
-							  asm_lines);
+			// Realign the sample iterator to
+			// the beginning of this symbols
+			state.samp_it = samples->begin(state.last_symbol);
 		}
+	} else {
+		// not a symbol, probably an asm line.
+		if (state.do_output)
+			ret = asm_list_annotation(state.last_symbol,
+						  state.last_symbol_vma,
+						  sit, state.samp_it,
+						  state.lines);
+	}
+
+	if (!state.do_output)
+		*sit = "";
+
+	return ret;
+}
 
-		if (!do_output)
-			*sit = "";
+
+/// true if asm_list_annotation() can use line as the previous asm line
+bool has_vma_field(string const & line)
+{
+	string::size_type pos = line.find(':');
+	return pos != string::npos && line.find(':', pos + 1) != string::npos;
+}
+
+
+/// print the lines of state annotated so far
+void flush_objdump_lines(objdump_annotation & state)
+{
+	list<string>::const_iterator it = state.lines.begin();
+	list<string>::const_iterator const end = state.lines.end();
+	for (; it != end; ++it) {
+		if (it->length() != 0)
+			cout << *it << '\n';
 	}
+	state.lines.clear();
 }
 
 
-void output_objdump_str_list(symbol_collection const & symbols,
-			string const & app_name,
-			list<string> & asm_lines)
+/// NOTE: objdump output is annotated and printed while it's read, only
+/// the lines from the last asm line are kept as a sample can still be
+/// aggregated to it, see asm_list_annotation()
+void output_objdump_line(objdump_annotation & state, string const & line)
 {
+	state.lines.push_back(line);
+	list<string>::iterator sit = state.lines.end();
+	--sit;
 
-	annotate_objdump_str_list(app_name, symbols, asm_lines);
+	while (annotate_objdump_line(state, sit))
+		;
 
-	// Printing objdump output to stdout
-	list<string>::iterator sit  = asm_lines.begin();
-	list<string>::iterator send = asm_lines.end();
-	sit = asm_lines.begin();
-	for (; sit != send; ++sit) {
-		string str = *sit;
-		if (str.length() != 0)
-			cout << str << '\n';
+	// filtered out lines are neither output nor searched
+	if (sit->empty()) {
+		state.lines.erase(sit);
+		return;
+	}
+
+	if (has_vma_field(*sit)) {
+		string const last = *sit;
+		state.lines.pop_back();
+		flush_objdump_lines(state);
+		state.lines.push_back(last);
 	}
 }
 
@@ -396,7 +436,6 @@ void do_one_output_objdump(symbol_collection const & symbols,
 			   bfd_vma start, bfd_vma end)
 {
 	vector<string> args;
-	list<string> asm_lines;
 
 	args.push_back("-d");
 	args.push_back("--no-show-raw-insn");
@@ -424,12 +463,13 @@ void do_one_output_objdump(symbol_collection const & symbols,
 		return;
 	}
 
-	// Read each output line from objdump and store in a list.
+	// Annotate and output each line as soon as objdump gives it
+	objdump_annotation state(app_name, symbols);
 	string str;
 	while (reader.getline(str))
-		asm_lines.push_back(str);
+		output_objdump_line(state, str);
 
-	output_objdump_str_list(symbols, app_name, asm_lines);
+	flush_objdump_lines(state);
 
 	// objdump always returns SUCCESS so we must rely on the stderr state
 	// of objdump. If objdump error message is cryptic our own error
@@ -456,6 +496,102 @@ void do_one_output_objdump(symbol_collection const & symbols,
 }
 
 
+bool less_symbol_vma(symbol_entry const * lhs, symbol_entry const * rhs)
+{
+	return lhs->sample.vma < rhs->sample.vma;
+}
+
+
+/**
+ * Output the instructions of symbol annotated with its samples. The
+ * samples of [insn vma, next insn vma) go to an instruction, the last
+ * one up to end: a sample can be inside an instruction, with the
+ * instruction fetch mode of AMD Instruction-Based Sampling (IBS).
+ */
+void output_disassembled_symbol(symbol_entry const * symbol,
+				bfd_disassembler const & disassembler,
+				bfd_disassembler::insn_list const & insns,
+				bfd_vma end)
+{
+	cout << annotation_fill << '\n';
+	cout << disassembler.symbol_address(symbol->sample.vma)
+	     << " <" << symbol_names.name(symbol->name) << ">:"
+	     << symbol_annotation(symbol) << '\n';
+
+	sample_container::samples_iterator samp_it = samples->begin(symbol);
+	sample_container::samples_iterator const samp_end =
+		samples->end(symbol);
+
+	// samples before the first instruction can't be annotated
+	while (samp_it != samp_end && !insns.empty() &&
+	       samp_it->second.vma < insns.front().vma)
+		++samp_it;
+
+	for (size_t i = 0; i < insns.size(); ++i) {
+		bfd_vma const next =
+			i + 1 < insns.size() ? insns[i + 1].vma : end;
+
+		count_array_t counts;
+		bool sampled = false;
+		for (; samp_it != samp_end && samp_it->second.vma < next;
+		     ++samp_it) {
+			counts += samp_it->second.counts;
+			sampled = true;
+		}
+
+		if (sampled) {
+			cout << count_str(counts, samples->samples_count());
+			// For each events
+			for (size_t j = 1; j < nr_events; ++j)
+				cout << "  ";
+			cout << " :";
+		} else {
+			cout << annotation_fill;
+		}
+
+		cout << disassembler.insn_address(insns[i].vma) << ":\t"
+		     << insns[i].text << '\n';
+	}
+}
+
+
+/**
+ * Disassemble the symbols with libopcodes instead of objdump, return
+ * false if objdump must be used. -S and --objdump-params need objdump.
+ */
+bool output_disassembly(symbol_collection const & symbols,
+			string const & image, string const & app_name)
+{
+	if (source || !objdump_params.empty())
+		return false;
+
+	bfd_disassembler disassembler(image);
+	if (!disassembler.valid())
+		return false;
+
+	// same order as objdump output
+	symbol_collection sorted(symbols);
+	stable_sort(sorted.begin(), sorted.end(), less_symbol_vma);
+
+	symbol_collection::const_iterator cit = sorted.begin();
+	symbol_collection::const_iterator end = sorted.end();
+	for (; cit != end; ++cit) {
+		bfd_vma start = (*cit)->sample.vma;
+		bfd_vma stop = start + (*cit)->size;
+		bfd_disassembler::insn_list insns;
+		if (disassembler.disassemble(start, stop, insns)) {
+			output_disassembled_symbol(*cit, disassembler, insns,
+						   stop);
+		} else {
+			do_one_output_objdump(symbols, image, app_name,
+					      start, stop);
+		}
+	}
+
+	return true;
+}
+
+
 void output_objdump_asm(symbol_collection const & symbols,
 			string const & app_name)
 {
@@ -464,6 +600,9 @@ void output_objdump_asm(symbol_collection const & symbols,
 		classes.extra_found_images.find_image_path(app_name, error,
 							   true);
 
+	if (error == image_ok && output_disassembly(symbols, image, app_name))
+		return;
+
 	// this is only an optimisation, we can either filter output by
 	// directly calling objdump and rely on the symbol filtering or
 	// we can call objdump with the right parameter to just disassemble
@@ -476,9 +615,9 @@ void output_objdump_asm(symbol_collection const & symbols,
 		symbol_collection::const_iterator end = symbols.end();
 		for (; cit != end; ++cit) {
 			bfd_vma start = (*cit)->sample.vma;
-			bfd_vma end  = start + (*cit)->size;
+			bfd_vma stop = start + (*cit)->size;
 			do_one_output_objdump(symbols, image, app_name,
-					      start, end);
+					      start, stop);
 		}
 	} else {
 		do_one_output_objdump(symbols, image,
@@ -758,6 +897,8 @@ void output_source(path_filter const & filter)
 
 bool annotate_source(list<string> const & images)
 {
+	scoped_timer timer("annotate");
+
 	annotation_fill = get_annotation_fill();
 
 	if (!output_dir.empty()) {
@@ -826,14 +967,10 @@ int opannotate(options::spec const & spec)
 	list<inverted_profile>::iterator const end = iprofiles.end();
 
 	bool debug_info = false;
-	for (; it != end; ++it) {
-		bool tmp = false;
-		populate_for_image(*samples, *it,
-				   options::symbol_filter, &tmp);
+	populate_for_images(*samples, iprofiles, options::symbol_filter,
+	                    options::jobs, &debug_info);
+	for (; it != end; ++it)
 		images.push_back(it->image);
-		if (tmp)
-			debug_info = true;
-	}
 
 	if (!debug_info && !options::assembly) {
 		cerr << "opannotate (warning): no debug information available for binary "
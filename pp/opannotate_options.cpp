@@ -40,6 +40,7 @@ namespace options {
 	bool assembly;
 	vector<string> objdump_params;
 	bool exclude_dependent;
+	int jobs = 1;
 }
 
 
@@ -81,6 +82,8 @@ popt::option options_array[] = {
 	popt::option(options::threshold_opt, "threshold", 't',
 		     "minimum percentage needed to produce output",
 		     "percent"),
+	popt::option(options::jobs, "jobs", 'j',
+		     "number of threads reading sample files", "N"),
 };
 
 }  // anonymous namespace
@@ -95,6 +98,11 @@ void handle_options(options::spec const & spec)
 		exit(EXIT_FAILURE);
 	}
 
+	if (jobs < 1) {
+		cerr << "--jobs must be at least 1" << endl;
+		exit(EXIT_FAILURE);
+	}
+
 	if (!assembly && !source) {
 		cerr <<	"you must specify at least --source or --assembly\n";
 		exit(EXIT_FAILURE);
@@ -125,7 +133,8 @@ void handle_options(options::spec const & spec)
 		profile_spec::create(spec.common, options::image_path,
 				     options::root_path);
 
-	list<string> sample_files = pspec.generate_file_list(exclude_dependent, true);
+	list<string> sample_files = pspec.generate_file_list(exclude_dependent,
+	                                                     true, jobs);
 
 	cverb << vsfile << "Archive: " << pspec.get_archive_path() << endl;
 
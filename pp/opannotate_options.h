@@ -30,6 +30,7 @@ namespace options {
 	extern std::vector<std::string> search_dirs;
 	extern std::vector<std::string> base_dirs;
 	extern std::vector<std::string> objdump_params;
+	extern int jobs;
 	extern double threshold;
 }
 
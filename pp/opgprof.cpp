@@ -23,6 +23,7 @@
 #include "opgprof_options.h"
 #include "cverb.h"
 #include "op_file.h"
+#include "timings.h"
 
 using namespace std;
 
@@ -136,6 +137,8 @@ void output_cg(FILE * fp, op_bfd const & abfd, profile_t const & cg_db)
 void output_gprof(op_bfd const & abfd, profile_container const & samples,
                   profile_t const & cg_db, string const & gmon_filename)
 {
+	scoped_timer timer("output");
+
 	static gmon_hdr hdr = { { 'g', 'm', 'o', 'n' }, GMON_VERSION, {0, 0, 0 } };
 
 	bfd_vma low_pc;
@@ -235,15 +238,17 @@ load_samples(op_bfd const & abfd, list<profile_sample_files> const & files,
 
 	for (; it != end; ++it) {
 		// we can get call graph w/o any samples to the binary
-		if (it->sample_filename.empty())
+		if (it->sample_filenames.empty())
 			continue;
 			
-		cverb << vsfile << "loading flat samples files : "
-		      << it->sample_filename << endl;
-
 		profile_t profile;
 
-		profile.add_sample_file(it->sample_filename);
+		list<string>::const_iterator fit = it->sample_filenames.begin();
+		for (; fit != it->sample_filenames.end(); ++fit) {
+			cverb << vsfile << "loading flat samples files : "
+			      << *fit << endl;
+			profile.add_sample_file(*fit);
+		}
 		profile.set_offset(abfd);
 
 		check_mtime(abfd.get_filename(), profile.get_header());
@@ -30,8 +30,10 @@
 #include "diff_container.h"
 #include "symbol_sort.h"
 #include "format_output.h"
+#include "profile_export.h"
 #include "xml_utils.h"
 #include "image_errors.h"
+#include "timings.h"
 
 using namespace std;
 
@@ -64,9 +66,12 @@ add_files(list<profile_sample_files> const & files, size_t pclass)
 	list<profile_sample_files>::const_iterator const end = files.end();
 
 	for (; it != end; ++it) {
-		count_type count = profile_t::sample_count(it->sample_filename);
-		counts[pclass] += count;
-		subtotal += count;
+		list<string>::const_iterator fit = it->sample_filenames.begin();
+		for (; fit != it->sample_filenames.end(); ++fit) {
+			count_type count = profile_t::sample_count(*fit);
+			counts[pclass] += count;
+			subtotal += count;
+		}
 
 		if (!it->cg_files.empty()) {
 			throw op_runtime_error("opreport.cpp::add_files(): "
@@ -319,6 +324,8 @@ output_deps(summary_container const & summaries,
  */
 void output_summaries(summary_container const & summaries)
 {
+	scoped_timer timer("output");
+
 	output_col_headers(false);
 
 	for (size_t i = 0; i < summaries.apps.size(); ++i) {
@@ -368,11 +375,25 @@ format_flags get_format_flags(column_flags const & cf)
 
 void output_symbols(profile_container const & pc, bool multiple_apps)
 {
+	scoped_timer timer("output");
+
 	profile_container::symbol_choice choice;
 	choice.threshold = options::threshold;
 	symbol_collection symbols = pc.select_symbols(choice);
+	// before the sort, the details of the symbols not selected are
+	// never looked at
+	if (options::top)
+		sort_options::select_top(symbols, options::top,
+		                         options::long_filenames);
 	options::sort_by.sort(symbols, options::reverse_sort,
 	                      options::long_filenames);
+
+	if (!options::binary_out.empty()) {
+		export_profile(options::binary_out, classes, pc, symbols,
+		               options::details);
+		return;
+	}
+
 	format_output::formatter * out;
 	format_output::xml_formatter * xml_out = 0;
 	format_output::opreport_formatter * text_out = 0;
@@ -412,15 +433,15 @@ void output_symbols(profile_container const & pc, bool multiple_apps)
 }
 
 
-void output_diff_symbols(profile_container const & pc1,
-                         profile_container const & pc2, bool multiple_apps)
+void output_diff_symbols(diff_container & dc, profile_container const & pc2,
+                         bool multiple_apps)
 {
-	diff_container dc(pc1, pc2);
+	scoped_timer timer("output");
 
 	profile_container::symbol_choice choice;
 	choice.threshold = options::threshold;
 
-	diff_collection symbols = dc.get_symbols(choice);
+	diff_collection symbols = dc.get_symbols(pc2, choice);
 
 	format_flags flags = get_format_flags(choice.hints);
 	if (multiple_apps)
@@ -429,7 +450,7 @@ void output_diff_symbols(profile_container const & pc1,
 	// With diff profile we output only filename coming from the first
 	// profile session, internally we use only name derived from the sample
 	// filename so image name can match.
-	format_output::diff_formatter out(dc, pc1.extra_found_images);
+	format_output::diff_formatter out(dc, classes.extra_found_images);
 
 	out.set_nr_classes(nr_classes);
 	out.show_long_filenames(options::long_filenames);
@@ -438,6 +459,9 @@ void output_diff_symbols(profile_container const & pc1,
 	out.vma_format_64bit(choice.hints & cf_64bit_vma);
 	out.add_format(flags);
 
+	if (options::top)
+		sort_options::select_top(symbols, options::top,
+		                         options::long_filenames);
 	options::sort_by.sort(symbols, options::reverse_sort,
 	                      options::long_filenames);
 
@@ -447,13 +471,23 @@ void output_diff_symbols(profile_container const & pc1,
 
 void output_cg_symbols(callgraph_container const & cg, bool multiple_apps)
 {
+	scoped_timer timer("output");
+
 	column_flags output_hints = cg.output_hint();
 
 	symbol_collection symbols = cg.get_symbols();
 
+	if (options::top)
+		sort_options::select_top(symbols, options::top,
+		                         options::long_filenames);
 	options::sort_by.sort(symbols, options::reverse_sort,
 	                      options::long_filenames);
 
+	if (!options::binary_out.empty()) {
+		export_callgraph(options::binary_out, classes, symbols);
+		return;
+	}
+
 	format_output::formatter * out;
 	format_output::xml_cg_formatter * xml_out = 0;
 	format_output::cg_formatter * text_out = 0;
@@ -522,7 +556,7 @@ int opreport(options::spec const & spec)
 	if (options::xml) {
 		xml_utils::output_xml_header(options::command_options,
 		                             classes.cpuinfo, classes.event);
-	} else {
+	} else if (options::binary_out.empty()) {
 		output_header();
 	}
 
@@ -532,15 +566,19 @@ int opreport(options::spec const & spec)
 				multiple_apps |= true;
 		}
 
-		profile_container pc1(options::debug_info, options::details,
-				      classes.extra_found_images);
+		// the old profile is freed before the new one is populated
+		scoped_ptr<diff_container> dc;
+		{
+			profile_container pc1(options::debug_info,
+			                      options::details,
+			                      classes.extra_found_images);
 
-		list<inverted_profile>::iterator it = iprofiles.begin();
-		list<inverted_profile>::iterator const end = iprofiles.end();
+			populate_for_images(pc1, iprofiles,
+			                    options::symbol_filter,
+			                    options::jobs, 0);
 
-		for (; it != end; ++it)
-			populate_for_image(pc1, *it,
-					   options::symbol_filter, 0);
+			dc.reset(new diff_container(pc1));
+		}
 
 		list<inverted_profile> iprofiles2 = invert_profiles(classes2);
 
@@ -549,14 +587,10 @@ int opreport(options::spec const & spec)
 		profile_container pc2(options::debug_info, options::details,
 				      classes2.extra_found_images);
 
-		list<inverted_profile>::iterator it2 = iprofiles2.begin();
-		list<inverted_profile>::iterator const end2 = iprofiles2.end();
-
-		for (; it2 != end2; ++it2)
-			populate_for_image(pc2, *it2,
-					   options::symbol_filter, 0);
+		populate_for_images(pc2, iprofiles2, options::symbol_filter,
+		                    options::jobs, 0);
 
-		output_diff_symbols(pc1, pc2, multiple_apps);
+		output_diff_symbols(*dc, pc2, multiple_apps);
 	} else if (options::callgraph) {
 		callgraph_container cg_container;
 		cg_container.populate(iprofiles, classes.extra_found_images,
@@ -568,12 +602,8 @@ int opreport(options::spec const & spec)
 		profile_container samples(options::debug_info,
 			options::details, classes.extra_found_images);
 
-		list<inverted_profile>::iterator it = iprofiles.begin();
-		list<inverted_profile>::iterator const end = iprofiles.end();
-
-		for (; it != end; ++it)
-			populate_for_image(samples, *it,
-					   options::symbol_filter, 0);
+		populate_for_images(samples, iprofiles, options::symbol_filter,
+		                    options::jobs, 0);
 
 		output_symbols(samples, multiple_apps);
 	}
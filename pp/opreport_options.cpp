@@ -49,6 +49,9 @@ namespace options {
 	bool global_percent;
 	bool xml;
 	string xml_options;
+	int jobs = 1;
+	int top;
+	string binary_out;
 }
 
 
@@ -87,6 +90,8 @@ popt::option options_array[] = {
 	popt::option(options::threshold_opt, "threshold", 't',
 		     "minimum percentage needed to produce output",
 		     "percent"),
+	popt::option(options::top, "top", '\0',
+		     "output only the N symbols with the most samples", "N"),
 
 	popt::option(demangle_option, "demangle", 'D',
 		     "demangle GNU C++ symbol names (default normal)",
@@ -108,6 +113,11 @@ popt::option options_array[] = {
 
 	popt::option(options::xml, "xml", 'X',
 		     "XML output"),
+	popt::option(options::binary_out, "binary-out", '\0',
+		     "export the symbols to the given file in a binary "
+		     "columnar format", "file"),
+	popt::option(options::jobs, "jobs", 'j',
+		     "number of threads reading sample files", "N"),
 
 };
 
@@ -191,6 +201,18 @@ void check_options(bool diff)
 	}
 
 
+	if (!binary_out.empty()) {
+		if (xml) {
+			cerr << "--binary-out is incompatible with --xml" << endl;
+			do_exit = true;
+		}
+
+		if (diff) {
+			cerr << "differential profiles are incompatible with --binary-out" << endl;
+			do_exit = true;
+		}
+	}
+
 	if (details && diff) {
 		cerr << "differential profiles are incompatible with --details" << endl;
 		do_exit = true;
@@ -227,6 +249,16 @@ void check_options(bool diff)
 			     << "meaningless without --symbols" << endl;
 			do_exit = true;
 		}
+
+		if (top) {
+			cerr << "--top is meaningless without --symbols" << endl;
+			do_exit = true;
+		}
+	}
+
+	if (top < 0) {
+		cerr << "--top needs a positive number of symbols" << endl;
+		do_exit = true;
 	}
 
 	if (global_percent && symbols && !(details || callgraph)) {
@@ -254,7 +286,7 @@ void process_spec(profile_classes & classes, list<string> const & spec)
 				     options::root_path);
 
 	list<string> sample_files = pspec.generate_file_list(exclude_dependent,
-	                                                     !options::callgraph);
+	                                     !options::callgraph, options::jobs);
 
 	cverb << vsfile << "Archive: " << pspec.get_archive_path() << endl;
 
@@ -288,6 +320,9 @@ void handle_options(options::spec const & spec)
 		show_address = true;
 	}
 
+	if (!binary_out.empty())
+		symbols = true;
+
 	if (options::xml) {
 		if (spec.common.size() != 0)
 			xml_utils::add_option(SESSION, spec.common);
@@ -307,6 +342,11 @@ void handle_options(options::spec const & spec)
 			xml_utils::add_option(INCLUDE_SYMBOLS, include_symbols);
 	}
 
+	if (jobs < 1) {
+		cerr << "--jobs must be at least 1" << endl;
+		exit(EXIT_FAILURE);
+	}
+
 	handle_sort_option();
 	merge_by = handle_merge_option(mergespec, true, exclude_dependent);
 	handle_output_file();
@@ -41,6 +41,9 @@ namespace options {
 	extern bool accumulated;
 	extern bool xml;
 	extern std::string xml_options;
+	extern int jobs;
+	extern int top;
+	extern std::string binary_out;
 }
 
 /// All the chosen sample files.
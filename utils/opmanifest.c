@@ -0,0 +1,80 @@
+/**
+ * @file opmanifest.c
+ * Rebuild the manifest of sessions
+ *
+ * @remark Copyright 2026 OProfile authors
+ * @remark Read the file COPYING
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+#include "op_version.h"
+#include "op_popt.h"
+#include "op_config.h"
+#include "op_manifest.h"
+
+static int show_vers;
+static char * session_dir;
+
+static struct poptOption options[] = {
+	{ "session-dir", '\0', POPT_ARG_STRING, &session_dir, 0,
+	  "the sessions are relative to this directory",
+	  OP_SESSION_DIR_DEFAULT, },
+	{ "version", 'v', POPT_ARG_NONE, &show_vers, 0,
+	   "show version", NULL, },
+	POPT_AUTOHELP
+	{ NULL, 0, 0, NULL, 0, NULL, NULL, },
+};
+
+
+/* a session name is relative to the samples directory, as for opreport */
+static int rebuild(char const * session)
+{
+	char dir[PATH_MAX];
+	int count;
+
+	if (session[0] == '/' || session[0] == '.')
+		snprintf(dir, PATH_MAX, "%s", session);
+	else
+		snprintf(dir, PATH_MAX, "%s%s", op_samples_dir, session);
+
+	count = op_manifest_rebuild(dir);
+	if (count < 0) {
+		fprintf(stderr, "opmanifest: couldn't rebuild the manifest "
+		        "of %s: %s\n", dir, strerror(errno));
+		return 0;
+	}
+
+	printf("%s: %d sample files\n", dir, count);
+	return 1;
+}
+
+
+int main(int argc, char const * argv[])
+{
+	poptContext optcon;
+	char const ** sessions;
+	int ok = 1;
+
+	optcon = op_poptGetContext(NULL, argc, argv, options, 0);
+
+	if (show_vers)
+		show_version(argv[0]);
+
+	init_op_config_dirs(session_dir ? session_dir : OP_SESSION_DIR_DEFAULT);
+
+	sessions = poptGetArgs(optcon);
+	if (!sessions) {
+		ok = rebuild("current");
+	} else {
+		for (; *sessions; ++sessions)
+			ok &= rebuild(*sessions);
+	}
+
+	poptFreeContext(optcon);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}